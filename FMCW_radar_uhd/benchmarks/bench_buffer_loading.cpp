@@ -0,0 +1,92 @@
+//C standard libraries
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+#include <complex>
+#include <vector>
+
+//source libraries
+#include "../src/BufferHandler.hpp"
+
+using Buffers::Array_2D;
+using Buffers::RADAR_Buffer;
+
+/**
+ * @brief Check and time load_chirp_into_buffer (the run based copy) against a per-sample
+ * reshape for combinations of chirp length, samples per buffer, and number of chirps
+ * (including ones with excess samples). Fails if any load doesn't match the reshape
+ *
+ * usage: bench_buffer_loading [num_trials]
+ */
+int main(int argc, char * argv[]){
+    size_t num_trials = (argc > 1) ? std::stoul(argv[1]) : 20;
+    if (num_trials == 0)
+    {
+        num_trials = 1;
+    }
+
+    size_t chirp_lengths[] = {1, 7, 470, 1263, 2040, 3000};
+    size_t samples_per_buffer[] = {2040, 1000, 363};
+    size_t chirps_per_frame[] = {1, 64, 256};
+    bool all_passed = true;
+
+    std::cout << "bench_buffer_loading: " << num_trials << " trials" << std::endl;
+    for (size_t c = 0; c < sizeof(chirp_lengths) / sizeof(size_t); c++)
+    {
+        //generate the chirp
+        std::vector<std::complex<float>> chirp(chirp_lengths[c]);
+        for (size_t i = 0; i < chirp.size(); i++)
+        {
+            chirp[i] = std::complex<float>(static_cast<float>(i + 1), -static_cast<float>(i));
+        }
+
+        for (size_t s = 0; s < sizeof(samples_per_buffer) / sizeof(size_t); s++)
+        {
+            for (size_t n = 0; n < sizeof(chirps_per_frame) / sizeof(size_t); n++)
+            {
+                RADAR_Buffer<float> radar_buffer(samples_per_buffer[s], chirp_lengths[c], chirps_per_frame[n]);
+                size_t total_samples = radar_buffer.num_rows * radar_buffer.num_cols;
+                size_t chirp_samples = total_samples - radar_buffer.excess_samples;
+
+                //run based copy
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < num_trials; i++)
+                {
+                    radar_buffer.load_chirp_into_buffer(chirp);
+                }
+                double run_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                //check the result (excess samples are left at zero)
+                bool passed = true;
+                const std::complex<float> * samples = radar_buffer.buffer.data();
+                for (size_t i = 0; i < total_samples && passed; i++)
+                {
+                    std::complex<float> expected = (i < chirp_samples) ? chirp[i % chirp.size()] : std::complex<float>(0);
+                    passed = (samples[i] == expected);
+                }
+
+                //per-sample reshape (index division and modulo for each sample)
+                Array_2D<std::complex<float>> reference(radar_buffer.num_rows, radar_buffer.num_cols);
+                start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < num_trials; i++)
+                {
+                    for (size_t j = 0; j < chirp_samples; j++)
+                    {
+                        reference[j / radar_buffer.num_cols][j % radar_buffer.num_cols] = chirp[j % chirp.size()];
+                    }
+                }
+                double reference_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                all_passed = all_passed && passed;
+                std::cout << "\tchirp: " << chirp_lengths[c] << "\tspb: " << samples_per_buffer[s] <<
+                            "\tchirps: " << chirps_per_frame[n] << "\texcess: " << radar_buffer.excess_samples <<
+                            "\trun copy: " << static_cast<double>(chirp_samples * num_trials) / run_time * 1e-6 << " MSps" <<
+                            "\tper-sample: " << static_cast<double>(chirp_samples * num_trials) / reference_time * 1e-6 << " MSps" <<
+                            (passed ? "" : "\tMISMATCH") << std::endl;
+            }
+        }
+    }
+    std::cout << "bench_buffer_loading: " << (all_passed ? "all loads matched" : "MISMATCHES FOUND") << std::endl;
+    return all_passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
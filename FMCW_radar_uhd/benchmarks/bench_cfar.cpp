@@ -0,0 +1,101 @@
+//C standard libraries
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+#include <random>
+#include <vector>
+
+//JSON class
+#include <nlohmann/json.hpp>
+
+//source libraries
+#include "../src/JSONHandler.hpp"
+#include "../src/BufferHandler.hpp"
+#include "../src/radar_processing/CFARDetector.hpp"
+
+using json = nlohmann::json;
+using Buffers::Buffer_2D;
+using CFARDetector_namespace::CFARDetector;
+
+/**
+ * @brief Benchmark CA and OS CFAR (using the CFAR settings from the radar config) on noise maps
+ * (range bins x doppler bins) with 128 and 256 doppler bins (chirps) and print the time per map
+ * and the false alarm rate
+ *
+ * usage: bench_cfar <radar config> [num_trials] [range bins...]
+ */
+int main(int argc, char * argv[]){
+    if (argc < 2)
+    {
+        std::cerr << "usage: bench_cfar <radar config> [num_trials] [range bins...]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string config_file = argv[1];
+    json config = JSONHandler::parse_JSON(config_file,false);
+    size_t num_trials = (argc > 2) ? std::stoul(argv[2]) : 20;
+    if (num_trials == 0)
+    {
+        num_trials = 1;
+    }
+    std::vector<size_t> range_bins;
+    for (int i = 3; i < argc; i++)
+    {
+        range_bins.push_back(std::stoul(argv[i]));
+    }
+    if (range_bins.empty())
+    {
+        range_bins = {512, 1024, 2048};
+    }
+    size_t doppler_bins[2] = {128, 256};
+
+    //a detector of each type
+    config["RadarSettings"]["cfar_enabled"] = true;
+    config["RadarSettings"]["cfar_type"] = "CA";
+    CFARDetector<float> ca_detector(config);
+    config["RadarSettings"]["cfar_type"] = "OS";
+    CFARDetector<float> os_detector(config);
+    CFARDetector<float> * detectors[2] = {& ca_detector, & os_detector};
+
+    std::cout << "bench_cfar: " << num_trials << " trials, " <<
+                config["RadarSettings"]["cfar_num_threads"] << " threads, threshold " <<
+                config["RadarSettings"]["cfar_threshold_dB"] << " dB" << std::endl;
+
+    std::mt19937 generator(0);
+    std::exponential_distribution<double> noise(1.0);
+    for (size_t d = 0; d < 2; d++)
+    {
+        for (size_t r = 0; r < range_bins.size(); r++)
+        {
+            //exponentially distributed noise power (complex gaussian noise)
+            Buffer_2D<float> power_map(range_bins[r], doppler_bins[d]);
+            for (size_t i = 0; i < power_map.buffer.num_samples(); i++)
+            {
+                power_map.buffer.data()[i] = static_cast<float>(noise(generator));
+            }
+
+            for (size_t type = 0; type < 2; type++)
+            {
+                CFARDetector<float> & detector = * detectors[type];
+                if (! detector.enabled)
+                {
+                    continue;
+                }
+                size_t num_detections = 0;
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < num_trials; i++)
+                {
+                    num_detections += detector.detect(power_map);
+                }
+                double elapsed_ms = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start).count() * 1e3;
+
+                std::cout << "\t" << range_bins[r] << " x " << doppler_bins[d] <<
+                            "\t" << detector.get_type_name() << ": " << elapsed_ms / num_trials << " ms/map" <<
+                            "\tfalse alarm rate: " << static_cast<double>(num_detections) /
+                                static_cast<double>(num_trials * power_map.buffer.num_samples()) << std::endl;
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
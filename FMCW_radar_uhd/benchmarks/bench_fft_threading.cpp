@@ -0,0 +1,97 @@
+//C standard libraries
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+#include <complex>
+#include <random>
+#include <thread>
+
+//JSON class
+#include <nlohmann/json.hpp>
+
+//source libraries
+#include "../src/JSONHandler.hpp"
+#include "../src/sensing_subsystem/SpectrogramHandler.hpp"
+
+using json = nlohmann::json;
+using SpectrogramHandler_namespace::SpectrogramHandler;
+
+/**
+ * @brief Benchmark the spectrogram fft computations using 1 to max_num_threads threads
+ * and print the average time per frame for the fused kernel and the batched (materialized) ffts
+ *
+ * usage: bench_fft_threading <attack config> [max_num_threads] [num_trials]
+ */
+int main(int argc, char * argv[]){
+    if (argc < 2)
+    {
+        std::cerr << "usage: bench_fft_threading <attack config> [max_num_threads] [num_trials]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string config_file = argv[1];
+    json config = JSONHandler::parse_JSON(config_file,false);
+    size_t max_num_threads = (argc > 2) ? std::stoul(argv[2]) : std::thread::hardware_concurrency();
+    size_t num_trials = (argc > 3) ? std::stoul(argv[3]) : 20;
+    if (max_num_threads == 0)
+    {
+        max_num_threads = 1;
+    }
+    if (num_trials == 0)
+    {
+        num_trials = 1;
+    }
+
+    SpectrogramHandler<float> spectrogram_handler(config);
+
+    //fill the rx_buffer with noise
+    std::mt19937 generator(0);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    for (size_t i = 0; i < spectrogram_handler.rx_buffer.num_rows; i++)
+    {
+        for (size_t j = 0; j < spectrogram_handler.rx_buffer.num_cols; j++)
+        {
+            spectrogram_handler.rx_buffer.buffer[i][j] = std::complex<float>(noise(generator), noise(generator));
+        }
+    }
+
+    std::cout << "bench_fft_threading: " << spectrogram_handler.get_num_rows_spectrogram() <<
+                " rows of " << spectrogram_handler.get_fft_size() << " samples (" << num_trials << " trials)" << std::endl;
+
+    double fused_single_thread_us = 0;
+    double batched_single_thread_us = 0;
+    for (size_t num_threads = 1; num_threads <= max_num_threads; num_threads++)
+    {
+        spectrogram_handler.set_fft_num_threads(num_threads);
+
+        //fused window/fft/peak detection
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < num_trials; i++)
+        {
+            spectrogram_handler.compute_spectrogram_peaks();
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        double fused_us = std::chrono::duration<double,std::micro>(end - start).count() / num_trials;
+
+        //batched ffts on the materialized signal
+        spectrogram_handler.load_and_prepare_for_fft();
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < num_trials; i++)
+        {
+            spectrogram_handler.compute_ffts();
+        }
+        end = std::chrono::steady_clock::now();
+        double batched_us = std::chrono::duration<double,std::micro>(end - start).count() / num_trials;
+
+        if (num_threads == 1)
+        {
+            fused_single_thread_us = fused_us;
+            batched_single_thread_us = batched_us;
+        }
+
+        std::cout << "\tthreads: " << num_threads <<
+                    "\tfused: " << fused_us << " us (x" << fused_single_thread_us / fused_us << ")" <<
+                    "\tbatched: " << batched_us << " us (x" << batched_single_thread_us / batched_us << ")" << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,49 @@
+//C standard libraries
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+#include <algorithm>
+
+//source libraries
+#include "../src/Logger.hpp"
+
+/**
+ * @brief Measure the cost of a log statement on the calling thread and print the average
+ * time per statement (the records are logged at the debug level and filtered out by the
+ * background thread so nothing is printed)
+ *
+ * usage: bench_logging [num_statements]
+ */
+int main(int argc, char * argv[]){
+    size_t num_statements = (argc > 1) ? std::stoul(argv[1]) : 1000000;
+    if (num_statements == 0)
+    {
+        num_statements = 1;
+    }
+
+    Logger::set_level(Logger::Level::info);
+    static const uint16_t event_id = Logger::register_event(Logger::Level::debug,
+        "bench_logging: frame {} at {} s, {} samples");
+
+    //log in batches that fit in the ring (flushing between batches isn't timed)
+    const size_t batch_size = Logger::Log_Ring::num_records / 2;
+    double total_time_s = 0;
+    size_t num_logged = 0;
+    while (num_logged < num_statements)
+    {
+        size_t batch = std::min(batch_size, num_statements - num_logged);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < batch; i++)
+        {
+            Logger::log(event_id, num_logged + i, static_cast<double>(i) * 1e-3, 2040);
+        }
+        total_time_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        num_logged += batch;
+        Logger::flush();
+    }
+
+    std::cout << "bench_logging: " << num_logged << " log statements, average cost: " <<
+                total_time_s / static_cast<double>(num_logged) * 1e9 << " ns per statement" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+//C standard libraries
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+#include <complex>
+#include <vector>
+#include <cstdint>
+
+//source libraries
+#include "../src/SIMDKernels.hpp"
+
+/**
+ * @brief Benchmark the signal energy kernels on every instruction set the cpu
+ * supports and print the throughput in samples per second
+ *
+ * usage: bench_signal_energy [num_samples] [num_trials]
+ */
+int main(int argc, char * argv[]){
+    size_t num_samples = (argc > 1) ? std::stoul(argv[1]) : 500;
+    size_t num_trials = (argc > 2) ? std::stoul(argv[2]) : 100000;
+    if (num_trials == 0)
+    {
+        num_trials = 1;
+    }
+
+    //generate the test signals
+    std::vector<std::complex<float>> signal_fc32(num_samples);
+    std::vector<std::complex<double>> signal_fc64(num_samples);
+    std::vector<std::complex<int16_t>> signal_sc16(num_samples);
+    for (size_t i = 0; i < num_samples; i++)
+    {
+        int16_t re = static_cast<int16_t>(static_cast<int>((i * 7919) % 2000) - 1000);
+        int16_t im = static_cast<int16_t>(static_cast<int>((i * 104729) % 2000) - 1000);
+        signal_sc16[i] = std::complex<int16_t>(re, im);
+        signal_fc32[i] = std::complex<float>(re / 32767.0f, im / 32767.0f);
+        signal_fc64[i] = std::complex<double>(re / 32767.0, im / 32767.0);
+    }
+
+    SIMDKernels::ISA configured_isa = SIMDKernels::get_active_isa();
+    SIMDKernels::ISA supported_isa = SIMDKernels::get_supported_isa();
+
+    std::cout << "bench_signal_energy: " << num_samples << " samples, " <<
+                num_trials << " trials" << std::endl;
+
+    //the result is accumulated so that the calls can't be optimized away
+    volatile double result = 0;
+    for (int isa_idx = 0; isa_idx <= static_cast<int>(supported_isa); isa_idx++)
+    {
+        SIMDKernels::ISA isa = SIMDKernels::set_active_isa(static_cast<SIMDKernels::ISA>(isa_idx));
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < num_trials; i++)
+        {
+            result = result + SIMDKernels::signal_energy(signal_fc32.data(), num_samples);
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        double fc32_rate = static_cast<double>(num_samples * num_trials) /
+                            std::chrono::duration<double>(end - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < num_trials; i++)
+        {
+            result = result + SIMDKernels::signal_energy(signal_fc64.data(), num_samples);
+        }
+        end = std::chrono::steady_clock::now();
+        double fc64_rate = static_cast<double>(num_samples * num_trials) /
+                            std::chrono::duration<double>(end - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < num_trials; i++)
+        {
+            result = result + SIMDKernels::signal_energy(signal_sc16.data(), num_samples);
+        }
+        end = std::chrono::steady_clock::now();
+        double sc16_rate = static_cast<double>(num_samples * num_trials) /
+                            std::chrono::duration<double>(end - start).count();
+
+        std::cout << "\t" << SIMDKernels::isa_name(isa) <<
+                    "\tfc32: " << fc32_rate * 1e-6 << " MSps" <<
+                    "\tfc64: " << fc64_rate * 1e-6 << " MSps" <<
+                    "\tsc16: " << sc16_rate * 1e-6 << " MSps" << std::endl;
+    }
+
+    //restore the configured kernels
+    SIMDKernels::set_active_isa(configured_isa);
+    return EXIT_SUCCESS;
+}
@@ -27,6 +27,7 @@
 #include "src/BufferHandler.hpp"
 #include "src/RADAR.hpp"
 #include "src/FMCWHandler.hpp"
+#include "src/FMCWDaemon.hpp"
 
 //set namespaces
 using json = nlohmann::json;
@@ -35,6 +36,7 @@ using Buffers::Buffer;
 using Buffers::Buffer_1D;
 using RADAR_namespace::RADAR;
 using FMCWHandler_namespace::FMCWHandler;
+using FMCWDaemon_namespace::FMCWDaemon;
 
 int UHD_SAFE_MAIN(int argc, char* argv[]) {
 
@@ -47,6 +49,22 @@ int UHD_SAFE_MAIN(int argc, char* argv[]) {
     //attacker configuration
     std::string attack_config_file = "/home/david/Documents/RadarSecurityResearch/FMCW_radar_uhd/Config_uhd_attack.json";
 
+    //daemon mode (--daemon [socket_path]) keeps the USRPs initialized and runs experiments on request
+    bool daemon_mode = false;
+    std::string daemon_socket_path = "/tmp/fmcw_daemon.sock";
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string(argv[i]) == "--daemon")
+        {
+            daemon_mode = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+            {
+                daemon_socket_path = argv[i + 1];
+                i++;
+            }
+        }
+    }
+
 
     //read the config file
     std::cout << "\nMAIN: Parsing JSON\n";
@@ -80,11 +98,31 @@ int UHD_SAFE_MAIN(int argc, char* argv[]) {
 
     
     if (type == "double" && cpufmt == "fc64"){
-        FMCWHandler<double> fmcw_handler(radar_config,attack_config,true);
+        if (daemon_mode)
+        {
+            FMCWDaemon<double> fmcw_daemon(radar_config,attack_config,daemon_socket_path);
+            if (! fmcw_daemon.run())
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else{
+            FMCWHandler<double> fmcw_handler(radar_config,attack_config,true);
+        }
     }
     else if (type == "float" && cpufmt == "fc32")
     {
-        FMCWHandler<float> fmcw_handler(radar_config,attack_config,true);
+        if (daemon_mode)
+        {
+            FMCWDaemon<float> fmcw_daemon(radar_config,attack_config,daemon_socket_path);
+            if (! fmcw_daemon.run())
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else{
+            FMCWHandler<float> fmcw_handler(radar_config,attack_config,true);
+        }
     }
     /*
     else if (type == "int16_t" && cpufmt == "sc16")
@@ -69,6 +69,25 @@
                     }
                 }
 
+                /**
+                 * @brief Apply an updated configuration between runs. The USRP is retuned in place
+                 * (and the noise power re-measured if any USRP setting changed) and the attack
+                 * signal is only reloaded if its file changed
+                 * 
+                 * @param new_config the updated json config object
+                 */
+                void update_config(const json & new_config){
+                    std::vector<std::string> changed = JSONHandler::changed_settings(config, new_config);
+                    config = new_config;
+                    usrp_handler.update_config(new_config);
+                    attacking_subsystem.update_config(new_config);
+
+                    if (JSONHandler::setting_changed(changed, "/USRPSettings"))
+                    {
+                        sensing_subsystem.mesaure_relative_noise_power();
+                    }
+                }
+
                 void run_attacker(void){
                     usrp_handler.reset_usrp_clock();
                     
@@ -11,6 +11,17 @@
     #include <memory>
     #include <cmath>
     #include <typeinfo>
+    #include <new>
+    #include <chrono>
+    #include <algorithm>
+    #include <cstring>
+    #include <utility>
+
+    //memory mapped file loading
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
 
     //includes for JSON editing
     #include <nlohmann/json.hpp>
@@ -19,6 +30,338 @@
 
     namespace Buffers{
 
+        /**
+         * @brief Allocator that returns memory aligned to a given boundary (defaults to a
+         * 64 byte cache line so that SIMD kernels can assume alignment)
+         * 
+         * @tparam data_type the type of data being allocated
+         * @tparam alignment the alignment in bytes (must be a power of two multiple of sizeof(void*))
+         */
+        template<typename data_type, size_t alignment = 64>
+        class Aligned_Allocator {
+            public:
+                typedef data_type value_type;
+
+                template<typename other_type>
+                struct rebind {
+                    typedef Aligned_Allocator<other_type,alignment> other;
+                };
+
+                Aligned_Allocator() {}
+
+                template<typename other_type>
+                Aligned_Allocator(const Aligned_Allocator<other_type,alignment> &) {}
+
+                /**
+                 * @brief allocate aligned memory for n elements
+                 * 
+                 * @param n the number of elements
+                 * @return data_type* pointer to the aligned memory
+                 */
+                data_type * allocate(size_t n){
+                    void * ptr = nullptr;
+                    if (posix_memalign(&ptr, alignment, n * sizeof(data_type)) != 0){
+                        throw std::bad_alloc();
+                    }
+                    return static_cast<data_type *>(ptr);
+                }
+
+                /**
+                 * @brief free memory returned by allocate()
+                 * 
+                 * @param ptr pointer to the memory
+                 */
+                void deallocate(data_type * ptr, size_t){
+                    free(ptr);
+                }
+        };
+
+        template<typename type_1, typename type_2, size_t alignment>
+        bool operator==(const Aligned_Allocator<type_1,alignment> &, const Aligned_Allocator<type_2,alignment> &){
+            return true;
+        }
+
+        template<typename type_1, typename type_2, size_t alignment>
+        bool operator!=(const Aligned_Allocator<type_1,alignment> &, const Aligned_Allocator<type_2,alignment> &){
+            return false;
+        }
+
+        /**
+         * @brief Mapped_File - a private (copy on write) memory mapping of a file opened read only.
+         * Reads come straight from the page cache, and writes to the mapping copy the affected
+         * pages so the file itself is never modified. The mapping can be longer than the file,
+         * in which case the bytes past the end of the file read as zero
+         * 
+         */
+        class Mapped_File {
+            private:
+                void * region;
+                size_t region_size;
+                size_t file_size;
+
+            public:
+                Mapped_File(): region(nullptr), region_size(0), file_size(0) {}
+
+                ~Mapped_File(){
+                    unmap();
+                }
+
+                //the mapping is owned by a single object (shared through a std::shared_ptr)
+                Mapped_File(const Mapped_File &) = delete;
+                Mapped_File & operator=(const Mapped_File &) = delete;
+
+                /**
+                 * @brief map a file into memory
+                 * 
+                 * @param path the path of the file to map
+                 * @param min_size the minimum size of the mapping in bytes (bytes past the end
+                 * of the file are zero), defaults to the size of the file
+                 * @return true - the file was mapped
+                 * @return false - the file couldn't be mapped (the caller should fall back to reading it)
+                 */
+                bool map(const std::string & path, size_t min_size = 0){
+                    unmap();
+
+                    int file_descriptor = ::open(path.c_str(), O_RDONLY);
+                    if (file_descriptor < 0){
+                        return false;
+                    }
+
+                    struct stat file_stats;
+                    if (fstat(file_descriptor, &file_stats) != 0){
+                        ::close(file_descriptor);
+                        return false;
+                    }
+                    file_size = static_cast<size_t>(file_stats.st_size);
+                    region_size = std::max(file_size, min_size);
+                    if (region_size == 0){
+                        ::close(file_descriptor);
+                        return false;
+                    }
+
+                    //reserve the full (zero filled) region, then map the file over the start of it
+                    region = mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                    if (region == MAP_FAILED){
+                        region = nullptr;
+                        ::close(file_descriptor);
+                        return false;
+                    }
+                    if (file_size > 0 &&
+                        mmap(region, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, file_descriptor, 0) == MAP_FAILED){
+                        ::close(file_descriptor);
+                        unmap();
+                        return false;
+                    }
+
+                    //the mapping remains valid after the file is closed
+                    ::close(file_descriptor);
+                    return true;
+                }
+
+                /**
+                 * @brief prefault the mapping so that streaming it doesn't page fault. The pages are
+                 * read faulted (MAP_POPULATE would write fault the private mapping and copy every page)
+                 * 
+                 */
+                void prefault(void){
+                    if (region == nullptr){
+                        return;
+                    }
+                    if (file_size > 0){
+                        madvise(region, file_size, MADV_WILLNEED);
+                    }
+#ifdef MADV_POPULATE_READ
+                    if (madvise(region, region_size, MADV_POPULATE_READ) == 0){
+                        return;
+                    }
+#endif
+                    //otherwise read a byte from each page (older kernels)
+                    const volatile char * bytes = static_cast<const volatile char *>(region);
+                    size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+                    for (size_t offset = 0; offset < region_size; offset += page_size){
+                        (void) bytes[offset];
+                    }
+                }
+
+                /**
+                 * @brief unmap the file
+                 * 
+                 */
+                void unmap(void){
+                    if (region != nullptr){
+                        munmap(region, region_size);
+                        region = nullptr;
+                    }
+                    region_size = 0;
+                    file_size = 0;
+                }
+
+                void * data() const { return region; }
+                size_t size() const { return region_size; }
+                size_t get_file_size() const { return file_size; }
+        };
+
+        /**
+         * @brief Row_View - a non-owning view of a single row of an Array_2D. Supports
+         * the same element access as a std::vector so that buffer[i][j] style code
+         * continues to work
+         * 
+         * @tparam data_type the type of data in the row
+         */
+        template<typename data_type>
+        class Row_View {
+            private:
+                data_type * row_start;
+                size_t row_size;
+
+            public:
+                typedef data_type * iterator;
+
+                Row_View(data_type * start, size_t size): row_start(start), row_size(size) {}
+
+                data_type & operator[](size_t idx) const { return row_start[idx]; }
+                data_type * data() const { return row_start; }
+                data_type & front() const { return row_start[0]; }
+                data_type & back() const { return row_start[row_size - 1]; }
+                iterator begin() const { return row_start; }
+                iterator end() const { return row_start + row_size; }
+                size_t size() const { return row_size; }
+                bool empty() const { return row_size == 0; }
+        };
+
+        /**
+         * @brief Array_2D - row major 2D array stored in a single aligned allocation.
+         * Rows are accessed through Row_Views so that array[i][j] works as it would
+         * for a vector of vectors, while data() exposes the whole array so that it can
+         * be read, written, or transformed in a single call. The samples can either be owned
+         * by the array or be the pages of a memory mapped file (see Mapped_File)
+         * 
+         * @tparam data_type the type of data stored in the array
+         */
+        template<typename data_type>
+        class Array_2D {
+            private:
+                std::vector<data_type, Aligned_Allocator<data_type>> samples;
+                size_t rows;
+                size_t cols;
+
+                //mapped file (when the array uses the pages of a file instead of samples)
+                std::shared_ptr<Mapped_File> mapped_file;
+                data_type * mapped_samples;
+
+            public:
+                Array_2D(): rows(0), cols(0), mapped_samples(nullptr) {}
+
+                /**
+                 * @brief Construct a new Array_2D object (zero initialized)
+                 * 
+                 * @param num_rows the number of rows
+                 * @param num_cols the number of columns
+                 */
+                Array_2D(size_t num_rows, size_t num_cols)
+                    : samples(num_rows * num_cols),
+                    rows(num_rows),
+                    cols(num_cols),
+                    mapped_samples(nullptr) {}
+
+                /**
+                 * @brief Construct a new Array_2D object that uses the pages of a mapped file as its
+                 * samples (no copy is made)
+                 * 
+                 * @param file the mapped file (must be at least num_rows * num_cols samples long)
+                 * @param num_rows the number of rows
+                 * @param num_cols the number of columns
+                 */
+                Array_2D(std::shared_ptr<Mapped_File> file, size_t num_rows, size_t num_cols)
+                    : rows(num_rows),
+                    cols(num_cols),
+                    mapped_file(file),
+                    mapped_samples(static_cast<data_type *>(file -> data())) {}
+
+                /**
+                 * @brief Copy Constructor (copies of a mapped array own their samples so that
+                 * they don't share copy on write pages)
+                 * 
+                 * @param rhs reference to an existing Array_2D object
+                 */
+                Array_2D(const Array_2D<data_type> & rhs)
+                    : samples(rhs.data(), rhs.data() + rhs.num_samples()),
+                    rows(rhs.rows),
+                    cols(rhs.cols),
+                    mapped_samples(nullptr) {}
+
+                /**
+                 * @brief Assignment operator support (copies of a mapped array own their samples)
+                 * 
+                 * @param rhs reference to an existing Array_2D object
+                 * @return Array_2D& 
+                 */
+                Array_2D & operator=(const Array_2D<data_type> & rhs){
+                    if (this != &rhs){
+                        samples.assign(rhs.data(), rhs.data() + rhs.num_samples());
+                        rows = rhs.rows;
+                        cols = rhs.cols;
+                        mapped_file.reset();
+                        mapped_samples = nullptr;
+                    }
+                    return *this;
+                }
+
+                /**
+                 * @brief Move Constructor (takes ownership of the samples or the mapped file)
+                 * 
+                 * @param rhs the Array_2D object to move from (left empty)
+                 */
+                Array_2D(Array_2D<data_type> && rhs)
+                    : samples(std::move(rhs.samples)),
+                    rows(rhs.rows),
+                    cols(rhs.cols),
+                    mapped_file(std::move(rhs.mapped_file)),
+                    mapped_samples(rhs.mapped_samples){
+                    rhs.rows = 0;
+                    rhs.cols = 0;
+                    rhs.mapped_samples = nullptr;
+                }
+
+                /**
+                 * @brief Move assignment support (takes ownership of the samples or the mapped file)
+                 * 
+                 * @param rhs the Array_2D object to move from (left empty)
+                 * @return Array_2D& 
+                 */
+                Array_2D & operator=(Array_2D<data_type> && rhs){
+                    if (this != &rhs){
+                        samples = std::move(rhs.samples);
+                        rows = rhs.rows;
+                        cols = rhs.cols;
+                        mapped_file = std::move(rhs.mapped_file);
+                        mapped_samples = rhs.mapped_samples;
+                        rhs.samples.clear();
+                        rhs.rows = 0;
+                        rhs.cols = 0;
+                        rhs.mapped_samples = nullptr;
+                    }
+                    return *this;
+                }
+
+                Row_View<data_type> operator[](size_t row) { return Row_View<data_type>(data() + (row * cols), cols); }
+                Row_View<const data_type> operator[](size_t row) const { return Row_View<const data_type>(data() + (row * cols), cols); }
+                Row_View<data_type> front() { return (*this)[0]; }
+                Row_View<data_type> back() { return (*this)[rows - 1]; }
+
+                //the number of rows (matches std::vector<std::vector>::size())
+                size_t size() const { return rows; }
+                bool empty() const { return rows == 0; }
+
+                //access to the underlying contiguous samples
+                data_type * data() { return (mapped_samples != nullptr) ? mapped_samples : samples.data(); }
+                const data_type * data() const { return (mapped_samples != nullptr) ? mapped_samples : samples.data(); }
+                size_t num_samples() const { return rows * cols; }
+
+                //true if the samples are the pages of a mapped file
+                bool is_mapped() const { return mapped_samples != nullptr; }
+        };
+
         /**
          * @brief Buffer Class - a parent class or a buffer
          * 
@@ -41,13 +384,16 @@
                 bool buffer_init_status;
                 bool debug_status;
 
+                //(on true) import_from_file memory maps the read file when possible instead of reading it
+                bool mapped_import;
+
             //functions
             public:
                 /**
                  * @brief Default constructor a new Buffer object
                  * 
                  */
-                Buffer(): debug_status(false),buffer_init_status(false) {}
+                Buffer(): buffer_init_status(false),debug_status(false),mapped_import(true) {}
 
                 /**
                  * @brief Construct a new Buffer object, alternative constructor to specify debug status
@@ -56,7 +402,7 @@
                  * @param debug the initialization status of the buffer
                  */
                 Buffer(bool init, bool debug) 
-                    : debug_status(debug),buffer_init_status(init) {}
+                    : buffer_init_status(init),debug_status(debug),mapped_import(true) {}
 
                 /**
                  * @brief Destroy the Buffer object
@@ -89,8 +435,9 @@
                                                         write_file(rhs.write_file),
                                                         read_file_stream(rhs.read_file_stream),
                                                         write_file_stream(rhs.write_file_stream),
+                                                        buffer_init_status(rhs.buffer_init_status),
                                                         debug_status(rhs.debug_status),
-                                                        buffer_init_status(rhs.buffer_init_status)
+                                                        mapped_import(rhs.mapped_import)
                                                         {}
 
                 /**
@@ -108,6 +455,7 @@
                         //update the debug and buffer init status variables
                         debug_status = rhs.debug_status;
                         buffer_init_status = rhs.buffer_init_status;
+                        mapped_import = rhs.mapped_import;
 
                         //close the existing read/write file streams if needed
                         if (read_file_stream.use_count() == 1)
@@ -132,6 +480,59 @@
                     return *this;
                 }
 
+                /**
+                 * @brief Move Constructor (takes over the file streams of rhs)
+                 * 
+                 * @param rhs the Buffer object to move from (left without file streams)
+                 */
+                Buffer(Buffer<data_type> && rhs) : read_file(std::move(rhs.read_file)),
+                                                    write_file(std::move(rhs.write_file)),
+                                                    read_file_stream(std::move(rhs.read_file_stream)),
+                                                    write_file_stream(std::move(rhs.write_file_stream)),
+                                                    buffer_init_status(rhs.buffer_init_status),
+                                                    debug_status(rhs.debug_status),
+                                                    mapped_import(rhs.mapped_import)
+                                                    {}
+
+                /**
+                 * @brief Move assignment support (takes over the file streams of rhs)
+                 * 
+                 * @param rhs the Buffer object to move from (left without file streams)
+                 * @return Buffer& 
+                 */
+                Buffer & operator=(Buffer<data_type> && rhs){
+                    if (this != &rhs){
+                        //update the read and write file names
+                        read_file = std::move(rhs.read_file);
+                        write_file = std::move(rhs.write_file);
+
+                        //update the debug and buffer init status variables
+                        debug_status = rhs.debug_status;
+                        buffer_init_status = rhs.buffer_init_status;
+                        mapped_import = rhs.mapped_import;
+
+                        //close the existing read/write file streams if needed
+                        if (read_file_stream.use_count() == 1)
+                        {
+                            if (read_file_stream -> is_open()){
+                                read_file_stream -> close();
+                            }
+                        }
+
+                        if (write_file_stream.use_count() == 1){
+                            if (write_file_stream -> is_open()){
+                                write_file_stream -> close();
+                            }
+                        }
+
+                        //take over the read and write file streams
+                        read_file_stream = std::move(rhs.read_file_stream);
+                        write_file_stream = std::move(rhs.write_file_stream);
+                    }
+
+                    return *this;
+                }
+
                 //managing and initializing file streams
 
                 /**
@@ -271,6 +672,86 @@
                     return data_vector;
                 }
 
+                /**
+                 * @brief Set whether import_from_file memory maps the read file (the default) or
+                 * reads it in chunks
+                 * 
+                 * @param use_mapped_import (on true) map the read file when possible
+                 */
+                void set_mapped_import(bool use_mapped_import){
+                    mapped_import = use_mapped_import;
+                }
+
+                /**
+                 * @brief Get the number of samples in the read file (the read file stream must already be open)
+                 * 
+                 * @return size_t the number of samples in the read file
+                 */
+                size_t get_read_file_num_samples(void){
+                    if (! read_file_stream || ! read_file_stream -> is_open()){
+                        std::cerr << "Buffer::get_read_file_num_samples: read_file_stream is not open\n";
+                        return 0;
+                    }
+                    read_file_stream -> seekg(0,std::ios::end);
+                    std::streampos size = read_file_stream -> tellg();
+                    read_file_stream -> seekg(0,std::ios::beg);
+                    return static_cast<size_t>(size) / sizeof(data_type);
+                }
+
+                /**
+                 * @brief Read samples from the start of the read file stream directly into memory in fixed
+                 * size chunks (no intermediate copy). NOTE: The read file stream is closed after the data has been read
+                 * 
+                 * @param destination where to store the samples
+                 * @param max_samples the maximum number of samples to read
+                 * @return size_t the number of samples read
+                 */
+                size_t read_samples_from_read_file(data_type * destination, size_t max_samples){
+                    if (! read_file_stream || ! read_file_stream -> is_open()){
+                        std::cerr << "Buffer::read_samples_from_read_file: read_file_stream is not open\n";
+                        return 0;
+                    }
+
+                    //4 MB chunks
+                    const size_t chunk_samples = std::max(static_cast<size_t>((4 << 20) / sizeof(data_type)), static_cast<size_t>(1));
+                    size_t samples_read = 0;
+
+                    read_file_stream -> seekg(0,std::ios::beg);
+                    while (samples_read < max_samples && read_file_stream -> good())
+                    {
+                        size_t samples_to_read = std::min(chunk_samples, max_samples - samples_read);
+                        read_file_stream -> read((char*) (destination + samples_read), samples_to_read * sizeof(data_type));
+                        samples_read += static_cast<size_t>(read_file_stream -> gcount()) / sizeof(data_type);
+                    }
+                    read_file_stream -> close();
+                    return samples_read;
+                }
+
+                /**
+                 * @brief Map the read file into memory (the read file stream is closed)
+                 * 
+                 * @param min_samples the minimum number of samples the mapping must hold (samples
+                 * past the end of the file are zero)
+                 * @return std::shared_ptr<Mapped_File> the mapped file, or nullptr if mapped imports are
+                 * disabled or the file couldn't be mapped (the read file stream is then left open)
+                 */
+                std::shared_ptr<Mapped_File> map_read_file(size_t min_samples = 0){
+                    if (! mapped_import || read_file.empty()){
+                        return nullptr;
+                    }
+                    std::shared_ptr<Mapped_File> file = std::make_shared<Mapped_File>();
+                    if (! file -> map(read_file, min_samples * sizeof(data_type))){
+                        std::cerr << "Buffer::map_read_file: couldn't map " << read_file << ", reading it instead" << std::endl;
+                        return nullptr;
+                    }
+                    file -> prefault();
+
+                    if (read_file_stream && read_file_stream -> is_open()){
+                        read_file_stream -> close();
+                    }
+                    return file;
+                }
+
             //abstract functions
                 virtual void print_preview(void) = 0;
                 virtual void import_from_file(void) = 0;
@@ -286,8 +767,8 @@
         class Buffer_2D : public Buffer<data_type>{
             public:
             //variables
-                //a vector to store things in
-                std::vector<std::vector<data_type>> buffer;
+                //contiguous, aligned 2D array to store things in (rows accessed as buffer[i])
+                Array_2D<data_type> buffer;
 
                 //keep track of the size of the buffer
                 size_t num_rows;
@@ -322,7 +803,7 @@
                  */
                 Buffer_2D(size_t rows, size_t cols,size_t excess = 0, bool debug = false)
                         : Buffer<data_type>(true,debug),
-                        buffer(rows,std::vector<data_type>(cols)),
+                        buffer(rows,cols),
                         num_rows(rows),
                         num_cols(cols),
                         excess_samples(excess){}
@@ -333,12 +814,18 @@
                  */
                 virtual ~Buffer_2D() {}
 
+                //copies share the file streams, moves take over the file streams and the samples
+                Buffer_2D(const Buffer_2D<data_type> & rhs) = default;
+                Buffer_2D(Buffer_2D<data_type> && rhs) = default;
+                Buffer_2D & operator=(const Buffer_2D<data_type> & rhs) = default;
+                Buffer_2D & operator=(Buffer_2D<data_type> && rhs) = default;
+
                 /**
                  * @brief prints out a 1d buffer
                  * 
-                 * @param buffer_to_print a reference to the buffer(vector) to be printed
+                 * @param buffer_to_print a view of the row to be printed
                  */
-                void print_1d_buffer_preview(std::vector<data_type> & buffer_to_print){
+                void print_1d_buffer_preview(Row_View<data_type> buffer_to_print){
                     //declare variable to keep track of how many samples to print out (limited to the first 5 and the last sample)
                     size_t samples_to_print;
                     if (buffer_to_print.size() > 5){
@@ -380,44 +867,8 @@
                  * (on false) inserts up to only 1 copy of the data into the buffer
                  */
                 void load_data_into_buffer(std::vector<data_type> & data_to_load, bool copy_until_buffer_full = true){
-                    //setup bool to stop copying if copy_until_buffer_full is false
-                    bool stop_signal = false;
-                    //setup iterators
-                    typename std::vector<data_type>::iterator data_iterator = data_to_load.begin();
-                    size_t row = 0;
-                    typename std::vector<data_type>::iterator buffer_iterator = buffer[0].begin();
-                    while (buffer_iterator != (buffer[num_rows - 1].end() - excess_samples) && stop_signal == false)
-                    {
-                        *buffer_iterator = *data_iterator;
-
-                        //increment data iterator
-                        if(data_iterator == data_to_load.end() - 1){
-                            if(copy_until_buffer_full){
-                                data_iterator = data_to_load.begin();
-                            }
-                            else{
-                                stop_signal = true;
-                            }
-                            
-                        }
-                        else{
-                            ++data_iterator;
-                        }
-
-                        //increment buffer iterator
-                        if(buffer_iterator == buffer[row].end() - 1){
-                            if(row == (num_rows - 1) && excess_samples == 0){
-                                buffer_iterator = buffer[row].end();
-                            }
-                            else{
-                                row = row + 1;
-                                buffer_iterator = buffer[row].begin();
-                            }
-                        }
-                        else{
-                            ++buffer_iterator;
-                        }
-                    }
+                    std::vector<Sample_Run> runs(1, Sample_Run(data_to_load.data(), data_to_load.size()));
+                    load_runs_into_buffer(runs, (num_rows * num_cols) - excess_samples, copy_until_buffer_full, false);
                 }
 
                 /**
@@ -429,159 +880,102 @@
                  * (on false) inserts up to only 1 copy of the data into the buffer
                  */
                 void load_data_into_buffer(std::vector<std::vector<data_type>> & data_to_load, bool copy_until_buffer_full = true){
-                    //setup bool to stop copying if copy_until_buffer_full is false
-                    bool stop_signal = false;
-                    //setup iterators
-
-                    //data iterators
-                    typename std::vector<data_type>::iterator data_iterator = data_to_load[0].begin();
-                    size_t data_row = 0;
-                    size_t num_data_rows = data_to_load.size();
-
-                    //buffer iterators
-                    size_t buffer_row = 0;
-                    typename std::vector<data_type>::iterator buffer_iterator = buffer[0].begin();
-                    while (buffer_iterator != (buffer[num_rows - 1].end() - excess_samples) && stop_signal == false)
+                    std::vector<Sample_Run> runs;
+                    runs.reserve(data_to_load.size());
+                    for (size_t i = 0; i < data_to_load.size(); i++)
                     {
-                        *buffer_iterator = *data_iterator;
-
-                        //increment data iterator
-                        if(data_iterator == data_to_load[data_row].end() - 1){
-                            //if it is the last row in the vector
-                            if (data_row == num_data_rows - 1)
-                            {
-                                if(copy_until_buffer_full){
-                                    data_row = 0;
-                                    data_iterator = data_to_load[0].begin();
-                                }
-                                else{
-                                    stop_signal = true;
-                                }
-                            }
-                            else {
-                                data_row = data_row + 1;
-                                data_iterator = data_to_load[data_row].begin();
-                            }
-                        }
-                        else{
-                            ++data_iterator;
-                        }
-
-                        //increment buffer iterator
-                        if(buffer_iterator == buffer[buffer_row].end() - 1){
-                            if(buffer_row == (num_rows - 1) && excess_samples == 0){
-                                buffer_iterator = buffer[buffer_row].end();
-                            }
-                            else{
-                                buffer_row = buffer_row + 1;
-                                buffer_iterator = buffer[buffer_row].begin();
-                            }
-                        }
-                        else{
-                            ++buffer_iterator;
-                        }
+                        runs.push_back(Sample_Run(data_to_load[i].data(), data_to_load[i].size()));
                     }
+                    load_runs_into_buffer(runs, (num_rows * num_cols) - excess_samples, copy_until_buffer_full, false);
                 }
                              
                 
                 /**
-                 * @brief load data from a 1D vector into the buffer
+                 * @brief load data from a 1D vector into the buffer (fills the entire buffer, including
+                 * any excess samples)
                  * 
                  * @param data_to_load (1D vector) the data to load into the buffer
                  * @param copy_until_buffer_full (on true) continuously copies data from the vector into the buffer until
-                 * the buffer is full or until the excess samples is reached, even if multiple copies of the data are made
-                 * (on false) inserts up to only 1 copy of the data into the buffer
+                 * the buffer is full, even if multiple copies of the data are made
+                 * (on false) inserts up to only 1 copy of the data into the buffer and sets the remaining samples to zero
                  */
                 void load_data_into_buffer_efficient(std::vector<data_type> & data_to_load, bool copy_until_buffer_full = true){
-
-                    //get the number of samples in the data_to_load
-                    size_t m = data_to_load.size(); //rows
-                    
-                    
-                    //determine the maximum sample number for the initialized array
-                    size_t samples_to_load = num_rows * num_cols;
-
-                    //initialize variables for reshaping
-                    size_t from_idx;
-                    size_t to_r;
-                    size_t to_c;
-
-                    for (size_t i = 0; i < samples_to_load; i++)
-                    {
-                        //index in data_to_load
-                        from_idx = i % m;
-
-                        //indicies in current array
-                        to_r = i/num_cols;
-                        to_c = i % num_cols;
-
-                        if (i >= m)
-                        {
-                            if (copy_until_buffer_full)
-                            {
-                                buffer[to_r][to_c] = data_to_load[from_idx];
-                            }
-                            else{
-                                buffer[to_r][to_c] = 0;
-                            }
-                        }
-                        else{
-                            buffer[to_r][to_c] = data_to_load[from_idx];
-                        }
-                    }
+                    std::vector<Sample_Run> runs(1, Sample_Run(data_to_load.data(), data_to_load.size()));
+                    load_runs_into_buffer(runs, num_rows * num_cols, copy_until_buffer_full, true);
                 }
                 
                 
                 /**
-                 * @brief load data from a 2D vector into the buffer
+                 * @brief load data from a 2D vector into the buffer (fills the entire buffer, including
+                 * any excess samples). Each row of data_to_load is assumed to have the same number of samples
                  * 
                  * @param data_to_load (2D vector) the data to load into the buffer
                  * @param copy_until_buffer_full (on true) continuously copies data from the vector into the buffer until
-                 * the buffer is full or until the excess samples is reached, even if multiple copies of the data are made
-                 * (on false) inserts up to only 1 copy of the data into the buffer
+                 * the buffer is full, even if multiple copies of the data are made
+                 * (on false) inserts up to only 1 copy of the data into the buffer and sets the remaining samples to zero
                  */
                 void load_data_into_buffer_efficient(std::vector<std::vector<data_type>> & data_to_load, bool copy_until_buffer_full = true){
+                    //get the number of columns in data_to_load
+                    size_t n = data_to_load.empty() ? 0 : data_to_load[0].size();
 
-                    //get dimmensions of data_to_load array
-                    size_t m = data_to_load.size(); //rows
-                    size_t n = data_to_load[0].size(); //cols
-                    
-                    
-                    //determine the maximum sample number depending on copy behavior
-                    size_t samples_to_load = num_rows * num_cols;
-
-                    //initialize variables for reshaping
-                    size_t from_r;
-                    size_t from_c;
-                    size_t to_r;
-                    size_t to_c;
-
-                    for (size_t i = 0; i < samples_to_load; i++)
+                    std::vector<Sample_Run> runs;
+                    runs.reserve(data_to_load.size());
+                    for (size_t i = 0; i < data_to_load.size(); i++)
                     {
-                        //indicies in data_to_load
-                        from_r = i/n;
-                        from_c = i % n;
+                        runs.push_back(Sample_Run(data_to_load[i].data(), std::min(n, data_to_load[i].size())));
+                    }
+                    load_runs_into_buffer(runs, num_rows * num_cols, copy_until_buffer_full, true);
+                }
+
+            private:
+                //a contiguous run of samples to copy into the buffer (start, number of samples)
+                typedef std::pair<const data_type *, size_t> Sample_Run;
 
-                        //indicies in current array
-                        to_r = i/num_cols;
-                        to_c = i % num_cols;
+                /**
+                 * @brief copy a series of runs into the start of the buffer. Since the rows of the buffer are
+                 * contiguous, each run is copied in a single memcpy no matter how many rows it spans. When
+                 * repeating, the data already in the buffer is copied forward in doubling blocks, so tiling a
+                 * short chirp takes O(log(buffer size / chirp size)) copies
+                 * 
+                 * @param runs the runs to copy (in order)
+                 * @param samples_to_load the number of samples at the start of the buffer to load
+                 * @param repeat (on true) repeat the runs until samples_to_load samples have been loaded
+                 * @param zero_fill (on true and not repeating) set any samples not loaded from the runs to zero,
+                 * (on false) leave them unchanged
+                 */
+                void load_runs_into_buffer(const std::vector<Sample_Run> & runs, size_t samples_to_load, bool repeat, bool zero_fill){
+                    data_type * destination = buffer.data();
+                    size_t loaded = 0;
 
-                        if (from_r >= m)
+                    //copy one pass of the runs
+                    for (size_t i = 0; i < runs.size() && loaded < samples_to_load; i++)
+                    {
+                        size_t run_length = std::min(runs[i].second, samples_to_load - loaded);
+                        if (run_length > 0)
                         {
-                            if (copy_until_buffer_full)
-                            {
-                                buffer[to_r][to_c] = data_to_load[from_r % m][from_c];
-                            }
-                            else{
-                                buffer[to_r][to_c] = 0;
-                            }
+                            std::memcpy(destination + loaded, runs[i].first, run_length * sizeof(data_type));
+                            loaded += run_length;
                         }
-                        else{
-                            buffer[to_r][to_c] = data_to_load[from_r][from_c];
+                    }
+
+                    if (repeat && loaded > 0)
+                    {
+                        //the loaded samples are whole periods of the runs, so copying them forward preserves the period
+                        while (loaded < samples_to_load)
+                        {
+                            size_t block = std::min(loaded, samples_to_load - loaded);
+                            std::memcpy(destination + loaded, destination, block * sizeof(data_type));
+                            loaded += block;
                         }
                     }
+                    else if (zero_fill)
+                    {
+                        std::fill(destination + loaded, destination + samples_to_load, data_type(0));
+                    }
                 }
 
+            public:
+
                 /**
                  * @brief print a prevew of the buffer (1st 3 rows, 1st 5 columns, last row, last column)
                  * 
@@ -626,11 +1020,20 @@
                 virtual void import_from_file(){
                     
                     if (Buffer<data_type>::buffer_init_status == true){
-                        //save the data from the file into a vector
-                        std::vector<data_type> data = Buffer<data_type>::load_data_from_read_file();
-                        
-                        //load it into the file
-                        load_data_into_buffer_efficient(data,false);
+                        //use the file's pages as the buffer if possible (samples past the end of the file are zero)
+                        std::shared_ptr<Mapped_File> file = Buffer<data_type>::map_read_file(num_rows * num_cols);
+                        if (file){
+                            buffer = Array_2D<data_type>(file,num_rows,num_cols);
+                            std::cout << "Buffer_2D::import_from_file: mapped " << file -> get_file_size() / sizeof(data_type) << " samples" << std::endl;
+                            return;
+                        }
+
+                        //otherwise, read the file directly into the buffer
+                        if (buffer.is_mapped()){
+                            buffer = Array_2D<data_type>(num_rows,num_cols);
+                        }
+                        size_t samples_read = Buffer<data_type>::read_samples_from_read_file(buffer.data(), num_rows * num_cols);
+                        std::fill(buffer.data() + samples_read, buffer.data() + num_rows * num_cols, data_type(0));
                     }
                     else {
                         std::cout << "Buffer_2D::import_from_file: attempted to import from file when buffer wasn't initialized" <<std::endl;
@@ -647,19 +1050,26 @@
                  * computes the number of rows))
                  */
                 void import_from_file(double desired_num_cols){
-                        //save the data from the file into a vector
-                        std::vector<data_type> data = Buffer<data_type>::load_data_from_read_file();
-                        
-                        double num_samples = static_cast<double>(data.size());
+                        //determine the number of samples in the file
+                        size_t detected_samples = Buffer<data_type>::get_read_file_num_samples();
+                        std::cout << "Buffer_2D::import_from_file: detected samples: " << detected_samples << std::endl;
+
+                        double num_samples = static_cast<double>(detected_samples);
 
                         num_cols = static_cast<int>(desired_num_cols);
                         num_rows = static_cast<int>(std::ceil(num_samples/desired_num_cols));
                         excess_samples = static_cast<int>(num_samples) % num_cols;
 
-                        buffer = std::vector<std::vector<data_type>>(num_rows,std::vector<data_type>(num_cols));
-                        
-                        //load it into the file
-                        load_data_into_buffer_efficient(data,false);
+                        //use the file's pages as the buffer if possible (the unused samples in the last row are zero)
+                        std::shared_ptr<Mapped_File> file = Buffer<data_type>::map_read_file(num_rows * num_cols);
+                        if (file){
+                            buffer = Array_2D<data_type>(file,num_rows,num_cols);
+                            return;
+                        }
+
+                        //otherwise, read the file directly into the buffer
+                        buffer = Array_2D<data_type>(num_rows,num_cols);
+                        Buffer<data_type>::read_samples_from_read_file(buffer.data(), num_rows * num_cols);
 
                         return;
                 }
@@ -671,14 +1081,10 @@
                 virtual void save_to_file(){
                     //the out file stream must already be open when the function is called
                     if(Buffer<data_type>::write_file_stream -> is_open()){
-                        //save all of the rows except for the last one
-                        for (size_t i = 0; i < num_rows - 1; i++)
-                        {
-                            Buffer<data_type>::write_file_stream -> write((char*) &buffer[i].front(), buffer[i].size() * sizeof(data_type));
-                        }
-                        //for the last row, since there may be excess samples in the buffer, only save those pertaining to a chirp
-                        Buffer<data_type>::write_file_stream -> write((char*) &buffer.back().front(), (num_cols - excess_samples) * sizeof(data_type));
-
+                        //the rows are contiguous, so save the whole buffer in one call. Since there may be
+                        //excess samples in the last row, only save those pertaining to a chirp
+                        size_t samples_to_save = (num_rows * num_cols) - excess_samples;
+                        Buffer<data_type>::write_file_stream -> write((char*) buffer.data(), samples_to_save * sizeof(data_type));
                     }
                     else{
                         std::cerr << "Buffer_2D::save_to_file: write_file_stream not open" << std::endl;
@@ -734,6 +1140,12 @@
                  */
                 virtual ~Buffer_1D() {}
 
+                //copies share the file streams, moves take over the file streams and the samples
+                Buffer_1D(const Buffer_1D<data_type> & rhs) = default;
+                Buffer_1D(Buffer_1D<data_type> && rhs) = default;
+                Buffer_1D & operator=(const Buffer_1D<data_type> & rhs) = default;
+                Buffer_1D & operator=(Buffer_1D<data_type> && rhs) = default;
+
                 /**
                  * @brief print a preview of the buffer (assumes buffer already has samples in it)
                  * 
@@ -773,12 +1185,27 @@
                 /**
                  * @brief imports data from an already opened read_file_stream and loads it into the buffer,
                  * sets the buffer to be equal to the data in the buffer and sets num_samples to the number
-                 * of samples imported from the file, Note: read file stream is closed after data is imported
+                 * of samples imported from the file, Note: read file stream is closed after data is imported.
+                 * The samples are copied straight from the mapped file (or read in chunks if the file
+                 * can't be mapped) into the buffer
                  * 
                  */
                 virtual void import_from_file(){
-                    //load the data from the read file
-                    buffer = Buffer<data_type>::load_data_from_read_file();
+                    size_t detected_samples = Buffer<data_type>::get_read_file_num_samples();
+                    std::cout << "Buffer_1D::import_from_file: detected samples: " << detected_samples << std::endl;
+
+                    std::shared_ptr<Mapped_File> file = Buffer<data_type>::map_read_file();
+                    if (file){
+                        const data_type * samples = static_cast<const data_type *>(file -> data());
+                        buffer.assign(samples, samples + detected_samples);
+                    }
+                    else{
+                        buffer = std::vector<data_type>(detected_samples);
+                        if (detected_samples > 0){
+                            detected_samples = Buffer<data_type>::read_samples_from_read_file(buffer.data(), detected_samples);
+                        }
+                        buffer.resize(detected_samples);
+                    }
                     num_samples = buffer.size();
                 }
 
@@ -932,6 +1359,12 @@
                      */
                     ~RADAR_Buffer() {}
 
+                    //copies share the file streams, moves take over the file streams and the samples
+                    RADAR_Buffer(const RADAR_Buffer<data_type> & rhs) = default;
+                    RADAR_Buffer(RADAR_Buffer<data_type> && rhs) = default;
+                    RADAR_Buffer & operator=(const RADAR_Buffer<data_type> & rhs) = default;
+                    RADAR_Buffer & operator=(RADAR_Buffer<data_type> && rhs) = default;
+
                     /**
                      * @brief configures a Buffer_2D to be able to operate as a buffer used by the RADAR radar,
                      * and initializes a buffer (vector) of the correct dimensions
@@ -964,7 +1397,7 @@
                             Buffer_2D<std::complex<data_type>>::excess_samples = (Buffer_2D<std::complex<data_type>>::num_rows * desired_samples_per_buff) - (desired_num_chirps * required_samples_per_chirp);
                         }
 
-                        Buffer_2D<std::complex<data_type>>::buffer = std::vector<std::vector<std::complex<data_type>>>(Buffer_2D<std::complex<data_type>>::num_rows,std::vector<std::complex<data_type>>(Buffer_2D<std::complex<data_type>>::num_cols));
+                        Buffer_2D<std::complex<data_type>>::buffer = Array_2D<std::complex<data_type>>(Buffer_2D<std::complex<data_type>>::num_rows,Buffer_2D<std::complex<data_type>>::num_cols);
                         Buffer<std::complex<data_type>>::buffer_init_status = true;
                     }
 
@@ -0,0 +1,8 @@
+#include "CaptureFile.hpp"
+
+/**
+ * All of the code for this file is located in the header file.
+ * This was done because the CaptureFileWriter and CaptureFileReader classes
+ * are templated classes and so this made the most sense.
+ * 
+ */
@@ -0,0 +1,641 @@
+#ifndef CAPTUREFILE
+#define CAPTUREFILE
+    //C standard libraries
+    #include <iostream>
+    #include <cstdlib>
+    #include <cstdint>
+    #include <cstring>
+    #include <string>
+    #include <complex>
+    #include <vector>
+    #include <fstream>
+    #include <algorithm>
+
+    //memory mapping
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+
+    //user generated header files
+    #include "BufferHandler.hpp"
+
+    using Buffers::Buffer_2D;
+
+    namespace CaptureFile_namespace {
+
+        /*
+        * Capture file layout (all values little endian, as written by the host):
+        *   [CaptureFileHeader, padded to data_alignment]
+        *   for each frame:
+        *       [CaptureFrameRecord][padding to data_alignment][frame samples]
+        *   [CaptureIndexHeader][CaptureFrameRecord for each frame]
+        *
+        * The header is rewritten when the file is closed so that it holds the number of
+        * frames and the offset of the trailing index. Frame samples always start on a
+        * data_alignment (page) boundary so that a reader can mmap them directly.
+        */
+
+        //sample formats
+        enum CaptureSampleFormat : uint32_t {
+            capture_format_fc32 = 1,
+            capture_format_fc64 = 2
+        };
+
+        /**
+         * @brief fixed size (512 byte) header at the start of every capture file
+         *
+         */
+        struct CaptureFileHeader {
+            char magic[8]; //"RSCAPTUR"
+            uint32_t version;
+            uint32_t header_size;
+            uint32_t sample_format; //CaptureSampleFormat
+            uint32_t sample_size; //bytes per complex sample
+            uint64_t data_alignment; //frame data is aligned to this many bytes
+
+            //radio settings
+            double rx_rate;
+            double rx_frequency;
+            double rx_gain;
+            double tx_rate;
+            double tx_frequency;
+            double tx_gain;
+
+            //frame geometry
+            uint64_t rows_per_frame; //recv calls per frame
+            uint64_t samples_per_row; //samples per recv call
+            uint64_t excess_samples; //unused samples at the end of the final row (not saved)
+            uint64_t samples_per_chirp;
+            uint64_t chirps_per_frame;
+            double frame_periodicity_s;
+
+            //set when the file is closed
+            uint64_t num_frames;
+            uint64_t index_offset; //0 if the file was not closed
+
+            uint8_t reserved[368];
+        };
+
+        /**
+         * @brief record written before each frame (and repeated in the trailing index)
+         *
+         */
+        struct CaptureFrameRecord {
+            char magic[4]; //"FRME"
+            uint32_t overflow; //1 if an overflow occurred while receiving the frame
+            uint64_t frame_number; //index of the frame in the stream (dropped frames leave a gap)
+            int64_t time_full_secs; //USRP time_spec of the first sample in the frame
+            double time_frac_secs;
+            uint64_t num_samples_received;
+            uint64_t data_offset; //byte offset of the frame samples in the file
+            uint64_t num_samples; //number of samples stored at data_offset
+            uint64_t reserved;
+        };
+
+        /**
+         * @brief header of the trailing frame index
+         *
+         */
+        struct CaptureIndexHeader {
+            char magic[8]; //"RSINDEX "
+            uint64_t num_frames;
+        };
+
+        static_assert(sizeof(CaptureFileHeader) == 512, "CaptureFileHeader must be 512 bytes");
+        static_assert(sizeof(CaptureFrameRecord) == 64, "CaptureFrameRecord must be 64 bytes");
+        static_assert(sizeof(CaptureIndexHeader) == 16, "CaptureIndexHeader must be 16 bytes");
+
+        static const char capture_header_magic[8] = {'R','S','C','A','P','T','U','R'};
+        static const char capture_frame_magic[4] = {'F','R','M','E'};
+        static const char capture_index_magic[8] = {'R','S','I','N','D','E','X',' '};
+        static const uint32_t capture_file_version = 1;
+        static const uint64_t capture_data_alignment = 4096;
+
+        /**
+         * @brief metadata describing a received frame (passed to CaptureFileWriter::write_frame)
+         *
+         */
+        struct CaptureFrameMetadata {
+            uint64_t frame_number; //index of the frame in the stream
+            int64_t time_full_secs;
+            double time_frac_secs;
+            bool overflow;
+            uint64_t num_samples_received;
+
+            CaptureFrameMetadata(): frame_number(0), time_full_secs(0), time_frac_secs(0), overflow(false), num_samples_received(0) {}
+        };
+
+        /**
+         * @brief Get the capture sample format for a given data_type
+         *
+         * @tparam data_type the cpu_format used for the USRP device, will be std::complex<data_type>
+         * @return uint32_t the CaptureSampleFormat
+         */
+        template<typename data_type>
+        uint32_t get_capture_sample_format(void){
+            return (sizeof(data_type) == sizeof(double)) ? capture_format_fc64 : capture_format_fc32;
+        }
+
+        /**
+         * @brief round an offset up to a multiple of the alignment
+         *
+         */
+        inline uint64_t align_capture_offset(uint64_t offset, uint64_t alignment){
+            return ((offset + alignment - 1) / alignment) * alignment;
+        }
+
+        /**
+         * @brief Writes received frames and their metadata to a capture file
+         *
+         * @tparam data_type the cpu_format used for the USRP device, will be std::complex<data_type>
+         */
+        template<typename data_type>
+        class CaptureFileWriter {
+            private:
+                std::string file_path;
+                std::ofstream file_stream;
+                CaptureFileHeader header;
+                std::vector<CaptureFrameRecord> frame_index;
+                uint64_t write_offset;
+                std::vector<char> padding;
+
+            public:
+
+                /**
+                 * @brief Construct a new CaptureFileWriter object
+                 *
+                 */
+                CaptureFileWriter(): write_offset(0) {}
+
+                /**
+                 * @brief Destroy the CaptureFileWriter object (closes the file if it is open)
+                 *
+                 */
+                ~CaptureFileWriter(){
+                    close();
+                }
+
+                /**
+                 * @brief Get a header with the magic, version, and sample format filled in (the caller
+                 * fills in the radio settings and frame geometry)
+                 *
+                 * @return CaptureFileHeader the default header
+                 */
+                static CaptureFileHeader get_default_header(void){
+                    CaptureFileHeader default_header;
+                    std::memset(&default_header, 0, sizeof(CaptureFileHeader));
+                    std::memcpy(default_header.magic, capture_header_magic, sizeof(capture_header_magic));
+                    default_header.version = capture_file_version;
+                    default_header.header_size = sizeof(CaptureFileHeader);
+                    default_header.sample_format = get_capture_sample_format<data_type>();
+                    default_header.sample_size = sizeof(std::complex<data_type>);
+                    default_header.data_alignment = capture_data_alignment;
+                    return default_header;
+                }
+
+                /**
+                 * @brief open a capture file and write its header
+                 *
+                 * @param path the path of the capture file
+                 * @param file_header the header for the file (see get_default_header())
+                 * @return true - the file was opened
+                 * @return false - the file couldn't be opened
+                 */
+                bool open(std::string path, const CaptureFileHeader & file_header){
+                    close();
+
+                    file_path = path;
+                    header = file_header;
+                    header.num_frames = 0;
+                    header.index_offset = 0;
+                    frame_index.clear();
+                    padding = std::vector<char>(header.data_alignment, 0);
+
+                    file_stream.open(file_path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+                    if (! file_stream.is_open())
+                    {
+                        std::cerr << "CaptureFileWriter::open: failed to open " << file_path << std::endl;
+                        return false;
+                    }
+
+                    file_stream.write((char*) &header, sizeof(CaptureFileHeader));
+                    write_offset = sizeof(CaptureFileHeader);
+                    write_padding();
+
+                    std::cout << "CaptureFileWriter::open: capture file opened successfully" << std::endl;
+                    return true;
+                }
+
+                /**
+                 * @brief check if the capture file is open
+                 *
+                 */
+                bool is_open(void){
+                    return file_stream.is_open();
+                }
+
+                /**
+                 * @brief write a frame (the samples pertaining to a chirp, excluding any excess samples
+                 * at the end of the final row) and its record to the file
+                 *
+                 * @param frame the buffer containing the frame
+                 * @param metadata the time, overflow status, and number of samples received for the frame
+                 */
+                void write_frame(Buffer_2D<std::complex<data_type>> & frame, const CaptureFrameMetadata & metadata){
+                    if (! file_stream.is_open())
+                    {
+                        std::cerr << "CaptureFileWriter::write_frame: capture file not open" << std::endl;
+                        return;
+                    }
+
+                    size_t samples_to_save = (frame.num_rows * frame.num_cols) - frame.excess_samples;
+
+                    CaptureFrameRecord record;
+                    std::memset(&record, 0, sizeof(CaptureFrameRecord));
+                    std::memcpy(record.magic, capture_frame_magic, sizeof(capture_frame_magic));
+                    record.overflow = metadata.overflow ? 1 : 0;
+                    record.frame_number = metadata.frame_number;
+                    record.time_full_secs = metadata.time_full_secs;
+                    record.time_frac_secs = metadata.time_frac_secs;
+                    record.num_samples_received = metadata.num_samples_received;
+                    record.data_offset = align_capture_offset(write_offset + sizeof(CaptureFrameRecord), header.data_alignment);
+                    record.num_samples = samples_to_save;
+
+                    file_stream.write((char*) &record, sizeof(CaptureFrameRecord));
+                    write_offset += sizeof(CaptureFrameRecord);
+                    write_padding();
+
+                    file_stream.write((char*) frame.buffer.data(), samples_to_save * sizeof(std::complex<data_type>));
+                    write_offset += samples_to_save * sizeof(std::complex<data_type>);
+
+                    frame_index.push_back(record);
+                }
+
+                /**
+                 * @brief write the trailing index, update the header, and close the file
+                 *
+                 */
+                void close(void){
+                    if (! file_stream.is_open())
+                    {
+                        return;
+                    }
+
+                    //write the index
+                    CaptureIndexHeader index_header;
+                    std::memcpy(index_header.magic, capture_index_magic, sizeof(capture_index_magic));
+                    index_header.num_frames = frame_index.size();
+
+                    header.num_frames = frame_index.size();
+                    header.index_offset = write_offset;
+
+                    file_stream.write((char*) &index_header, sizeof(CaptureIndexHeader));
+                    if (! frame_index.empty())
+                    {
+                        file_stream.write((char*) frame_index.data(), frame_index.size() * sizeof(CaptureFrameRecord));
+                    }
+
+                    //rewrite the header
+                    file_stream.seekp(0, std::ios::beg);
+                    file_stream.write((char*) &header, sizeof(CaptureFileHeader));
+                    file_stream.close();
+
+                    std::cout << "CaptureFileWriter::close: wrote " << header.num_frames << " frames to " << file_path << std::endl;
+                }
+
+            private:
+
+                /**
+                 * @brief pad the file to the next multiple of the data alignment
+                 *
+                 */
+                void write_padding(void){
+                    uint64_t aligned_offset = align_capture_offset(write_offset, header.data_alignment);
+                    file_stream.write(padding.data(), aligned_offset - write_offset);
+                    write_offset = aligned_offset;
+                }
+        };
+
+        /**
+         * @brief Reads a capture file by memory mapping it, frames can be accessed in
+         * any order in O(1) without parsing the file
+         *
+         * @tparam data_type the cpu_format used for the USRP device, will be std::complex<data_type>
+         */
+        template<typename data_type>
+        class CaptureFileReader {
+            private:
+                std::string file_path;
+                int file_descriptor;
+                char * mapped_file;
+                size_t mapped_size;
+
+                //header and index
+                const CaptureFileHeader * header;
+                std::vector<CaptureFrameRecord> recovered_index; //used if the file was not closed
+                const CaptureFrameRecord * frame_index;
+                size_t num_frames;
+
+            public:
+
+                /**
+                 * @brief Construct a new CaptureFileReader object
+                 *
+                 */
+                CaptureFileReader():
+                    file_descriptor(-1),
+                    mapped_file(nullptr),
+                    mapped_size(0),
+                    header(nullptr),
+                    frame_index(nullptr),
+                    num_frames(0) {}
+
+                /**
+                 * @brief Destroy the CaptureFileReader object (unmaps the file)
+                 *
+                 */
+                ~CaptureFileReader(){
+                    close();
+                }
+
+                //the mapping can't be shared between readers
+                CaptureFileReader(const CaptureFileReader &) = delete;
+                CaptureFileReader & operator=(const CaptureFileReader &) = delete;
+
+                /**
+                 * @brief open and memory map a capture file. If the file was not closed (no index),
+                 * the index is recovered by walking the frame records
+                 *
+                 * @param path the path of the capture file
+                 * @return true - the file was opened and is a valid capture file
+                 * @return false - the file couldn't be opened or isn't a valid capture file
+                 */
+                bool open(std::string path){
+                    close();
+                    file_path = path;
+
+                    file_descriptor = ::open(file_path.c_str(), O_RDONLY);
+                    if (file_descriptor < 0)
+                    {
+                        std::cerr << "CaptureFileReader::open: failed to open " << file_path << std::endl;
+                        return false;
+                    }
+
+                    struct stat file_stats;
+                    if (fstat(file_descriptor, &file_stats) != 0 ||
+                        static_cast<size_t>(file_stats.st_size) < sizeof(CaptureFileHeader))
+                    {
+                        std::cerr << "CaptureFileReader::open: " << file_path << " is too small to be a capture file" << std::endl;
+                        close();
+                        return false;
+                    }
+                    mapped_size = static_cast<size_t>(file_stats.st_size);
+
+                    void * mapping = mmap(nullptr, mapped_size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+                    if (mapping == MAP_FAILED)
+                    {
+                        std::cerr << "CaptureFileReader::open: failed to mmap " << file_path << std::endl;
+                        mapped_size = 0;
+                        close();
+                        return false;
+                    }
+                    mapped_file = static_cast<char *>(mapping);
+                    header = reinterpret_cast<const CaptureFileHeader *>(mapped_file);
+
+                    if (! check_header())
+                    {
+                        close();
+                        return false;
+                    }
+
+                    if (! load_index())
+                    {
+                        recover_index();
+                    }
+                    return true;
+                }
+
+                /**
+                 * @brief unmap and close the capture file
+                 *
+                 */
+                void close(void){
+                    if (mapped_file != nullptr)
+                    {
+                        munmap(mapped_file, mapped_size);
+                        mapped_file = nullptr;
+                        mapped_size = 0;
+                    }
+                    if (file_descriptor >= 0)
+                    {
+                        ::close(file_descriptor);
+                        file_descriptor = -1;
+                    }
+                    header = nullptr;
+                    frame_index = nullptr;
+                    recovered_index.clear();
+                    num_frames = 0;
+                }
+
+                /**
+                 * @brief Get the file header
+                 *
+                 */
+                const CaptureFileHeader & get_header(void) const{
+                    return *header;
+                }
+
+                /**
+                 * @brief Get the number of frames in the file
+                 *
+                 */
+                size_t get_num_frames(void) const{
+                    return num_frames;
+                }
+
+                /**
+                 * @brief Get the record for a frame
+                 *
+                 * @param frame the frame number
+                 */
+                const CaptureFrameRecord & get_frame_record(size_t frame) const{
+                    return frame_index[frame];
+                }
+
+                /**
+                 * @brief Get a pointer to a frame's samples in the mapped file (no copy)
+                 *
+                 * @param frame the frame number
+                 * @return const std::complex<data_type>* the frame's samples
+                 * (get_frame_record(frame).num_samples of them)
+                 */
+                const std::complex<data_type> * get_frame_data(size_t frame) const{
+                    return reinterpret_cast<const std::complex<data_type> *>(mapped_file + frame_index[frame].data_offset);
+                }
+
+                /**
+                 * @brief copy a frame into a buffer with the frame geometry from the header
+                 * (the buffer is reallocated if its dimensions don't match)
+                 *
+                 * @param frame the frame number
+                 * @param frame_buffer the buffer to load the frame into
+                 */
+                void load_frame(size_t frame, Buffer_2D<std::complex<data_type>> & frame_buffer) const{
+                    size_t rows = header -> rows_per_frame;
+                    size_t cols = header -> samples_per_row;
+                    if (frame_buffer.buffer.num_samples() != rows * cols ||
+                        frame_buffer.num_rows != rows || frame_buffer.num_cols != cols)
+                    {
+                        frame_buffer.buffer = Buffers::Array_2D<std::complex<data_type>>(rows, cols);
+                        frame_buffer.num_rows = rows;
+                        frame_buffer.num_cols = cols;
+                        frame_buffer.buffer_init_status = true;
+                    }
+                    frame_buffer.excess_samples = header -> excess_samples;
+
+                    size_t samples_to_copy = std::min(static_cast<size_t>(frame_index[frame].num_samples), rows * cols);
+                    std::memcpy(frame_buffer.buffer.data(), get_frame_data(frame), samples_to_copy * sizeof(std::complex<data_type>));
+                    std::fill(frame_buffer.buffer.data() + samples_to_copy, frame_buffer.buffer.data() + rows * cols, std::complex<data_type>(0));
+                }
+
+                /**
+                 * @brief print the header and a summary of the frames
+                 *
+                 */
+                void print_summary(void) const{
+                    size_t num_overflows = 0;
+                    for (size_t i = 0; i < num_frames; i++)
+                    {
+                        num_overflows += frame_index[i].overflow;
+                    }
+                    std::cout << "CaptureFileReader::print_summary: " << file_path << std::endl <<
+                                "\tsample format: " << ((header -> sample_format == capture_format_fc64) ? "fc64" : "fc32") <<
+                                ", rx rate: " << header -> rx_rate << " Sps, rx frequency: " << header -> rx_frequency <<
+                                " Hz, rx gain: " << header -> rx_gain << " dB" << std::endl <<
+                                "\tframe: " << header -> rows_per_frame << " x " << header -> samples_per_row <<
+                                " samples (" << header -> excess_samples << " excess), " <<
+                                header -> chirps_per_frame << " chirps of " << header -> samples_per_chirp << " samples" << std::endl <<
+                                "\tframes: " << num_frames << ", frames with overflows: " << num_overflows <<
+                                (header -> index_offset == 0 ? " (index recovered)" : "") << std::endl << std::endl;
+                }
+
+            private:
+
+                /**
+                 * @brief check the magic, version, and sample format of the header
+                 *
+                 */
+                bool check_header(void){
+                    if (std::memcmp(header -> magic, capture_header_magic, sizeof(capture_header_magic)) != 0)
+                    {
+                        std::cerr << "CaptureFileReader::check_header: " << file_path << " is not a capture file" << std::endl;
+                        return false;
+                    }
+                    if (header -> version != capture_file_version)
+                    {
+                        std::cerr << "CaptureFileReader::check_header: unsupported version " << header -> version << std::endl;
+                        return false;
+                    }
+                    if (header -> sample_format != get_capture_sample_format<data_type>() ||
+                        header -> sample_size != sizeof(std::complex<data_type>))
+                    {
+                        std::cerr << "CaptureFileReader::check_header: sample format doesn't match the reader's data type" << std::endl;
+                        return false;
+                    }
+                    if (header -> data_alignment == 0)
+                    {
+                        std::cerr << "CaptureFileReader::check_header: invalid data alignment" << std::endl;
+                        return false;
+                    }
+                    return true;
+                }
+
+                /**
+                 * @brief point the frame index at the trailing index in the mapped file
+                 *
+                 * @return true - the index is valid
+                 * @return false - the file has no (valid) index
+                 */
+                bool load_index(void){
+                    uint64_t index_offset = header -> index_offset;
+                    if (index_offset == 0 || index_offset > mapped_size - sizeof(CaptureIndexHeader))
+                    {
+                        return false;
+                    }
+
+                    const CaptureIndexHeader * index_header = reinterpret_cast<const CaptureIndexHeader *>(mapped_file + index_offset);
+                    if (std::memcmp(index_header -> magic, capture_index_magic, sizeof(capture_index_magic)) != 0 ||
+                        index_header -> num_frames != header -> num_frames ||
+                        index_header -> num_frames > (mapped_size - index_offset - sizeof(CaptureIndexHeader)) / sizeof(CaptureFrameRecord))
+                    {
+                        std::cerr << "CaptureFileReader::load_index: index is corrupt, recovering it from the frame records" << std::endl;
+                        return false;
+                    }
+
+                    //every frame must be stored between the file header and the index
+                    const CaptureFrameRecord * records = reinterpret_cast<const CaptureFrameRecord *>(mapped_file + index_offset + sizeof(CaptureIndexHeader));
+                    uint64_t alignment = header -> data_alignment;
+                    uint64_t first_data_offset = align_capture_offset(
+                        align_capture_offset(sizeof(CaptureFileHeader), alignment) + sizeof(CaptureFrameRecord), alignment);
+                    for (uint64_t i = 0; i < index_header -> num_frames; i++)
+                    {
+                        if (! check_record(records[i], first_data_offset, index_offset))
+                        {
+                            std::cerr << "CaptureFileReader::load_index: frame " << i << " is outside of the file, recovering the index from the frame records" << std::endl;
+                            return false;
+                        }
+                    }
+
+                    frame_index = records;
+                    num_frames = index_header -> num_frames;
+                    return true;
+                }
+
+                /**
+                 * @brief check that a frame record's samples are within [min_offset, end_offset) of the mapped file
+                 *
+                 * @param record the frame record
+                 * @param min_offset the smallest valid data offset
+                 * @param end_offset the offset that the samples must end at or before (at most mapped_size)
+                 * @return true - the record is valid
+                 * @return false - the record's magic is wrong or its samples are outside of the range
+                 */
+                bool check_record(const CaptureFrameRecord & record, uint64_t min_offset, uint64_t end_offset) const{
+                    if (std::memcmp(record.magic, capture_frame_magic, sizeof(capture_frame_magic)) != 0 ||
+                        record.data_offset < min_offset || record.data_offset > end_offset)
+                    {
+                        return false;
+                    }
+                    //compare sample counts so that a corrupt num_samples can't overflow the end offset
+                    return record.num_samples <= (end_offset - record.data_offset) / sizeof(std::complex<data_type>);
+                }
+
+                /**
+                 * @brief rebuild the index by walking the frame records (for files that were not closed),
+                 * stops at the first incomplete frame
+                 *
+                 */
+                void recover_index(void){
+                    recovered_index.clear();
+                    uint64_t alignment = header -> data_alignment;
+                    uint64_t offset = align_capture_offset(sizeof(CaptureFileHeader), alignment);
+
+                    while (offset + sizeof(CaptureFrameRecord) <= mapped_size)
+                    {
+                        const CaptureFrameRecord * record = reinterpret_cast<const CaptureFrameRecord *>(mapped_file + offset);
+                        if (! check_record(*record, offset + sizeof(CaptureFrameRecord), mapped_size))
+                        {
+                            break;
+                        }
+                        recovered_index.push_back(*record);
+                        offset = record -> data_offset + record -> num_samples * sizeof(std::complex<data_type>);
+                    }
+
+                    frame_index = recovered_index.data();
+                    num_frames = recovered_index.size();
+                    std::cout << "CaptureFileReader::recover_index: recovered " << num_frames << " frames" << std::endl;
+                }
+        };
+    }
+#endif
@@ -0,0 +1,345 @@
+#ifndef FMCWDAEMON
+#define FMCWDAEMON
+    //C standard libraries
+    #include <iostream>
+    #include <cstdlib>
+    #include <cstring>
+    #include <cerrno>
+    #include <string>
+    #include <chrono>
+
+    //unix domain sockets
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+
+    //JSON class
+    #include <nlohmann/json.hpp>
+
+    //user generated header files
+    #include "FMCWHandler.hpp"
+
+    using json = nlohmann::json;
+    using FMCWHandler_namespace::FMCWHandler;
+
+    namespace FMCWDaemon_namespace {
+
+        /**
+         * @brief A long-running service that keeps the victim and attacker (their initialized
+         * USRPs, preloaded waveforms, and measured noise power) resident between experiments.
+         * Requests are received on a local unix socket as one JSON object per line and each
+         * request gets a single line JSON response. Requests:
+         *  {"command": "run", "radar_config": {...}, "attack_config": {...}} - apply the (optional)
+         *      configuration changes and run an experiment
+         *  {"command": "update", "radar_config": {...}, "attack_config": {...}} - only apply the
+         *      configuration changes
+         *  {"command": "status"} - report the number of runs completed
+         *  {"command": "shutdown"} - stop the daemon
+         * The configuration changes are JSON merge patches of the radar/attack configurations
+         * (ex: {"RadarSettings": {"num_frames": 50}, "USRPSettings": {"RX": {"gain": 30}}})
+         *
+         * @tparam data_type the data type used by the victim and attacker
+         */
+        template<typename data_type>
+        class FMCWDaemon {
+            private:
+                //resident victim and attacker
+                FMCWHandler<data_type> fmcw_handler;
+
+                //socket
+                std::string socket_path;
+                int listen_fd;
+                bool stop_requested;
+
+                //statistics
+                size_t num_runs;
+                double last_run_time_ms;
+
+            public:
+
+                /**
+                 * @brief Construct a new FMCWDaemon object (initializes the victim and attacker)
+                 *
+                 * @param victim_config_obj a JSON config object for the victim
+                 * @param attack_config_obj a JSON config object for the attacker
+                 * @param path the path of the unix socket to listen on
+                 */
+                FMCWDaemon(json victim_config_obj, json attack_config_obj, std::string path)
+                    : fmcw_handler(victim_config_obj, attack_config_obj, false),
+                    socket_path(path),
+                    listen_fd(-1),
+                    stop_requested(false),
+                    num_runs(0),
+                    last_run_time_ms(0){}
+
+                /**
+                 * @brief Destroy the FMCWDaemon object (closes and removes the socket)
+                 *
+                 */
+                ~FMCWDaemon(){
+                    close_socket();
+                }
+
+                /**
+                 * @brief Listen on the socket and handle requests until a shutdown request is received
+                 *
+                 * @return true - the daemon was shut down by a request
+                 * @return false - the socket couldn't be opened
+                 */
+                bool run(void){
+                    if (! open_socket())
+                    {
+                        return false;
+                    }
+                    std::cout << "FMCWDaemon::run: listening on " << socket_path << std::endl << std::endl;
+
+                    while (! stop_requested)
+                    {
+                        int client_fd = accept(listen_fd, nullptr, nullptr);
+                        if (client_fd < 0)
+                        {
+                            if (errno == EINTR)
+                            {
+                                continue;
+                            }
+                            std::cerr << "FMCWDaemon::run: accept failed: " << std::strerror(errno) << std::endl;
+                            break;
+                        }
+                        handle_client(client_fd);
+                        close(client_fd);
+                    }
+
+                    close_socket();
+                    std::cout << "FMCWDaemon::run: stopped after " << num_runs << " runs" << std::endl;
+                    return true;
+                }
+
+            private:
+
+                /**
+                 * @brief Create the unix socket and listen on it (replacing a stale socket, but
+                 * not any other kind of file)
+                 *
+                 * @return true - the socket is listening
+                 * @return false - the socket couldn't be created
+                 */
+                bool open_socket(void){
+                    sockaddr_un addr;
+                    std::memset(&addr, 0, sizeof(addr));
+                    addr.sun_family = AF_UNIX;
+                    if (socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path))
+                    {
+                        std::cerr << "FMCWDaemon::open_socket: invalid socket path: " << socket_path << std::endl;
+                        return false;
+                    }
+                    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+                    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+                    if (listen_fd < 0)
+                    {
+                        std::cerr << "FMCWDaemon::open_socket: couldn't create socket: " << std::strerror(errno) << std::endl;
+                        return false;
+                    }
+
+                    //only replace a stale socket (never a regular file, directory, or link)
+                    struct stat existing;
+                    if (lstat(socket_path.c_str(), &existing) == 0)
+                    {
+                        if (! S_ISSOCK(existing.st_mode))
+                        {
+                            std::cerr << "FMCWDaemon::open_socket: " << socket_path <<
+                                        " already exists and isn't a socket" << std::endl;
+                            close(listen_fd);
+                            listen_fd = -1;
+                            return false;
+                        }
+                        unlink(socket_path.c_str());
+                    }
+
+                    //only the user running the daemon can send it requests (the socket is created
+                    //with these permissions, so there is no window where others can connect)
+                    mode_t previous_umask = umask(S_IRWXG | S_IRWXO | S_IXUSR);
+                    bool bound = bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0;
+                    umask(previous_umask);
+                    if ((! bound) || listen(listen_fd, 4) < 0)
+                    {
+                        std::cerr << "FMCWDaemon::open_socket: couldn't listen on " << socket_path <<
+                                    ": " << std::strerror(errno) << std::endl;
+                        close(listen_fd);
+                        listen_fd = -1;
+                        return false;
+                    }
+                    return true;
+                }
+
+                /**
+                 * @brief Close the listening socket and remove the socket file
+                 *
+                 */
+                void close_socket(void){
+                    if (listen_fd >= 0)
+                    {
+                        close(listen_fd);
+                        unlink(socket_path.c_str());
+                        listen_fd = -1;
+                    }
+                }
+
+                /**
+                 * @brief Handle each request (line) from a client until it disconnects
+                 * or a shutdown is requested
+                 *
+                 * @param client_fd the client's socket
+                 */
+                void handle_client(int client_fd){
+                    std::string received;
+                    char chunk[4096];
+
+                    while (! stop_requested)
+                    {
+                        //handle every complete line that has been received
+                        size_t line_end;
+                        while ((line_end = received.find('\n')) != std::string::npos)
+                        {
+                            std::string line = received.substr(0, line_end);
+                            received.erase(0, line_end + 1);
+                            if (line.find_first_not_of(" \t\r") == std::string::npos)
+                            {
+                                continue;
+                            }
+
+                            json response = handle_request(line);
+                            if (! send_line(client_fd, response.dump()) || stop_requested)
+                            {
+                                return;
+                            }
+                        }
+
+                        ssize_t num_received = recv(client_fd, chunk, sizeof(chunk), 0);
+                        if (num_received < 0 && errno == EINTR)
+                        {
+                            continue;
+                        }
+                        if (num_received <= 0)
+                        {
+                            return;
+                        }
+                        received.append(chunk, static_cast<size_t>(num_received));
+                    }
+                }
+
+                /**
+                 * @brief Carry out a request, any error (ex: a setting with the wrong type) is
+                 * returned as an error response instead of stopping the daemon
+                 *
+                 * @param line the request (a JSON object)
+                 * @return json the response
+                 */
+                json handle_request(const std::string & line){
+                    try
+                    {
+                        return process_request(line);
+                    }
+                    catch(const std::exception & e)
+                    {
+                        std::cerr << "FMCWDaemon::handle_request: request failed: " << e.what() << std::endl;
+                        json response;
+                        response["status"] = "error";
+                        response["message"] = std::string("request failed: ") + e.what();
+                        response["num_runs"] = num_runs;
+                        return response;
+                    }
+                }
+
+                /**
+                 * @brief Parse and carry out a request
+                 *
+                 * @param line the request (a JSON object)
+                 * @return json the response
+                 */
+                json process_request(const std::string & line){
+                    json response;
+                    json request = json::parse(line, nullptr, false);
+                    if (request.is_discarded() || (! request.is_object()) || (! request["command"].is_string()))
+                    {
+                        response["status"] = "error";
+                        response["message"] = "requests must be JSON objects with a command";
+                        return response;
+                    }
+                    std::string command = request["command"].get<std::string>();
+
+                    if (command == "run" || command == "update")
+                    {
+                        //apply the configuration changes
+                        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                        std::string error_message;
+                        if (! fmcw_handler.update_config(request["radar_config"], request["attack_config"], error_message))
+                        {
+                            response["status"] = "error";
+                            response["message"] = error_message;
+                            return response;
+                        }
+                        std::chrono::steady_clock::time_point updated = std::chrono::steady_clock::now();
+                        response["update_time_ms"] = std::chrono::duration<double,std::milli>(updated - start).count();
+
+                        //run the experiment
+                        if (command == "run")
+                        {
+                            std::cout << "FMCWDaemon::process_request: starting run " << num_runs + 1 << std::endl;
+                            fmcw_handler.run_FMCW();
+                            last_run_time_ms = std::chrono::duration<double,std::milli>(
+                                std::chrono::steady_clock::now() - updated).count();
+                            num_runs += 1;
+                            response["run_time_ms"] = last_run_time_ms;
+                        }
+                        response["status"] = "ok";
+                    }
+                    else if (command == "status")
+                    {
+                        response["status"] = "ok";
+                        response["last_run_time_ms"] = last_run_time_ms;
+                    }
+                    else if (command == "shutdown")
+                    {
+                        stop_requested = true;
+                        response["status"] = "ok";
+                    }
+                    else{
+                        response["status"] = "error";
+                        response["message"] = "unknown command: " + command;
+                    }
+                    response["num_runs"] = num_runs;
+                    return response;
+                }
+
+                /**
+                 * @brief Send a line (a response) to a client
+                 *
+                 * @param client_fd the client's socket
+                 * @param line the line to send (a newline is appended)
+                 * @return true - the line was sent
+                 * @return false - the client disconnected
+                 */
+                bool send_line(int client_fd, std::string line){
+                    line.push_back('\n');
+                    size_t num_sent = 0;
+                    while (num_sent < line.size())
+                    {
+                        ssize_t sent = send(client_fd, line.data() + num_sent, line.size() - num_sent, MSG_NOSIGNAL);
+                        if (sent < 0 && errno == EINTR)
+                        {
+                            continue;
+                        }
+                        if (sent <= 0)
+                        {
+                            return false;
+                        }
+                        num_sent += static_cast<size_t>(sent);
+                    }
+                    return true;
+                }
+        };
+    }
+#endif
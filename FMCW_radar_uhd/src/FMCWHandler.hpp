@@ -2,11 +2,22 @@
 #define FMCWHANDLER
 
 
+//C standard libraries
+    #include <iostream>
+    #include <thread>
+    #include <chrono>
+    #include <memory>
+    #include <exception>
+    #include <string>
+    #include <vector>
+    #include <cstdint>
+
 //Radar Class
     #include "RADAR.hpp"
     #include "Attacker.hpp"
 //JSON class
     #include <nlohmann/json.hpp>
+    #include "JSONHandler.hpp"
 
 using RADAR_namespace::RADAR;
 using ATTACKER_namespace::ATTACKER;
@@ -24,8 +35,9 @@ namespace FMCWHandler_namespace {
             json victim_config;
             json attack_config;
             
-            RADAR<data_type> Victim;
-            ATTACKER<data_type> Attacker;
+            //the victim and attacker are created by init_devices (only the ones that will be run)
+            std::unique_ptr<RADAR<data_type>> Victim;
+            std::unique_ptr<ATTACKER<data_type>> Attacker;
 
         public:
             /**
@@ -37,13 +49,12 @@ namespace FMCWHandler_namespace {
              */
             FMCWHandler(json victim_config_obj,json attack_config_obj, bool run = false)
                 :victim_config(victim_config_obj),
-                attack_config(attack_config_obj),
-                Victim(victim_config_obj,true, false),
-                Attacker(attack_config_obj,false){
+                attack_config(attack_config_obj){
                     
                     if(check_config())
                     {
                         get_enabled_status();
+                        init_devices();
                         if (run)
                         {
                             run_FMCW();
@@ -82,6 +93,258 @@ namespace FMCWHandler_namespace {
                 victim_enabled = victim_config["Radar_enabled"].get<bool>();
             }
 
+            /**
+             * @brief Create the victim and the attacker that will be run. When both are needed,
+             * they are brought up concurrently (each on its own thread) so that their device
+             * setup, LO settling, and noise measurement overlap. The time taken for each
+             * is reported
+             * 
+             */
+            void init_devices(void){
+                bool init_victim = victim_enabled || (! attack_enabled);
+                std::exception_ptr victim_error;
+                std::exception_ptr attacker_error;
+                double victim_startup_ms = 0;
+                double attacker_startup_ms = 0;
+
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+                //bring up the victim on its own thread
+                std::thread victim_thread;
+                if (init_victim)
+                {
+                    victim_thread = std::thread([&]() {
+                        try
+                        {
+                            Victim.reset(new RADAR<data_type>(victim_config,true, false));
+                        }
+                        catch(...)
+                        {
+                            victim_error = std::current_exception();
+                        }
+                        victim_startup_ms = std::chrono::duration<double,std::milli>(
+                            std::chrono::steady_clock::now() - start).count();
+                    });
+                }
+
+                //bring up the attacker on this thread
+                if (attack_enabled)
+                {
+                    try
+                    {
+                        Attacker.reset(new ATTACKER<data_type>(attack_config,false));
+                    }
+                    catch(...)
+                    {
+                        attacker_error = std::current_exception();
+                    }
+                    attacker_startup_ms = std::chrono::duration<double,std::milli>(
+                        std::chrono::steady_clock::now() - start).count();
+                }
+
+                if (victim_thread.joinable())
+                {
+                    victim_thread.join();
+                }
+                double total_startup_ms = std::chrono::duration<double,std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+
+                std::cout << "FMCWHandler::init_devices: startup times: victim: " << victim_startup_ms <<
+                            " ms, attacker: " << attacker_startup_ms << " ms, total: " << total_startup_ms <<
+                            " ms" << std::endl << std::endl;
+
+                //report any errors from the startup
+                if (victim_error)
+                {
+                    std::rethrow_exception(victim_error);
+                }
+                if (attacker_error)
+                {
+                    std::rethrow_exception(attacker_error);
+                }
+            }
+
+            /**
+             * @brief Apply changes to the victim and attacker configurations between runs. Only the
+             * settings that can be changed on the initialized devices are accepted (see
+             * check_config_update), in which case only what depends on the changed settings is
+             * re-initialized (ex: retuning, new gains, or a new waveform)
+             * 
+             * @param victim_config_delta JSON merge patch for the victim configuration (ex: {"RadarSettings":{"num_frames":50}})
+             * @param attack_config_delta JSON merge patch for the attacker configuration
+             * @param error_message set to the reason the update was rejected or failed (if it was)
+             * @return true - the update was applied
+             * @return false - the update was rejected or couldn't be applied (the devices are
+             * returned to the current configuration and it is kept)
+             */
+            bool update_config(const json & victim_config_delta,
+                                const json & attack_config_delta,
+                                std::string & error_message){
+                if ((victim_config_delta.is_null() == false && victim_config_delta.is_object() == false) ||
+                    (attack_config_delta.is_null() == false && attack_config_delta.is_object() == false))
+                {
+                    error_message = "configuration changes must be JSON objects";
+                    return false;
+                }
+
+                json new_victim_config = victim_config;
+                json new_attack_config = attack_config;
+                if (victim_config_delta.is_null() == false)
+                {
+                    new_victim_config.merge_patch(victim_config_delta);
+                }
+                if (attack_config_delta.is_null() == false)
+                {
+                    new_attack_config.merge_patch(attack_config_delta);
+                }
+
+                //make sure every changed setting can be applied before changing anything
+                if (! (check_config_update(victim_config, new_victim_config, Victim != nullptr, "victim", error_message) &&
+                        check_config_update(attack_config, new_attack_config, Attacker != nullptr, "attacker", error_message)))
+                {
+                    return false;
+                }
+
+                //apply the changes to the devices, the new configuration is only kept if both succeed
+                try
+                {
+                    if (Victim)
+                    {
+                        Victim -> update_config(new_victim_config);
+                    }
+                    if (Attacker)
+                    {
+                        Attacker -> update_config(new_attack_config);
+                    }
+                }
+                catch(const std::exception & e)
+                {
+                    error_message = std::string("couldn't apply the configuration update: ") + e.what();
+
+                    //return the devices to the current configuration
+                    try
+                    {
+                        if (Victim)
+                        {
+                            Victim -> update_config(victim_config);
+                        }
+                        if (Attacker)
+                        {
+                            Attacker -> update_config(attack_config);
+                        }
+                    }
+                    catch(const std::exception & rollback_error)
+                    {
+                        error_message += std::string(" (restoring the previous configuration also failed: ") +
+                                        rollback_error.what() + ")";
+                    }
+                    std::cerr << "FMCWHandler::update_config: " << error_message << std::endl;
+                    return false;
+                }
+
+                victim_config = new_victim_config;
+                attack_config = new_attack_config;
+                return true;
+            }
+
+            /**
+             * @brief Check that every setting changed by a configuration update can be applied to
+             * an initialized device (settings such as the device, sampling rate, streamer settings,
+             * or spectrogram parameters require restarting) and that each changed setting has the
+             * type the device reads it as (ex: num_chirps must be a non-negative integer)
+             * 
+             * @param old_config the current configuration
+             * @param new_config the updated configuration
+             * @param initialized true if the victim/attacker using the configuration has been created
+             * @param name the name of the victim/attacker (for the error message)
+             * @param error_message set to the first setting that can't be applied (if any)
+             * @return true - the update can be applied
+             * @return false - the update changes a setting that can't be applied or sets a
+             * setting to the wrong type
+             */
+            bool check_config_update(const json & old_config,
+                                    const json & new_config,
+                                    bool initialized,
+                                    const std::string & name,
+                                    std::string & error_message){
+                //the updatable settings and their types ("number", "unsigned" (a non-negative
+                //integer), "string", "bool", or "object")
+                static const char * updatable_settings[][2] = {
+                    {"/USRPSettings/Multi-USRP/center_freq", "number"},
+                    {"/USRPSettings/Multi-USRP/lo-offset", "number"},
+                    {"/USRPSettings/Multi-USRP/IF_filter_bw", "number"},
+                    {"/USRPSettings/Multi-USRP/stream_start_time", "number"},
+                    {"/USRPSettings/RX/gain", "number"},
+                    {"/USRPSettings/TX/gain", "number"},
+                    {"/USRPSettings/RX/offset_us", "number"},
+                    {"/RadarSettings/num_chirps", "unsigned"},
+                    {"/RadarSettings/num_frames", "unsigned"},
+                    {"/RadarSettings/frame_periodicity_ms", "number"},
+                    {"/RadarSettings/tx_file_name", "string"},
+                    {"/RadarSettings/rx_file_name", "string"},
+                    {"/RadarSettings/rx_file_format", "string"},
+                    {"/AttackSubsystemSettings", "object"},
+                    {"/AttackSubsystemSettings/tx_file_name", "string"},
+                    {"/AttackSubsystemSettings/enabled", "bool"},
+                    {"/AttackSubsystemSettings/num_attack_frames", "unsigned"},
+                    {"/AttackSubsystemSettings/attack_start_frame", "unsigned"},
+                    {"/AttackSubsystemSettings/estimated_frame_periodicity_ms", "number"}
+                };
+                static const size_t num_updatable_settings = sizeof(updatable_settings) / sizeof(updatable_settings[0]);
+
+                std::vector<std::string> changed = JSONHandler::changed_settings(old_config, new_config);
+                if (changed.empty())
+                {
+                    return true;
+                }
+                if (! initialized)
+                {
+                    error_message = "can't update the configuration of the disabled " + name;
+                    return false;
+                }
+
+                for (size_t i = 0; i < changed.size(); i++)
+                {
+                    //the changed setting must be an updatable setting or within one
+                    bool updatable = false;
+                    for (size_t j = 0; j < num_updatable_settings && (! updatable); j++)
+                    {
+                        std::string setting(updatable_settings[j][0]);
+                        updatable = (changed[i].compare(0, setting.size(), setting) == 0) &&
+                                    (changed[i].size() == setting.size() || changed[i][setting.size()] == '/');
+                    }
+                    if (! updatable)
+                    {
+                        error_message = name + " setting " + changed[i] + " can't be changed without restarting";
+                        return false;
+                    }
+                }
+
+                //every updatable setting that changed must still be set and have the right type
+                for (size_t j = 0; j < num_updatable_settings; j++)
+                {
+                    if (! JSONHandler::setting_changed(changed, updatable_settings[j][0]))
+                    {
+                        continue;
+                    }
+                    const json * value = JSONHandler::find_setting(new_config, updatable_settings[j][0]);
+                    std::string type(updatable_settings[j][1]);
+                    bool valid = (value != nullptr) &&
+                                ((type == "number" && value -> is_number()) ||
+                                (type == "unsigned" && value -> is_number_integer() && value -> get<int64_t>() >= 0) ||
+                                (type == "string" && value -> is_string()) ||
+                                (type == "bool" && value -> is_boolean()) ||
+                                (type == "object" && value -> is_object()));
+                    if (! valid)
+                    {
+                        error_message = name + " setting " + std::string(updatable_settings[j][0]) +
+                                        " must be set to a value of type " + type;
+                        return false;
+                    }
+                }
+                return true;
+            }
+
             /**
              * @brief Run the FMCW simulation with the vicitm and attacker in separate threads
              * 
@@ -92,12 +355,12 @@ namespace FMCWHandler_namespace {
                     {
                         //create victim thread
                         std::thread victim_thread([&]() {
-                            Victim.run_RADAR();
+                            Victim -> run_RADAR();
                         });
 
                         //run the attacker
                         std::cout << "running attack" << std::endl;
-                        Attacker.run_attacker();
+                        Attacker -> run_attacker();
 
                         //wait for victim thread to finish
                         victim_thread.join();
@@ -106,12 +369,12 @@ namespace FMCWHandler_namespace {
                     {
                         //run the attacker
                         std::cout << "running attack" << std::endl;
-                        Attacker.run_attacker();
+                        Attacker -> run_attacker();
                     }
                     else
                     {
                         //run the victim
-                        Victim.run_RADAR();
+                        Victim -> run_RADAR();
                     }
             }
 
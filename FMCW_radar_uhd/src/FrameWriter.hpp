@@ -0,0 +1,323 @@
+#ifndef FRAMEWRITER
+#define FRAMEWRITER
+    //C standard libraries
+    #include <iostream>
+    #include <cstdlib>
+    #include <string>
+    #include <complex>
+    #include <vector>
+    #include <thread>
+    #include <mutex>
+    #include <condition_variable>
+    #include <atomic>
+    #include <functional>
+
+    //user generated header files
+    #include "BufferHandler.hpp"
+    #include "CaptureFile.hpp"
+
+    using Buffers::Buffer_2D;
+    using CaptureFile_namespace::CaptureFileWriter;
+    using CaptureFile_namespace::CaptureFrameMetadata;
+
+    namespace FrameWriter_namespace {
+
+        /**
+         * @brief A lock-free single producer/single consumer ring of preallocated
+         * frame slots. The producer (the thread servicing rx_stream -> recv) fills
+         * slots with received frames, and a dedicated writer thread (the consumer)
+         * saves them to the write file of a destination buffer (or to a capture file)
+         * so that the receive loop never has to touch the filesystem. Slots are handed over
+         * by index and are kept between runs (only reallocated if the frame size changes),
+         * and the writer thread sleeps on a condition variable while the ring is empty (the
+         * producer only takes the writer's mutex to wake it when it is actually sleeping).
+         *
+         * @tparam data_type the cpu_format used for the USRP device, will be std::complex<data_type>
+         */
+        template<typename data_type>
+        class FrameWriter {
+            public:
+                //callback used to process each frame on the writer thread before it is saved
+                typedef std::function<void(Buffer_2D<std::complex<data_type>> &)> frame_processor_t;
+
+            private:
+                //preallocated frame slots
+                std::vector<Buffer_2D<std::complex<data_type>>> frame_slots;
+                std::vector<CaptureFrameMetadata> slot_metadata;
+                size_t num_slots;
+
+                //ring indicies (free running counters, slot = index % num_slots)
+                std::atomic<size_t> write_index; //only modified by the producer
+                std::atomic<size_t> read_index; //only modified by the consumer
+
+                //writer thread
+                std::thread writer_thread;
+                std::mutex writer_mutex;
+                std::condition_variable writer_cv; //signaled when a slot is committed or on stop
+                bool stop_requested; //protected by the writer mutex
+                std::atomic<bool> writer_sleeping; //set by the writer thread before it waits on writer_cv
+                bool writer_running;
+
+                //optional frame processor
+                frame_processor_t frame_processor;
+
+                //optional capture file (frames are saved to it instead of the destination buffer's write file)
+                CaptureFileWriter<data_type> * capture_file;
+
+                //statistics (producer side)
+                size_t frames_committed;
+                size_t frames_dropped;
+                size_t high_water_mark;
+                size_t occupancy_sum;
+
+            public:
+
+                /**
+                 * @brief Construct a new FrameWriter object
+                 *
+                 * @param slots the number of frame slots in the ring (minimum of 2)
+                 */
+                FrameWriter(size_t slots = 4)
+                    : num_slots(slots < 2 ? 2 : slots),
+                    write_index(0),
+                    read_index(0),
+                    stop_requested(false),
+                    writer_sleeping(false),
+                    writer_running(false),
+                    capture_file(nullptr),
+                    frames_committed(0),
+                    frames_dropped(0),
+                    high_water_mark(0),
+                    occupancy_sum(0){}
+
+                /**
+                 * @brief Destroy the FrameWriter object (writes any remaining frames)
+                 *
+                 */
+                ~FrameWriter(){
+                    stop();
+                }
+
+                /**
+                 * @brief Set a function to process each frame on the writer thread before it
+                 * is saved (set before calling start())
+                 *
+                 * @param processor the function to call on each frame
+                 */
+                void set_frame_processor(frame_processor_t processor){
+                    frame_processor = processor;
+                }
+
+                /**
+                 * @brief Save frames (and their metadata) to a capture file instead of the
+                 * destination buffer's write file (set before calling start())
+                 *
+                 * @param file the open capture file, or nullptr to use the destination buffer's write file
+                 */
+                void set_capture_file(CaptureFileWriter<data_type> * file){
+                    capture_file = file;
+                }
+
+                /**
+                 * @brief Set the number of frame slots in the ring (only while the writer isn't running)
+                 *
+                 * @param slots the number of frame slots (minimum of 2)
+                 */
+                void set_num_slots(size_t slots){
+                    if (writer_running)
+                    {
+                        std::cerr << "FrameWriter::set_num_slots: writer running, keeping " << num_slots << " slots" << std::endl;
+                        return;
+                    }
+                    num_slots = slots < 2 ? 2 : slots;
+                }
+
+                /**
+                 * @brief allocate the frame slots (if the ring or frame size changed) and start the writer thread
+                 *
+                 * @param destination_buffer the buffer whose dimensions each slot should have,
+                 * frames are saved to the write file stream of this buffer (must already be open
+                 * unless a capture file was set)
+                 */
+                void start(Buffer_2D<std::complex<data_type>> * destination_buffer){
+                    if (writer_running)
+                    {
+                        std::cerr << "FrameWriter::start: writer already running" << std::endl;
+                        return;
+                    }
+
+                    //the slots are only allocated when the frame size changes (their samples are never copied)
+                    if (frame_slots.size() != num_slots ||
+                        frame_slots[0].num_rows != destination_buffer -> num_rows ||
+                        frame_slots[0].num_cols != destination_buffer -> num_cols)
+                    {
+                        frame_slots.clear();
+                        frame_slots.reserve(num_slots);
+                        for (size_t i = 0; i < num_slots; i++)
+                        {
+                            frame_slots.emplace_back(destination_buffer -> num_rows, destination_buffer -> num_cols);
+                        }
+                        slot_metadata = std::vector<CaptureFrameMetadata>(num_slots);
+                    }
+
+                    //the slots share the destination buffer's write file stream
+                    for (size_t i = 0; i < num_slots; i++)
+                    {
+                        frame_slots[i].write_file_stream = destination_buffer -> write_file_stream;
+                        frame_slots[i].excess_samples = destination_buffer -> excess_samples;
+                    }
+
+                    //reset the ring and the statistics
+                    write_index = 0;
+                    read_index = 0;
+                    frames_committed = 0;
+                    frames_dropped = 0;
+                    high_water_mark = 0;
+                    occupancy_sum = 0;
+
+                    //start the writer thread
+                    stop_requested = false;
+                    writer_sleeping = false;
+                    writer_thread = std::thread([this]() {
+                        run_writer();
+                    });
+                    writer_running = true;
+                }
+
+                /**
+                 * @brief Get the next free slot to receive a frame into (producer only)
+                 *
+                 * @return Buffer_2D<std::complex<data_type>>* pointer to the free slot,
+                 * or nullptr if the ring is full
+                 */
+                Buffer_2D<std::complex<data_type>> * acquire_slot(void){
+                    size_t write = write_index.load(std::memory_order_relaxed);
+                    size_t read = read_index.load(std::memory_order_acquire);
+
+                    if ((write - read) >= num_slots)
+                    {
+                        return nullptr;
+                    }
+                    return & frame_slots[write % num_slots];
+                }
+
+                /**
+                 * @brief Hand the slot returned by acquire_slot() to the writer thread (producer only)
+                 *
+                 * @param metadata the frame's time, overflow status, and number of samples received
+                 * (only saved when writing to a capture file)
+                 */
+                void commit_slot(const CaptureFrameMetadata & metadata = CaptureFrameMetadata()){
+                    slot_metadata[write_index.load(std::memory_order_relaxed) % num_slots] = metadata;
+                    size_t write = write_index.load(std::memory_order_relaxed) + 1;
+                    write_index.store(write, std::memory_order_seq_cst);
+
+                    //only wake the writer thread if it is sleeping (the store above and the load of the
+                    //flag are sequentially consistent, so either the writer sees the new frame before it
+                    //waits or the flag is seen here). The mutex is only held briefly so that the wakeup can't be missed
+                    if (writer_sleeping.load(std::memory_order_seq_cst))
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock(writer_mutex);
+                        }
+                        writer_cv.notify_one();
+                    }
+
+                    //update the occupancy statistics
+                    size_t occupancy = write - read_index.load(std::memory_order_acquire);
+                    occupancy_sum += occupancy;
+                    if (occupancy > high_water_mark)
+                    {
+                        high_water_mark = occupancy;
+                    }
+                    frames_committed += 1;
+                }
+
+                /**
+                 * @brief Record that a frame could not be saved because the ring was full (producer only)
+                 *
+                 */
+                void record_dropped_frame(void){
+                    frames_dropped += 1;
+                }
+
+                /**
+                 * @brief Wait for all committed frames to be written and stop the writer thread
+                 *
+                 */
+                void stop(void){
+                    if (writer_running)
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock(writer_mutex);
+                            stop_requested = true;
+                        }
+                        writer_cv.notify_all();
+                        writer_thread.join();
+                        writer_running = false;
+                    }
+                }
+
+                /**
+                 * @brief Print the ring occupancy and high-water mark for the most recent run
+                 *
+                 */
+                void print_summary(void){
+                    double average_occupancy = 0.0;
+                    if (frames_committed > 0)
+                    {
+                        average_occupancy = static_cast<double>(occupancy_sum) /
+                                            static_cast<double>(frames_committed);
+                    }
+                    std::cout << "FrameWriter::print_summary: frames written: " << frames_committed <<
+                                ", frames dropped (ring full): " << frames_dropped << std::endl;
+                    std::cout << "FrameWriter::print_summary: slots: " << num_slots <<
+                                ", average occupancy: " << average_occupancy <<
+                                ", high-water mark: " << high_water_mark << std::endl << std::endl;
+                }
+
+            private:
+
+                /**
+                 * @brief writer thread loop, saves committed slots until stop() is called
+                 * and the ring has been drained
+                 *
+                 */
+                void run_writer(void){
+                    size_t read = read_index.load(std::memory_order_relaxed);
+                    while (true)
+                    {
+                        //sleep until a frame is committed (frames committed before stop() was called are always written)
+                        if (write_index.load(std::memory_order_acquire) == read)
+                        {
+                            std::unique_lock<std::mutex> lock(writer_mutex);
+                            writer_sleeping.store(true, std::memory_order_seq_cst);
+                            writer_cv.wait(lock, [this, read]() {
+                                return stop_requested || write_index.load(std::memory_order_seq_cst) != read;
+                            });
+                            writer_sleeping.store(false, std::memory_order_relaxed);
+                            if (write_index.load(std::memory_order_acquire) == read)
+                            {
+                                return;
+                            }
+                        }
+
+                        //process and save the oldest frame and release its slot back to the producer
+                        if (frame_processor)
+                        {
+                            frame_processor(frame_slots[read % num_slots]);
+                        }
+                        if (capture_file != nullptr)
+                        {
+                            capture_file -> write_frame(frame_slots[read % num_slots], slot_metadata[read % num_slots]);
+                        }
+                        else{
+                            frame_slots[read % num_slots].save_to_file();
+                        }
+                        read += 1;
+                        read_index.store(read, std::memory_order_release);
+                    }
+                }
+        };
+    }
+#endif
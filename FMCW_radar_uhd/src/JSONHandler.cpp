@@ -37,3 +37,68 @@ void JSONHandler::print_file(std::string & file_name){
     else std::cerr << "JSONHandler::print_file: Unable to open file\n";
 }
 
+
+
+/**
+ * @brief Get the settings that differ between two configurations
+ * 
+ * @param old_config the current configuration
+ * @param new_config the updated configuration
+ * @return std::vector<std::string> the JSON pointer (ex: "/USRPSettings/RX/gain") of each
+ * setting that was added, removed, or changed
+ */
+std::vector<std::string> JSONHandler::changed_settings(const json & old_config, const json & new_config){
+    std::vector<std::string> changed;
+    json patch = json::diff(old_config, new_config);
+    for (size_t i = 0; i < patch.size(); i++)
+    {
+        changed.push_back(patch[i]["path"].get<std::string>());
+    }
+    return changed;
+}
+
+/**
+ * @brief Check if a setting (or any setting within it) is in a list of changed settings
+ * 
+ * @param changed the changed settings (from changed_settings)
+ * @param setting the JSON pointer of the setting (ex: "/RadarSettings" or "/RadarSettings/num_chirps")
+ * @return true - the setting changed
+ * @return false - the setting didn't change
+ */
+bool JSONHandler::setting_changed(const std::vector<std::string> & changed, const std::string & setting){
+    for (size_t i = 0; i < changed.size(); i++)
+    {
+        //the changed path is the setting, within the setting, or contains the setting
+        if ((changed[i].compare(0, setting.size(), setting) == 0 &&
+                (changed[i].size() == setting.size() || changed[i][setting.size()] == '/')) ||
+            (setting.compare(0, changed[i].size(), changed[i]) == 0 && setting[changed[i].size()] == '/'))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Find a setting in a configuration
+ * 
+ * @param config the configuration
+ * @param setting the JSON pointer of the setting (ex: "/RadarSettings/num_chirps")
+ * @return const json* the setting's value (nullptr if it isn't in the configuration)
+ */
+const json * JSONHandler::find_setting(const json & config, const std::string & setting){
+    const json * value = & config;
+    size_t key_start = 1;
+    while (value != nullptr && key_start <= setting.size())
+    {
+        size_t key_end = setting.find('/', key_start);
+        if (key_end == std::string::npos)
+        {
+            key_end = setting.size();
+        }
+        json::const_iterator it = value -> find(setting.substr(key_start, key_end - key_start));
+        value = (value -> is_object() && it != value -> end()) ? & (* it) : nullptr;
+        key_start = key_end + 1;
+    }
+    return value;
+}
@@ -4,6 +4,7 @@
     #include <cstdlib>
     #include <fstream>
     #include <string>
+    #include <vector>
     #include <nlohmann/json.hpp>
 
     using json = nlohmann::json;
@@ -11,5 +12,8 @@
     namespace JSONHandler {
         json parse_JSON(std::string & file_name, bool print_JSON = false);
         void print_file(std::string & file_name);
+        std::vector<std::string> changed_settings(const json & old_config, const json & new_config);
+        bool setting_changed(const std::vector<std::string> & changed, const std::string & setting);
+        const json * find_setting(const json & config, const std::string & setting);
     }
 #endif
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "LatencyMonitor.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+
+namespace LatencyMonitor_namespace {
+
+    //Latency_Histogram ##################################################
+
+    double Latency_Histogram::get_percentile_us(double percentile) const{
+        if (total_count == 0)
+        {
+            return 0;
+        }
+        if (percentile <= 0)
+        {
+            return static_cast<double>(min_ns) * 1e-3;
+        }
+
+        //the number of values at or below the percentile
+        uint64_t target = static_cast<uint64_t>(std::ceil(std::min(percentile, 100.0) / 100.0 * static_cast<double>(total_count)));
+        target = std::max(target, static_cast<uint64_t>(1));
+
+        uint64_t cumulative_count = 0;
+        for (size_t i = 0; i < num_buckets; i++)
+        {
+            cumulative_count += counts[i];
+            if (cumulative_count >= target)
+            {
+                return static_cast<double>(std::min(bucket_upper_bound(i), max_ns)) * 1e-3;
+            }
+        }
+        return static_cast<double>(max_ns) * 1e-3;
+    }
+
+    json Latency_Histogram::to_json(void) const{
+        json summary;
+        summary["count"] = total_count;
+        if (total_count == 0)
+        {
+            return summary;
+        }
+        summary["min_us"] = static_cast<double>(min_ns) * 1e-3;
+        summary["mean_us"] = sum_ns / static_cast<double>(total_count) * 1e-3;
+        summary["max_us"] = static_cast<double>(max_ns) * 1e-3;
+        summary["p50_us"] = get_percentile_us(50);
+        summary["p90_us"] = get_percentile_us(90);
+        summary["p99_us"] = get_percentile_us(99);
+        summary["p99.9_us"] = get_percentile_us(99.9);
+
+        json buckets = json::array();
+        for (size_t i = 0; i < num_buckets; i++)
+        {
+            if (counts[i] > 0)
+            {
+                buckets.push_back({static_cast<double>(bucket_lower_bound(i)) * 1e-3,
+                                    static_cast<double>(bucket_upper_bound(i)) * 1e-3,
+                                    counts[i]});
+            }
+        }
+        summary["buckets"] = buckets;
+        return summary;
+    }
+
+    //LatencyMonitor #####################################################
+
+    LatencyMonitor::LatencyMonitor(json config): enabled(false){
+        if (config["LatencyMonitorSettings"]["enabled"].is_null() == false)
+        {
+            enabled = config["LatencyMonitorSettings"]["enabled"].get<bool>();
+        }
+        if (config["LatencyMonitorSettings"]["output_file"].is_null() == false)
+        {
+            output_file = config["LatencyMonitorSettings"]["output_file"].get<std::string>();
+        }
+        reset();
+    }
+
+    void LatencyMonitor::reset(void){
+        for (size_t i = 0; i < num_stages; i++)
+        {
+            histograms[i].reset();
+        }
+        num_deadline_checks = 0;
+        num_deadlines_missed = 0;
+        min_slack_ms = 0;
+        last_slack_ms = 0;
+        last_predicted_frame_start_ms = 0;
+        slack_histogram.reset();
+    }
+
+    void LatencyMonitor::check_deadline(double predicted_frame_start_ms, double deadline_s, double device_time_s){
+        if (! enabled)
+        {
+            return;
+        }
+        double slack_ms = (deadline_s - device_time_s) * 1e3;
+
+        if (num_deadline_checks == 0 || slack_ms < min_slack_ms)
+        {
+            min_slack_ms = slack_ms;
+        }
+        num_deadline_checks += 1;
+        last_slack_ms = slack_ms;
+        last_predicted_frame_start_ms = predicted_frame_start_ms;
+
+        if (slack_ms < 0)
+        {
+            num_deadlines_missed += 1;
+            std::cerr << "LatencyMonitor::check_deadline: attack queued " << -slack_ms <<
+                        " ms after the first burst's start time (predicted frame start: " <<
+                        predicted_frame_start_ms << " ms)" << std::endl;
+        }
+        else{
+            slack_histogram.record(static_cast<uint64_t>(slack_ms * 1e6));
+        }
+    }
+
+    const char * LatencyMonitor::stage_name(Stage stage){
+        switch (stage) {
+            case recv_wait:
+                return "recv_wait";
+            case detection:
+                return "detection";
+            case reshape:
+                return "reshape";
+            case fft:
+                return "fft";
+            case peak:
+                return "peak";
+            case cluster:
+                return "cluster";
+            case fit:
+                return "fit";
+            case scheduling:
+                return "scheduling";
+            case chirp_to_transmit:
+                return "chirp_to_transmit";
+            default:
+                return "unknown";
+        }
+    }
+
+    json LatencyMonitor::to_json(void) const{
+        json report;
+        for (size_t i = 0; i < num_stages; i++)
+        {
+            report["stages"][stage_name(static_cast<Stage>(i))] = histograms[i].to_json();
+        }
+
+        json & slack = report["deadline_slack"];
+        slack["num_checks"] = num_deadline_checks;
+        slack["num_missed"] = num_deadlines_missed;
+        if (num_deadline_checks > 0)
+        {
+            slack["min_slack_ms"] = min_slack_ms;
+            slack["last_slack_ms"] = last_slack_ms;
+            slack["last_predicted_frame_start_ms"] = last_predicted_frame_start_ms;
+        }
+        slack["met_deadlines"] = slack_histogram.to_json();
+        return report;
+    }
+
+    void LatencyMonitor::save_report(void) const{
+        if (! enabled)
+        {
+            return;
+        }
+
+        //print the median and tail latency for each stage that was recorded
+        for (size_t i = 0; i < num_stages; i++)
+        {
+            const Latency_Histogram & histogram = histograms[i];
+            if (histogram.get_count() == 0)
+            {
+                continue;
+            }
+            std::cout << "LatencyMonitor::save_report: " << stage_name(static_cast<Stage>(i)) <<
+                        ": count: " << histogram.get_count() <<
+                        ", p50: " << histogram.get_percentile_us(50) <<
+                        " us, p99: " << histogram.get_percentile_us(99) <<
+                        " us, max: " << histogram.get_percentile_us(100) << " us" << std::endl;
+        }
+        if (num_deadline_checks > 0)
+        {
+            std::cout << "LatencyMonitor::save_report: deadline slack: last: " << last_slack_ms <<
+                        " ms, min: " << min_slack_ms << " ms, missed: " << num_deadlines_missed <<
+                        "/" << num_deadline_checks << std::endl;
+        }
+
+        if (output_file.empty())
+        {
+            return;
+        }
+        std::ofstream out(output_file.c_str());
+        if (! out.is_open())
+        {
+            std::cerr << "LatencyMonitor::save_report: couldn't open " << output_file << std::endl;
+            return;
+        }
+        out << to_json().dump(4) << std::endl;
+        std::cout << "LatencyMonitor::save_report: saved latency report to " << output_file << std::endl;
+    }
+}
@@ -0,0 +1,293 @@
+#ifndef LATENCYMONITOR
+#define LATENCYMONITOR
+    //C standard libraries
+    #include <iostream>
+    #include <cstdlib>
+    #include <cstdint>
+    #include <string>
+    #include <vector>
+    #include <chrono>
+
+    //JSON class
+    #include <nlohmann/json.hpp>
+
+    using json = nlohmann::json;
+
+    namespace LatencyMonitor_namespace {
+
+        /**
+         * @brief A fixed bucket, HDR style latency histogram (in ns). Values below 2^sub_bucket_bits ns
+         * get their own bucket, larger values are split into 2^(sub_bucket_bits - 1) linear buckets
+         * per power of 2, so every value is recorded with a relative error below 2^-(sub_bucket_bits - 1)
+         * (~3%) without allocating or searching
+         *
+         */
+        class Latency_Histogram {
+            public:
+                static const size_t sub_bucket_bits = 6;
+                static const size_t sub_bucket_half_count = static_cast<size_t>(1) << (sub_bucket_bits - 1);
+                static const size_t max_value_bits = 40; //values are clamped to ~18 minutes
+                static const uint64_t max_value_ns = (static_cast<uint64_t>(1) << max_value_bits) - 1;
+                static const size_t num_buckets = sub_bucket_half_count * (max_value_bits - sub_bucket_bits + 2);
+
+            private:
+                uint64_t counts[num_buckets];
+                uint64_t total_count;
+                uint64_t min_ns;
+                uint64_t max_ns;
+                double sum_ns;
+
+            public:
+                Latency_Histogram(){
+                    reset();
+                }
+
+                /**
+                 * @brief Clear the recorded values
+                 *
+                 */
+                void reset(void){
+                    for (size_t i = 0; i < num_buckets; i++)
+                    {
+                        counts[i] = 0;
+                    }
+                    total_count = 0;
+                    min_ns = max_value_ns;
+                    max_ns = 0;
+                    sum_ns = 0;
+                }
+
+                /**
+                 * @brief Record a value
+                 *
+                 * @param value_ns the value (in ns)
+                 */
+                inline void record(uint64_t value_ns){
+                    if (value_ns > max_value_ns)
+                    {
+                        value_ns = max_value_ns;
+                    }
+                    counts[bucket_index(value_ns)] += 1;
+                    total_count += 1;
+                    sum_ns += static_cast<double>(value_ns);
+                    if (value_ns < min_ns)
+                    {
+                        min_ns = value_ns;
+                    }
+                    if (value_ns > max_ns)
+                    {
+                        max_ns = value_ns;
+                    }
+                }
+
+                /**
+                 * @brief Get the bucket that a value is counted in
+                 *
+                 * @param value_ns the value (in ns, at most max_value_ns)
+                 * @return size_t the index of the bucket
+                 */
+                static inline size_t bucket_index(uint64_t value_ns){
+                    if (value_ns < (sub_bucket_half_count << 1))
+                    {
+                        return static_cast<size_t>(value_ns);
+                    }
+                    //keep the sub_bucket_bits most significant bits of the value
+                    size_t shift = static_cast<size_t>(63 - __builtin_clzll(value_ns)) - (sub_bucket_bits - 1);
+                    return sub_bucket_half_count * shift + static_cast<size_t>(value_ns >> shift);
+                }
+
+                /**
+                 * @brief Get the smallest value counted in a bucket
+                 *
+                 * @param idx the index of the bucket
+                 * @return uint64_t the smallest value (in ns)
+                 */
+                static uint64_t bucket_lower_bound(size_t idx){
+                    if (idx < (sub_bucket_half_count << 1))
+                    {
+                        return static_cast<uint64_t>(idx);
+                    }
+                    size_t shift = idx / sub_bucket_half_count - 1;
+                    uint64_t sub_bucket = static_cast<uint64_t>(idx % sub_bucket_half_count + sub_bucket_half_count);
+                    return sub_bucket << shift;
+                }
+
+                /**
+                 * @brief Get the largest value counted in a bucket
+                 *
+                 * @param idx the index of the bucket
+                 * @return uint64_t the largest value (in ns)
+                 */
+                static uint64_t bucket_upper_bound(size_t idx){
+                    return bucket_lower_bound(idx + 1) - 1;
+                }
+
+                uint64_t get_count(void) const {return total_count;}
+
+                /**
+                 * @brief Get a percentile of the recorded values (the largest value in the
+                 * bucket that the percentile falls in, limited to the largest recorded value)
+                 *
+                 * @param percentile the percentile (0 to 100)
+                 * @return double the value at the percentile (in us)
+                 */
+                double get_percentile_us(double percentile) const;
+
+                /**
+                 * @brief Summarize the histogram (count, min, mean, max, and percentiles in us)
+                 * along with its non-empty buckets as [lower bound (us), upper bound (us), count]
+                 *
+                 * @return json the summary
+                 */
+                json to_json(void) const;
+        };
+
+        /**
+         * @brief Per-stage latency histograms for the path from a victim chirp being detected
+         * to the attack's first timed burst being queued, along with a slack monitor that
+         * compares the deadline of the first burst to the device time when it is queued.
+         * Each stage must only be recorded by one thread at a time (the receive thread records
+         * recv_wait and detection, the thread processing the frame records the rest)
+         *
+         */
+        class LatencyMonitor {
+            public:
+                //the instrumented stages
+                enum Stage {
+                    recv_wait = 0,      //rx_stream recv calls while recording a frame
+                    detection,          //energy detector check for a chirp
+                    reshape,            //reshaping and windowing the frame (materialized spectrogram only)
+                    fft,                //spectrogram ffts (fused with the windowing and peak search by default)
+                    peak,               //spectrogram peak detection/selection
+                    cluster,            //clustering the peaks (and the running sum line fits when fused)
+                    fit,                //linear model check and victim parameter/frame tracker update
+                    scheduling,         //frame start prediction through queueing the attack's bursts
+                    chirp_to_transmit,  //chirp detected to the attack's bursts being queued
+                    num_stages
+                };
+
+                typedef std::chrono::steady_clock::time_point time_point;
+
+                bool enabled;
+
+            private:
+                std::string output_file;
+                Latency_Histogram histograms[num_stages];
+
+                //slack monitor (deadline of the first burst - device time when it was queued)
+                size_t num_deadline_checks;
+                size_t num_deadlines_missed;
+                double min_slack_ms;
+                double last_slack_ms;
+                double last_predicted_frame_start_ms;
+                Latency_Histogram slack_histogram; //only the deadlines that were met
+
+            public:
+
+                /**
+                 * @brief Construct a new LatencyMonitor object
+                 *
+                 * @param config JSON configuration object (LatencyMonitorSettings: enabled, output_file)
+                 */
+                LatencyMonitor(json config);
+
+                /**
+                 * @brief Clear the histograms and the slack monitor (called at the start of each run)
+                 *
+                 */
+                void reset(void);
+
+                /**
+                 * @brief Record the duration of a stage
+                 *
+                 * @param stage the stage
+                 * @param start the time that the stage started
+                 * @param end the time that the stage ended
+                 */
+                inline void record(Stage stage, time_point start, time_point end){
+                    if (! enabled)
+                    {
+                        return;
+                    }
+                    std::chrono::nanoseconds duration = end - start;
+                    histograms[stage].record(duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0);
+                }
+
+                /**
+                 * @brief Compare the deadline of the first attack burst to the device time when the
+                 * bursts were queued
+                 *
+                 * @param predicted_frame_start_ms the predicted start time of the victim's next frame (ms)
+                 * @param deadline_s the start time of the first attack burst (device time in s)
+                 * @param device_time_s the device time when the bursts were queued (s)
+                 */
+                void check_deadline(double predicted_frame_start_ms, double deadline_s, double device_time_s);
+
+                /**
+                 * @brief Get the name of a stage
+                 *
+                 * @param stage the stage
+                 * @return const char* the stage's name
+                 */
+                static const char * stage_name(Stage stage);
+
+                /**
+                 * @brief Summarize every stage and the slack monitor
+                 *
+                 * @return json the summary
+                 */
+                json to_json(void) const;
+
+                /**
+                 * @brief Save the summary to the output file (if set) and print the median and
+                 * tail latency of each stage
+                 *
+                 */
+                void save_report(void) const;
+        };
+
+        /**
+         * @brief Times consecutive stages with one clock read per stage. Does nothing (and doesn't
+         * read the clock) when the monitor is null or disabled
+         *
+         * ex: Stage_Clock clock(latency_monitor); compute_ffts(); clock.lap(LatencyMonitor::fft);
+         */
+        class Stage_Clock {
+            private:
+                LatencyMonitor * monitor;
+                LatencyMonitor::time_point last;
+
+            public:
+                Stage_Clock(LatencyMonitor * latency_monitor)
+                    : monitor((latency_monitor != nullptr && latency_monitor -> enabled) ? latency_monitor : nullptr){
+                    restart();
+                }
+
+                /**
+                 * @brief Start timing the next stage now
+                 *
+                 */
+                inline void restart(void){
+                    if (monitor != nullptr)
+                    {
+                        last = std::chrono::steady_clock::now();
+                    }
+                }
+
+                /**
+                 * @brief Record the time since the previous lap (or restart) for a stage and
+                 * start timing the next stage
+                 *
+                 * @param stage the stage that just finished
+                 */
+                inline void lap(LatencyMonitor::Stage stage){
+                    if (monitor != nullptr)
+                    {
+                        LatencyMonitor::time_point now = std::chrono::steady_clock::now();
+                        monitor -> record(stage, last, now);
+                        last = now;
+                    }
+                }
+        };
+    }
+#endif
@@ -0,0 +1,355 @@
+#include "Logger.hpp"
+
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <new>
+
+//the maximum number of log statements
+#define LOGGER_MAX_EVENTS 4096
+
+//how often the background thread prints the records
+#define LOGGER_DRAIN_PERIOD_MS 1
+
+namespace {
+
+    //a registered log statement
+    struct Log_Event {
+        Logger::Level level;
+        const char * format;
+    };
+
+    //registered log statements (entries are only written before num_events is incremented)
+    Log_Event events[LOGGER_MAX_EVENTS];
+    std::atomic<size_t> num_events(0);
+    std::mutex events_mutex;
+
+    //rings for every thread that has logged (removed once their thread has exited and they are empty)
+    std::vector<Logger::Log_Ring *> rings;
+    std::mutex rings_mutex;
+
+    //held while the rings are drained (by the background thread or flush())
+    std::mutex drain_mutex;
+    std::vector<Logger::Log_Record> drained_records;
+
+    /**
+     * @brief Marks the ring of a thread as exited when the thread exits
+     *
+     */
+    struct Ring_Owner {
+        Logger::Log_Ring * ring;
+        Ring_Owner(): ring(nullptr) {}
+        ~Ring_Owner(){
+            if (ring != nullptr)
+            {
+                ring -> owner_exited.store(true, std::memory_order_release);
+            }
+        }
+    };
+    thread_local Ring_Owner ring_owner;
+
+    Logger::Log_Ring * allocate_ring(void){
+        void * memory = nullptr;
+        if (posix_memalign(&memory, alignof(Logger::Log_Ring), sizeof(Logger::Log_Ring)) != 0)
+        {
+            throw std::bad_alloc();
+        }
+        return new (memory) Logger::Log_Ring();
+    }
+
+    void free_ring(Logger::Log_Ring * ring){
+        ring -> ~Log_Ring();
+        free(ring);
+    }
+
+    /**
+     * @brief Converts raw timestamps to seconds since the logger was started (the time stamp
+     * counter rate is measured against the steady clock and refined on every drain)
+     *
+     */
+    class Timestamp_Converter {
+        private:
+            uint64_t start_timestamp;
+            std::chrono::steady_clock::time_point start_time;
+            double timestamps_per_s;
+
+        public:
+            Timestamp_Converter(): timestamps_per_s(1e9) {}
+
+            void start(void){
+                start_timestamp = Logger::read_timestamp();
+                start_time = std::chrono::steady_clock::now();
+            }
+
+            void calibrate(void){
+                #if defined(__x86_64__) || defined(__i386__)
+                    uint64_t timestamp = Logger::read_timestamp();
+                    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+                    if (elapsed_s > 0)
+                    {
+                        timestamps_per_s = static_cast<double>(timestamp - start_timestamp) / elapsed_s;
+                    }
+                #endif
+            }
+
+            double to_seconds(uint64_t timestamp) const{
+                return (static_cast<double>(timestamp) - static_cast<double>(start_timestamp)) / timestamps_per_s;
+            }
+    };
+    Timestamp_Converter timestamp_converter;
+
+    /**
+     * @brief Format a record (replace each {} in its statement's format with the next argument)
+     *
+     * @param record the record
+     * @param format the format of the record's statement
+     * @param out the stream to format the record into
+     */
+    void format_record(const Logger::Log_Record & record, const char * format, std::ostringstream & out){
+        size_t arg = 0;
+        for (const char * c = format; *c != '\0'; c++)
+        {
+            if (c[0] == '{' && c[1] == '}' && arg < record.num_args)
+            {
+                switch ((record.arg_types >> (2 * arg)) & 0x3) {
+                    case Logger::integer_arg:
+                        out << record.args[arg].integer;
+                        break;
+                    case Logger::unsigned_arg:
+                        out << record.args[arg].unsigned_integer;
+                        break;
+                    case Logger::floating_arg:
+                        out << record.args[arg].floating;
+                        break;
+                    default:
+                        out << record.args[arg].string;
+                        break;
+                }
+                arg++;
+                c++;
+            }
+            else{
+                out << *c;
+            }
+        }
+    }
+
+    /**
+     * @brief Print every record in the rings in time order (drain_mutex must be held)
+     *
+     */
+    void drain_rings(void){
+        std::vector<Logger::Log_Record> & records = drained_records;
+        records.clear();
+
+        std::vector<Logger::Log_Ring *> current_rings;
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex);
+            current_rings = rings;
+        }
+
+        //copy the records out of each ring and release the slots to the owning threads
+        size_t num_dropped = 0;
+        std::vector<Logger::Log_Ring *> exited_rings;
+        for (size_t i = 0; i < current_rings.size(); i++)
+        {
+            Logger::Log_Ring * ring = current_rings[i];
+            bool exited = ring -> owner_exited.load(std::memory_order_acquire);
+            size_t read = ring -> read_index.load(std::memory_order_relaxed);
+            size_t write = ring -> write_index.load(std::memory_order_acquire);
+            for (; read != write; read++)
+            {
+                records.push_back(ring -> records[read & (Logger::Log_Ring::num_records - 1)]);
+            }
+            ring -> read_index.store(read, std::memory_order_release);
+            num_dropped += ring -> num_dropped.exchange(0, std::memory_order_relaxed);
+
+            if (exited)
+            {
+                exited_rings.push_back(ring);
+            }
+        }
+
+        //free the rings of threads that have exited
+        if (! exited_rings.empty())
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex);
+            for (size_t i = 0; i < exited_rings.size(); i++)
+            {
+                rings.erase(std::find(rings.begin(), rings.end(), exited_rings[i]));
+                free_ring(exited_rings[i]);
+            }
+        }
+
+        if (records.empty() && num_dropped == 0)
+        {
+            return;
+        }
+
+        //print the records in time order
+        std::stable_sort(records.begin(), records.end(),
+            [](const Logger::Log_Record & a, const Logger::Log_Record & b) {
+                return a.timestamp < b.timestamp;
+            });
+        timestamp_converter.calibrate();
+
+        int level = Logger::runtime_level.load(std::memory_order_relaxed);
+        std::ostringstream out;
+        for (size_t i = 0; i < records.size(); i++)
+        {
+            const Log_Event & event = events[records[i].event_id];
+            if (static_cast<int>(event.level) < level)
+            {
+                continue;
+            }
+
+            out.str("");
+            out << "[" << timestamp_converter.to_seconds(records[i].timestamp) << " s] ";
+            format_record(records[i], event.format, out);
+            if (event.level >= Logger::Level::warning)
+            {
+                std::cerr << out.str() << std::endl;
+            }
+            else{
+                std::cout << out.str() << std::endl;
+            }
+        }
+
+        if (num_dropped > 0)
+        {
+            std::cerr << "Logger::drain_rings: dropped " << num_dropped << " log records (ring full)" << std::endl;
+        }
+    }
+
+    /**
+     * @brief The background thread that prints the records (started by the first registered
+     * statement, and stopped after a final drain when the program exits)
+     *
+     */
+    class Drain_Thread {
+        private:
+            std::thread thread;
+            std::atomic<bool> stop_requested;
+            bool running;
+
+        public:
+            Drain_Thread(): stop_requested(false), running(false) {}
+
+            ~Drain_Thread(){
+                if (running)
+                {
+                    stop_requested = true;
+                    thread.join();
+                }
+            }
+
+            //called with events_mutex held
+            void start(void){
+                if (running)
+                {
+                    return;
+                }
+                timestamp_converter.start();
+                thread = std::thread([this]() {
+                    run();
+                });
+                running = true;
+            }
+
+        private:
+            void run(void){
+                //measure the time stamp counter rate before printing any records
+                #if defined(__x86_64__) || defined(__i386__)
+                {
+                    std::lock_guard<std::mutex> lock(drain_mutex);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    timestamp_converter.calibrate();
+                }
+                #endif
+
+                while (true)
+                {
+                    bool stopping = stop_requested.load();
+                    {
+                        std::lock_guard<std::mutex> lock(drain_mutex);
+                        drain_rings();
+                    }
+                    if (stopping)
+                    {
+                        return;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(LOGGER_DRAIN_PERIOD_MS));
+                }
+            }
+    };
+    Drain_Thread drain_thread;
+}
+
+namespace Logger {
+
+    std::atomic<int> runtime_level(static_cast<int>(Level::info));
+
+    void set_level(Level level){
+        runtime_level.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    bool set_level(const std::string & level_name){
+        if (level_name == "debug")
+        {
+            set_level(Level::debug);
+        }
+        else if (level_name == "info")
+        {
+            set_level(Level::info);
+        }
+        else if (level_name == "warning")
+        {
+            set_level(Level::warning);
+        }
+        else if (level_name == "error")
+        {
+            set_level(Level::error);
+        }
+        else{
+            std::cerr << "Logger::set_level: unknown level: " << level_name << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    uint16_t register_event(Level level, const char * format){
+        std::lock_guard<std::mutex> lock(events_mutex);
+        drain_thread.start();
+
+        size_t event_id = num_events.load(std::memory_order_relaxed);
+        if (event_id >= LOGGER_MAX_EVENTS)
+        {
+            std::cerr << "Logger::register_event: too many log statements, increase LOGGER_MAX_EVENTS" << std::endl;
+            std::abort();
+        }
+        events[event_id].level = level;
+        events[event_id].format = format;
+        num_events.store(event_id + 1, std::memory_order_release);
+        return static_cast<uint16_t>(event_id);
+    }
+
+    Log_Ring * create_thread_ring(void){
+        Log_Ring * ring = allocate_ring();
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex);
+            rings.push_back(ring);
+        }
+        ring_owner.ring = ring;
+        thread_ring() = ring;
+        return ring;
+    }
+
+    void flush(void){
+        std::lock_guard<std::mutex> lock(drain_mutex);
+        drain_rings();
+    }
+}
@@ -0,0 +1,242 @@
+#ifndef LOGGER
+#define LOGGER
+    #include <iostream>
+    #include <cstdlib>
+    #include <cstdint>
+    #include <string>
+    #include <atomic>
+    #include <type_traits>
+
+    #if defined(__x86_64__) || defined(__i386__)
+        #include <x86intrin.h>
+    #else
+        #include <chrono>
+    #endif
+
+    //log statements below this level are removed at compile time (0: debug, 1: info, 2: warning, 3: error)
+    #ifndef LOGGER_MIN_LEVEL
+        #define LOGGER_MIN_LEVEL 0
+    #endif
+
+    /**
+     * @brief Log statements for the streaming threads. Each statement only copies a timestamp, the
+     * statement's event id, and its arguments (numbers or string literals) into a lock-free ring owned
+     * by the calling thread, a background thread formats the records (replacing each {} in the
+     * format with the next argument) and prints them in time order. Statements below
+     * LOGGER_MIN_LEVEL are compiled out, and statements below the runtime level (Logger::set_level)
+     * are skipped after a single load. Warnings and errors are printed to std::cerr, the rest to std::cout
+     *
+     * ex: LOG_INFO("USRPHandler::submit_tx_frames: streaming frame starting at : {} s", start_time);
+     */
+    #define LOGGER_LOG(level, format, ...)                                                          \
+        do {                                                                                        \
+            if (static_cast<int>(level) >= LOGGER_MIN_LEVEL && Logger::level_enabled(level))       \
+            {                                                                                       \
+                static const uint16_t logger_event_id = Logger::register_event(level, format);      \
+                Logger::log(logger_event_id, ##__VA_ARGS__);                                        \
+            }                                                                                       \
+        } while (0)
+
+    #define LOG_DEBUG(format, ...) LOGGER_LOG(Logger::Level::debug, format, ##__VA_ARGS__)
+    #define LOG_INFO(format, ...) LOGGER_LOG(Logger::Level::info, format, ##__VA_ARGS__)
+    #define LOG_WARNING(format, ...) LOGGER_LOG(Logger::Level::warning, format, ##__VA_ARGS__)
+    #define LOG_ERROR(format, ...) LOGGER_LOG(Logger::Level::error, format, ##__VA_ARGS__)
+
+    namespace Logger {
+
+        /**
+         * @brief Severity of a log statement
+         *
+         */
+        enum class Level {debug = 0, info = 1, warning = 2, error = 3};
+
+        //the maximum number of arguments in a log statement
+        const size_t max_args = 6;
+
+        //the type of each argument in a record
+        enum Arg_Type {integer_arg = 0, unsigned_arg = 1, floating_arg = 2, string_arg = 3};
+
+        /**
+         * @brief A binary log record (one cache line)
+         *
+         */
+        struct alignas(64) Log_Record {
+            uint64_t timestamp; //raw timestamp (see read_timestamp)
+            uint16_t event_id;
+            uint8_t num_args;
+            uint8_t unused;
+            uint16_t arg_types; //2 bits (an Arg_Type) per argument
+            uint16_t unused_2;
+            union {
+                int64_t integer;
+                uint64_t unsigned_integer;
+                double floating;
+                const char * string; //must be a string literal (or otherwise outlive the record)
+            } args[max_args];
+        };
+
+        /**
+         * @brief A single producer/single consumer ring of log records owned by one thread
+         *
+         */
+        struct Log_Ring {
+            static const size_t num_records = 4096; //must be a power of 2
+
+            Log_Record records[num_records];
+            alignas(64) std::atomic<size_t> write_index; //only modified by the owning thread
+            size_t cached_read_index; //the owning thread's copy of read_index (only reloaded when the ring looks full)
+            std::atomic<size_t> num_dropped; //records dropped because the ring was full
+            alignas(64) std::atomic<size_t> read_index; //only modified by the drain thread
+            std::atomic<bool> owner_exited; //the owning thread has exited (the ring can be freed once drained)
+
+            Log_Ring(): write_index(0), cached_read_index(0), num_dropped(0), read_index(0), owner_exited(false) {}
+        };
+
+        //runtime level (statements below it are skipped)
+        extern std::atomic<int> runtime_level;
+
+        /**
+         * @brief Check if statements at a given level are currently logged
+         *
+         */
+        inline bool level_enabled(Level level){
+            return static_cast<int>(level) >= runtime_level.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Set the runtime level
+         *
+         * @param level statements below this level are skipped
+         */
+        void set_level(Level level);
+
+        /**
+         * @brief Set the runtime level from its name
+         *
+         * @param level_name "debug", "info", "warning", or "error"
+         * @return true - the level was set
+         * @return false - the name wasn't recognized (the level is unchanged)
+         */
+        bool set_level(const std::string & level_name);
+
+        /**
+         * @brief Register a log statement (called once per statement by LOGGER_LOG) and start
+         * the background thread if needed
+         *
+         * @param level the statement's level
+         * @param format the statement's format (must be a string literal)
+         * @return uint16_t the statement's event id
+         */
+        uint16_t register_event(Level level, const char * format);
+
+        /**
+         * @brief Get the calling thread's ring (nullptr until its first log statement), defined here
+         * so that the hot path reads the thread local pointer directly
+         *
+         */
+        inline Log_Ring *& thread_ring(void){
+            static thread_local Log_Ring * ring = nullptr;
+            return ring;
+        }
+
+        /**
+         * @brief Create the calling thread's ring (on its first log statement)
+         *
+         */
+        Log_Ring * create_thread_ring(void);
+
+        /**
+         * @brief Wait for every record logged so far to be printed (ex: before printing a summary
+         * with std::cout so that it follows the streaming messages)
+         *
+         */
+        void flush(void);
+
+        /**
+         * @brief Read the raw timestamp stored in a record (the time stamp counter on x86, otherwise
+         * the steady clock in ns), the background thread converts it to seconds
+         *
+         */
+        inline uint64_t read_timestamp(void){
+            #if defined(__x86_64__) || defined(__i386__)
+                return __rdtsc();
+            #else
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count());
+            #endif
+        }
+
+        //argument encoding ##################################################
+
+        template<typename arg_type>
+        inline typename std::enable_if<std::is_integral<arg_type>::value && std::is_signed<arg_type>::value>::type
+        encode_arg(Log_Record & record, size_t idx, arg_type value){
+            record.args[idx].integer = static_cast<int64_t>(value);
+            record.arg_types |= static_cast<uint16_t>(integer_arg << (2 * idx));
+        }
+
+        template<typename arg_type>
+        inline typename std::enable_if<std::is_integral<arg_type>::value && std::is_unsigned<arg_type>::value>::type
+        encode_arg(Log_Record & record, size_t idx, arg_type value){
+            record.args[idx].unsigned_integer = static_cast<uint64_t>(value);
+            record.arg_types |= static_cast<uint16_t>(unsigned_arg << (2 * idx));
+        }
+
+        template<typename arg_type>
+        inline typename std::enable_if<std::is_floating_point<arg_type>::value>::type
+        encode_arg(Log_Record & record, size_t idx, arg_type value){
+            record.args[idx].floating = static_cast<double>(value);
+            record.arg_types |= static_cast<uint16_t>(floating_arg << (2 * idx));
+        }
+
+        inline void encode_arg(Log_Record & record, size_t idx, const char * value){
+            record.args[idx].string = value;
+            record.arg_types |= static_cast<uint16_t>(string_arg << (2 * idx));
+        }
+
+        inline void encode_args(Log_Record &, size_t){}
+
+        template<typename first_type, typename... rest_types>
+        inline void encode_args(Log_Record & record, size_t idx, first_type first, rest_types... rest){
+            encode_arg(record, idx, first);
+            encode_args(record, idx + 1, rest...);
+        }
+
+        /**
+         * @brief Copy a log statement into the calling thread's ring (use the LOG_ macros). If the
+         * ring is full the record is dropped (and counted) rather than waiting
+         *
+         * @param event_id the statement's event id
+         * @param args the statement's arguments
+         */
+        template<typename... argument_types>
+        inline void log(uint16_t event_id, argument_types... args){
+            static_assert(sizeof...(args) <= max_args, "Logger::log: too many arguments in a log statement");
+
+            Log_Ring * ring = thread_ring();
+            if (ring == nullptr)
+            {
+                ring = create_thread_ring();
+            }
+
+            size_t write = ring -> write_index.load(std::memory_order_relaxed);
+            if (write - ring -> cached_read_index >= Log_Ring::num_records)
+            {
+                ring -> cached_read_index = ring -> read_index.load(std::memory_order_acquire);
+                if (write - ring -> cached_read_index >= Log_Ring::num_records)
+                {
+                    ring -> num_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+
+            Log_Record & record = ring -> records[write & (Log_Ring::num_records - 1)];
+            record.timestamp = read_timestamp();
+            record.event_id = event_id;
+            record.num_args = static_cast<uint8_t>(sizeof...(args));
+            record.arg_types = 0;
+            encode_args(record, 0, args...);
+            ring -> write_index.store(write + 1, std::memory_order_release);
+        }
+    }
+#endif
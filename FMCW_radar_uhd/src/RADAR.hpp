@@ -15,11 +15,18 @@
     #include "JSONHandler.hpp"
     #include "USRPHandler.hpp"
     #include "BufferHandler.hpp"
+    #include "TxSource.hpp"
+    #include "radar_processing/RangeDopplerProcessor.hpp"
+    #include "radar_processing/CFARDetector.hpp"
 
     using json = nlohmann::json;
     using USRPHandler_namespace::USRPHandler;
     using Buffers::RADAR_Buffer;
     using Buffers::Buffer_1D;
+    using Buffers::Buffer_2D;
+    using RangeDopplerProcessor_namespace::RangeDopplerProcessor;
+    using TxSource_namespace::PeriodicTxSource;
+    using CFARDetector_namespace::CFARDetector;
 
     namespace RADAR_namespace{
 
@@ -34,10 +41,16 @@
             private:
                 json config;
                 USRPHandler<data_type> usrp_handler;
-                RADAR_Buffer<data_type> tx_buffer;
+                std::shared_ptr<PeriodicTxSource<data_type>> tx_source;
                 RADAR_Buffer<data_type> rx_buffer;
                 size_t samples_per_chirp;
 
+                //real time range-doppler processing of the received frames
+                RangeDopplerProcessor<data_type> range_doppler_processor;
+
+                //target detection on the range-doppler maps
+                CFARDetector<data_type> cfar_detector;
+
                 //Variables to keep track of frame start times
                 
                 //timing arguments
@@ -50,6 +63,7 @@
 
                 //status flags
                 bool radar_initialized;
+                bool rx_buffer_stale; //the rx buffer (and its file) must be re-initialized before the next run
 
             //functions
             public:
@@ -67,7 +81,10 @@
                 RADAR(json config_data, bool initialize = true, bool run = false):
                     config(config_data),
                     usrp_handler(config_data),
-                    radar_initialized(initialize){
+                    range_doppler_processor(config_data),
+                    cfar_detector(config_data),
+                    radar_initialized(initialize),
+                    rx_buffer_stale(false){
                     
                     //initialize the radar (if specified)
                     if (radar_initialized)
@@ -117,13 +134,15 @@
 
                     samples_per_chirp = tx_chirp_buffer.num_samples;
 
-                    return tx_chirp_buffer.buffer;
+                    //the buffer is local, so hand its samples to the caller instead of copying them
+                    return std::move(tx_chirp_buffer.buffer);
                 }
 
                 /**
-                 * @brief initialize the Tx Buffer for USRP operations.
+                 * @brief initialize the tx source for USRP operations. The tx chirp is stored once
+                 * and repeated for each chirp in the frame, rather than tiled into a buffer
                  * 
-                 * @param desired_num_chirps desired number of chirps to load into the tx buffer
+                 * @param desired_num_chirps desired number of chirps in each frame
                  * @param desired_samples_per_buffer desired samples per buffer (defaults to max 
                  * samples per buffer for USRP tx device)
                  */
@@ -147,21 +166,21 @@
                     }
                     
                     
-                    //configure the tx_buffer to be the correct size
-                    tx_buffer.configure_fmcw_buffer(
+                    //send the chirp repeatedly for each frame
+                    tx_source = std::make_shared<PeriodicTxSource<data_type>>(
+                        tx_chirp,
                         samples_per_buffer,
-                        samples_per_chirp,
                         desired_num_chirps
                     );
 
-                    std::cout << "Radar::init_tx_buffer: Num Rows: " << tx_buffer.num_rows << " Excess Samples: " << tx_buffer.excess_samples << std::endl;
-                    
-                    //load tx chirp into the tx buffer
-                    tx_buffer.load_chirp_into_buffer(tx_chirp);
+                    std::cout << "Radar::init_tx_buffer: Sends per frame: " << tx_source -> get_num_sends() <<
+                        " Stored samples: " << tx_source -> get_stored_samples() << std::endl;
                 }
                 
                 /**
-                 * @brief initializes the rx buffer for USRP operation
+                 * @brief initializes the rx buffer for USRP operation. Frames are saved to rx_file_name
+                 * as raw samples (rx_file_format "raw", the default) or as a capture file with a header,
+                 * per-frame records, and an index (rx_file_format "capture")
                  * 
                  * @param desired_num_chirps desired number of chirps
                  * @param desired_samples_per_buffer desired number of samples per buffer (defaults 
@@ -177,8 +196,22 @@
                     }
                     std::string rx_file = config["RadarSettings"]["rx_file_name"].get<std::string>();
 
-                    //create a buffer to load the chirp data into it
-                    rx_buffer.set_write_file(rx_file,true);
+                    //determine the rx file format
+                    bool save_capture_file = false;
+                    if (config["RadarSettings"]["rx_file_format"].is_null() == false){
+                        std::string rx_file_format = config["RadarSettings"]["rx_file_format"].get<std::string>();
+                        if (rx_file_format == "capture"){
+                            save_capture_file = true;
+                        }
+                        else if (rx_file_format != "raw"){
+                            std::cerr << "Radar::init_rx_buffer: unknown rx_file_format " << rx_file_format << ", using raw" << std::endl;
+                        }
+                    }
+
+                    //create a buffer to load the chirp data into it (the capture file is opened once the frame geometry is known)
+                    if (! save_capture_file){
+                        rx_buffer.set_write_file(rx_file,true);
+                    }
 
                     //specify samples per buffer behavior
                     size_t samples_per_buffer;
@@ -201,6 +234,14 @@
                     std::cout << "Radar::init_rx_buffer: Num Rows: " << rx_buffer.num_rows 
                         << " Excess Samples: " << rx_buffer.excess_samples << std::endl;
 
+                    if (save_capture_file){
+                        double frame_periodicity_s = 0.0;
+                        if (config["RadarSettings"]["frame_periodicity_ms"].is_null() == false){
+                            frame_periodicity_s = config["RadarSettings"]["frame_periodicity_ms"].get<double>() * 1e-3;
+                        }
+                        usrp_handler.open_rx_capture_file(rx_file,& rx_buffer,samples_per_chirp,desired_num_chirps,frame_periodicity_s);
+                    }
+
                 }
                 
                 /**
@@ -219,8 +260,36 @@
                     init_tx_buffer(num_chirps);
                     init_rx_buffer(num_chirps);
                     //std::vector<std::complex<data_type>> tx_chirp = get_tx_chirp();
-                }          
-                
+
+                    init_range_doppler_processor(num_chirps);
+                }
+
+                /**
+                 * @brief initialize the range-doppler processor (if enabled) and have it
+                 * process each received frame. If the CFAR detector is enabled, it is run on
+                 * the range-doppler map of each frame
+                 * 
+                 * @param num_chirps the number of chirps in each frame
+                 */
+                void init_range_doppler_processor(size_t num_chirps){
+                    if (! range_doppler_processor.enabled)
+                    {
+                        return;
+                    }
+
+                    std::vector<std::complex<data_type>> tx_chirp = get_tx_chirp();
+                    range_doppler_processor.initialize(num_chirps,samples_per_chirp,tx_chirp);
+
+                    usrp_handler.set_rx_frame_processor(
+                        [this](Buffer_2D<std::complex<data_type>> & frame) {
+                            range_doppler_processor.process_frame(frame);
+                            if (cfar_detector.enabled)
+                            {
+                                cfar_detector.detect(range_doppler_processor.range_doppler_map);
+                            }
+                        });
+                }
+
 
                 /**
                  * @brief Computes the frame start times in advance, and applies an offset if one is necessary
@@ -264,6 +333,49 @@
                 }
 
                 
+                /**
+                 * @brief Apply an updated configuration between runs, only re-initializing what
+                 * depends on the settings that changed (the USRP is retuned in place, the tx chirp is
+                 * only reloaded if its file or the number of chirps changed, and the frame start times
+                 * are only recomputed if the frame timing changed)
+                 * 
+                 * @param new_config the updated json config object
+                 */
+                void update_config(const json & new_config){
+                    std::vector<std::string> changed = JSONHandler::changed_settings(config, new_config);
+                    config = new_config;
+                    usrp_handler.update_config(new_config);
+                    if ((! radar_initialized) || changed.empty())
+                    {
+                        return;
+                    }
+
+                    //the tx chirp and the frame geometry
+                    if (JSONHandler::setting_changed(changed, "/RadarSettings/tx_file_name") ||
+                        JSONHandler::setting_changed(changed, "/RadarSettings/num_chirps"))
+                    {
+                        size_t num_chirps = config["RadarSettings"]["num_chirps"].get<size_t>();
+                        init_tx_buffer(num_chirps);
+                        init_range_doppler_processor(num_chirps);
+                        rx_buffer_stale = true;
+                    }
+
+                    //the rx file
+                    if (JSONHandler::setting_changed(changed, "/RadarSettings/rx_file_name") ||
+                        JSONHandler::setting_changed(changed, "/RadarSettings/rx_file_format"))
+                    {
+                        rx_buffer_stale = true;
+                    }
+
+                    //the frame timing
+                    if (JSONHandler::setting_changed(changed, "/RadarSettings/num_frames") ||
+                        JSONHandler::setting_changed(changed, "/RadarSettings/frame_periodicity_ms") ||
+                        JSONHandler::setting_changed(changed, "/USRPSettings/Multi-USRP/stream_start_time"))
+                    {
+                        init_frame_start_times();
+                    }
+                }
+
                 /**
                  * @brief Configures the buffers for radar operation,
                  * loads the buffers into the USRP device, and runs the radar
@@ -279,10 +391,29 @@
 
                         //compute the frame start times
                         init_frame_start_times();
+                        radar_initialized = true;
+                    }
+                    else if (rx_buffer_stale)
+                    {
+                        //reopen the rx file (and resize the rx buffer if the frame geometry changed)
+                        init_rx_buffer(config["RadarSettings"]["num_chirps"].get<size_t>());
                     }
 
                     //stream the frames
-                    usrp_handler.stream_frames(frame_start_times,& tx_buffer,& rx_buffer); 
+                    usrp_handler.stream_frames(frame_start_times,tx_source,& rx_buffer); 
+
+                    //write the index of the capture file (if one is being used)
+                    usrp_handler.close_rx_capture_file();
+                    rx_buffer_stale = true;
+
+                    if (range_doppler_processor.enabled)
+                    {
+                        range_doppler_processor.print_summary();
+                    }
+                    if (range_doppler_processor.enabled && cfar_detector.enabled)
+                    {
+                        cfar_detector.print_summary();
+                    }
                 }
         };
     }
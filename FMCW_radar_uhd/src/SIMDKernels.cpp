@@ -0,0 +1,516 @@
+#include "SIMDKernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define SIMDKERNELS_X86
+#endif
+
+//number of floats accumulated in single precision before being added to the double precision result
+#define SIMDKERNELS_FLOAT_BLOCK 4096
+
+namespace {
+
+    //scalar kernels ##########################################################
+
+    double signal_energy_fc32_scalar(const float * values, size_t num_values){
+        double sum = 0;
+        for (size_t i = 0; i < num_values; i++)
+        {
+            sum += static_cast<double>(values[i]) * static_cast<double>(values[i]);
+        }
+        return sum;
+    }
+
+    double signal_energy_fc64_scalar(const double * values, size_t num_values){
+        double sum = 0;
+        for (size_t i = 0; i < num_values; i++)
+        {
+            sum += values[i] * values[i];
+        }
+        return sum;
+    }
+
+    double signal_energy_sc16_scalar(const int16_t * values, size_t num_values){
+        uint64_t sum = 0;
+        for (size_t i = 0; i < num_values; i++)
+        {
+            sum += static_cast<uint64_t>(static_cast<int32_t>(values[i]) * static_cast<int32_t>(values[i]));
+        }
+        return static_cast<double>(sum);
+    }
+
+    template<typename value_type>
+    size_t threshold_exceedances_scalar(const value_type * values, const value_type * thresholds,
+                                        size_t num_values, uint32_t * indicies, size_t first_index = 0){
+        size_t num_exceedances = 0;
+        for (size_t i = first_index; i < num_values; i++)
+        {
+            indicies[num_exceedances] = static_cast<uint32_t>(i);
+            num_exceedances += (values[i] > thresholds[i]) ? 1 : 0;
+        }
+        return num_exceedances;
+    }
+
+    //writes the index of each set bit in a comparison mask
+    inline size_t write_mask_indicies(uint32_t mask, uint32_t base_index, uint32_t * indicies){
+        size_t num_written = 0;
+        while (mask != 0)
+        {
+            indicies[num_written] = base_index + static_cast<uint32_t>(__builtin_ctz(mask));
+            num_written += 1;
+            mask &= mask - 1;
+        }
+        return num_written;
+    }
+
+#ifdef SIMDKERNELS_X86
+
+    //SSE2 kernels ############################################################
+
+    __attribute__((target("sse2")))
+    double signal_energy_fc32_sse2(const float * values, size_t num_values){
+        double sum = 0;
+        size_t i = 0;
+        while ((num_values - i) >= 8)
+        {
+            //accumulate a block in single precision
+            size_t block_end = i + SIMDKERNELS_FLOAT_BLOCK;
+            if (block_end > num_values)
+            {
+                block_end = num_values;
+            }
+            __m128 acc_0 = _mm_setzero_ps();
+            __m128 acc_1 = _mm_setzero_ps();
+            for (; (i + 8) <= block_end; i += 8)
+            {
+                __m128 v_0 = _mm_loadu_ps(values + i);
+                __m128 v_1 = _mm_loadu_ps(values + i + 4);
+                acc_0 = _mm_add_ps(acc_0, _mm_mul_ps(v_0, v_0));
+                acc_1 = _mm_add_ps(acc_1, _mm_mul_ps(v_1, v_1));
+            }
+            float lanes[4];
+            _mm_storeu_ps(lanes, _mm_add_ps(acc_0, acc_1));
+            sum += static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+        }
+        return sum + signal_energy_fc32_scalar(values + i, num_values - i);
+    }
+
+    __attribute__((target("sse2")))
+    double signal_energy_fc64_sse2(const double * values, size_t num_values){
+        __m128d acc_0 = _mm_setzero_pd();
+        __m128d acc_1 = _mm_setzero_pd();
+        size_t i = 0;
+        for (; (i + 4) <= num_values; i += 4)
+        {
+            __m128d v_0 = _mm_loadu_pd(values + i);
+            __m128d v_1 = _mm_loadu_pd(values + i + 2);
+            acc_0 = _mm_add_pd(acc_0, _mm_mul_pd(v_0, v_0));
+            acc_1 = _mm_add_pd(acc_1, _mm_mul_pd(v_1, v_1));
+        }
+        double lanes[2];
+        _mm_storeu_pd(lanes, _mm_add_pd(acc_0, acc_1));
+        return lanes[0] + lanes[1] + signal_energy_fc64_scalar(values + i, num_values - i);
+    }
+
+    __attribute__((target("sse2")))
+    double signal_energy_sc16_sse2(const int16_t * values, size_t num_values){
+        const __m128i zero = _mm_setzero_si128();
+        __m128i acc = _mm_setzero_si128();
+        size_t i = 0;
+        for (; (i + 8) <= num_values; i += 8)
+        {
+            //re*re + im*im for 4 samples (fits in an unsigned 32 bit value)
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+            __m128i power = _mm_madd_epi16(v, v);
+
+            //widen to 64 bits before accumulating
+            acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(power, zero));
+            acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(power, zero));
+        }
+        uint64_t lanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), acc);
+        return static_cast<double>(lanes[0] + lanes[1]) + signal_energy_sc16_scalar(values + i, num_values - i);
+    }
+
+    __attribute__((target("sse2")))
+    size_t threshold_exceedances_fc32_sse2(const float * values, const float * thresholds,
+                                            size_t num_values, uint32_t * indicies){
+        size_t num_exceedances = 0;
+        size_t i = 0;
+        for (; (i + 4) <= num_values; i += 4)
+        {
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(
+                _mm_cmpgt_ps(_mm_loadu_ps(values + i), _mm_loadu_ps(thresholds + i))));
+            num_exceedances += write_mask_indicies(mask, static_cast<uint32_t>(i), indicies + num_exceedances);
+        }
+        return num_exceedances + threshold_exceedances_scalar(values, thresholds, num_values, indicies + num_exceedances, i);
+    }
+
+    __attribute__((target("sse2")))
+    size_t threshold_exceedances_fc64_sse2(const double * values, const double * thresholds,
+                                            size_t num_values, uint32_t * indicies){
+        size_t num_exceedances = 0;
+        size_t i = 0;
+        for (; (i + 2) <= num_values; i += 2)
+        {
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_pd(
+                _mm_cmpgt_pd(_mm_loadu_pd(values + i), _mm_loadu_pd(thresholds + i))));
+            num_exceedances += write_mask_indicies(mask, static_cast<uint32_t>(i), indicies + num_exceedances);
+        }
+        return num_exceedances + threshold_exceedances_scalar(values, thresholds, num_values, indicies + num_exceedances, i);
+    }
+
+    //AVX2 kernels ############################################################
+
+    __attribute__((target("avx2,fma")))
+    double signal_energy_fc32_avx2(const float * values, size_t num_values){
+        double sum = 0;
+        size_t i = 0;
+        while ((num_values - i) >= 16)
+        {
+            //accumulate a block in single precision
+            size_t block_end = i + SIMDKERNELS_FLOAT_BLOCK;
+            if (block_end > num_values)
+            {
+                block_end = num_values;
+            }
+            __m256 acc_0 = _mm256_setzero_ps();
+            __m256 acc_1 = _mm256_setzero_ps();
+            for (; (i + 16) <= block_end; i += 16)
+            {
+                __m256 v_0 = _mm256_loadu_ps(values + i);
+                __m256 v_1 = _mm256_loadu_ps(values + i + 8);
+                acc_0 = _mm256_fmadd_ps(v_0, v_0, acc_0);
+                acc_1 = _mm256_fmadd_ps(v_1, v_1, acc_1);
+            }
+            __m256 acc = _mm256_add_ps(acc_0, acc_1);
+            __m128 acc_128 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+            float lanes[4];
+            _mm_storeu_ps(lanes, acc_128);
+            sum += static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+        }
+        return sum + signal_energy_fc32_scalar(values + i, num_values - i);
+    }
+
+    __attribute__((target("avx2,fma")))
+    double signal_energy_fc64_avx2(const double * values, size_t num_values){
+        __m256d acc_0 = _mm256_setzero_pd();
+        __m256d acc_1 = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; (i + 8) <= num_values; i += 8)
+        {
+            __m256d v_0 = _mm256_loadu_pd(values + i);
+            __m256d v_1 = _mm256_loadu_pd(values + i + 4);
+            acc_0 = _mm256_fmadd_pd(v_0, v_0, acc_0);
+            acc_1 = _mm256_fmadd_pd(v_1, v_1, acc_1);
+        }
+        double lanes[4];
+        _mm256_storeu_pd(lanes, _mm256_add_pd(acc_0, acc_1));
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+            signal_energy_fc64_scalar(values + i, num_values - i);
+    }
+
+    __attribute__((target("avx2")))
+    double signal_energy_sc16_avx2(const int16_t * values, size_t num_values){
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i acc = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; (i + 16) <= num_values; i += 16)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+            __m256i power = _mm256_madd_epi16(v, v);
+            acc = _mm256_add_epi64(acc, _mm256_unpacklo_epi32(power, zero));
+            acc = _mm256_add_epi64(acc, _mm256_unpackhi_epi32(power, zero));
+        }
+        uint64_t lanes[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), acc);
+        return static_cast<double>(lanes[0] + lanes[1] + lanes[2] + lanes[3]) +
+            signal_energy_sc16_scalar(values + i, num_values - i);
+    }
+
+    __attribute__((target("avx2")))
+    size_t threshold_exceedances_fc32_avx2(const float * values, const float * thresholds,
+                                            size_t num_values, uint32_t * indicies){
+        size_t num_exceedances = 0;
+        size_t i = 0;
+        for (; (i + 8) <= num_values; i += 8)
+        {
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(
+                _mm256_cmp_ps(_mm256_loadu_ps(values + i), _mm256_loadu_ps(thresholds + i), _CMP_GT_OQ)));
+            num_exceedances += write_mask_indicies(mask, static_cast<uint32_t>(i), indicies + num_exceedances);
+        }
+        return num_exceedances + threshold_exceedances_scalar(values, thresholds, num_values, indicies + num_exceedances, i);
+    }
+
+    __attribute__((target("avx2")))
+    size_t threshold_exceedances_fc64_avx2(const double * values, const double * thresholds,
+                                            size_t num_values, uint32_t * indicies){
+        size_t num_exceedances = 0;
+        size_t i = 0;
+        for (; (i + 4) <= num_values; i += 4)
+        {
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_pd(
+                _mm256_cmp_pd(_mm256_loadu_pd(values + i), _mm256_loadu_pd(thresholds + i), _CMP_GT_OQ)));
+            num_exceedances += write_mask_indicies(mask, static_cast<uint32_t>(i), indicies + num_exceedances);
+        }
+        return num_exceedances + threshold_exceedances_scalar(values, thresholds, num_values, indicies + num_exceedances, i);
+    }
+
+    //AVX-512 kernels #########################################################
+
+    //gcc's avx512 intrinsic headers use intentionally undefined vectors, which trigger
+    //spurious uninitialized warnings when the intrinsics are inlined
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wuninitialized"
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+    __attribute__((target("avx512f")))
+    double signal_energy_fc32_avx512(const float * values, size_t num_values){
+        double sum = 0;
+        size_t i = 0;
+        while ((num_values - i) >= 32)
+        {
+            //accumulate a block in single precision
+            size_t block_end = i + SIMDKERNELS_FLOAT_BLOCK;
+            if (block_end > num_values)
+            {
+                block_end = num_values;
+            }
+            __m512 acc_0 = _mm512_setzero_ps();
+            __m512 acc_1 = _mm512_setzero_ps();
+            for (; (i + 32) <= block_end; i += 32)
+            {
+                __m512 v_0 = _mm512_loadu_ps(values + i);
+                __m512 v_1 = _mm512_loadu_ps(values + i + 16);
+                acc_0 = _mm512_fmadd_ps(v_0, v_0, acc_0);
+                acc_1 = _mm512_fmadd_ps(v_1, v_1, acc_1);
+            }
+            sum += static_cast<double>(_mm512_reduce_add_ps(_mm512_add_ps(acc_0, acc_1)));
+        }
+        return sum + signal_energy_fc32_scalar(values + i, num_values - i);
+    }
+
+    __attribute__((target("avx512f")))
+    double signal_energy_fc64_avx512(const double * values, size_t num_values){
+        __m512d acc_0 = _mm512_setzero_pd();
+        __m512d acc_1 = _mm512_setzero_pd();
+        size_t i = 0;
+        for (; (i + 16) <= num_values; i += 16)
+        {
+            __m512d v_0 = _mm512_loadu_pd(values + i);
+            __m512d v_1 = _mm512_loadu_pd(values + i + 8);
+            acc_0 = _mm512_fmadd_pd(v_0, v_0, acc_0);
+            acc_1 = _mm512_fmadd_pd(v_1, v_1, acc_1);
+        }
+        return _mm512_reduce_add_pd(_mm512_add_pd(acc_0, acc_1)) +
+            signal_energy_fc64_scalar(values + i, num_values - i);
+    }
+
+    __attribute__((target("avx512f,avx512bw")))
+    double signal_energy_sc16_avx512(const int16_t * values, size_t num_values){
+        const __m512i low_mask = _mm512_set1_epi64(0xFFFFFFFF);
+        __m512i acc = _mm512_setzero_si512();
+        size_t i = 0;
+        for (; (i + 32) <= num_values; i += 32)
+        {
+            __m512i v = _mm512_loadu_si512(values + i);
+            __m512i power = _mm512_madd_epi16(v, v);
+
+            //widen the even and odd 32 bit values to 64 bits before accumulating
+            acc = _mm512_add_epi64(acc, _mm512_and_si512(power, low_mask));
+            acc = _mm512_add_epi64(acc, _mm512_srli_epi64(power, 32));
+        }
+        return static_cast<double>(static_cast<uint64_t>(_mm512_reduce_add_epi64(acc))) +
+            signal_energy_sc16_scalar(values + i, num_values - i);
+    }
+
+    __attribute__((target("avx512f")))
+    size_t threshold_exceedances_fc32_avx512(const float * values, const float * thresholds,
+                                            size_t num_values, uint32_t * indicies){
+        size_t num_exceedances = 0;
+        size_t i = 0;
+        for (; (i + 16) <= num_values; i += 16)
+        {
+            uint32_t mask = static_cast<uint32_t>(_mm512_cmp_ps_mask(
+                _mm512_loadu_ps(values + i), _mm512_loadu_ps(thresholds + i), _CMP_GT_OQ));
+            num_exceedances += write_mask_indicies(mask, static_cast<uint32_t>(i), indicies + num_exceedances);
+        }
+        return num_exceedances + threshold_exceedances_scalar(values, thresholds, num_values, indicies + num_exceedances, i);
+    }
+
+    __attribute__((target("avx512f")))
+    size_t threshold_exceedances_fc64_avx512(const double * values, const double * thresholds,
+                                            size_t num_values, uint32_t * indicies){
+        size_t num_exceedances = 0;
+        size_t i = 0;
+        for (; (i + 8) <= num_values; i += 8)
+        {
+            uint32_t mask = static_cast<uint32_t>(_mm512_cmp_pd_mask(
+                _mm512_loadu_pd(values + i), _mm512_loadu_pd(thresholds + i), _CMP_GT_OQ));
+            num_exceedances += write_mask_indicies(mask, static_cast<uint32_t>(i), indicies + num_exceedances);
+        }
+        return num_exceedances + threshold_exceedances_scalar(values, thresholds, num_values, indicies + num_exceedances, i);
+    }
+
+    #pragma GCC diagnostic pop
+
+#endif
+
+    //dispatch ################################################################
+
+    typedef double (*fc32_kernel)(const float *, size_t);
+    typedef double (*fc64_kernel)(const double *, size_t);
+    typedef double (*sc16_kernel)(const int16_t *, size_t);
+    typedef size_t (*fc32_threshold_kernel)(const float *, const float *, size_t, uint32_t *);
+    typedef size_t (*fc64_threshold_kernel)(const double *, const double *, size_t, uint32_t *);
+
+    size_t threshold_exceedances_fc32_scalar(const float * values, const float * thresholds,
+                                            size_t num_values, uint32_t * indicies){
+        return threshold_exceedances_scalar(values, thresholds, num_values, indicies);
+    }
+
+    size_t threshold_exceedances_fc64_scalar(const double * values, const double * thresholds,
+                                            size_t num_values, uint32_t * indicies){
+        return threshold_exceedances_scalar(values, thresholds, num_values, indicies);
+    }
+
+    struct Kernels {
+        SIMDKernels::ISA isa;
+        fc32_kernel fc32;
+        fc64_kernel fc64;
+        sc16_kernel sc16;
+        fc32_threshold_kernel fc32_threshold;
+        fc64_threshold_kernel fc64_threshold;
+    };
+
+    SIMDKernels::ISA detect_isa(void){
+#ifdef SIMDKERNELS_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            return SIMDKernels::ISA::avx512;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            return SIMDKernels::ISA::avx2;
+        }
+        if (__builtin_cpu_supports("sse2"))
+        {
+            return SIMDKernels::ISA::sse2;
+        }
+#endif
+        return SIMDKernels::ISA::scalar;
+    }
+
+    //the AVX-512 sc16 kernel also needs avx512bw (the AVX2 sc16 kernel is used without it)
+    bool detect_avx512bw(void){
+#ifdef SIMDKERNELS_X86
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx512bw");
+#else
+        return false;
+#endif
+    }
+
+    const bool avx512bw_supported = detect_avx512bw();
+
+    Kernels select_kernels(SIMDKernels::ISA isa){
+        Kernels kernels;
+        kernels.isa = SIMDKernels::ISA::scalar;
+        kernels.fc32 = signal_energy_fc32_scalar;
+        kernels.fc64 = signal_energy_fc64_scalar;
+        kernels.sc16 = signal_energy_sc16_scalar;
+        kernels.fc32_threshold = threshold_exceedances_fc32_scalar;
+        kernels.fc64_threshold = threshold_exceedances_fc64_scalar;
+#ifdef SIMDKERNELS_X86
+        switch (isa)
+        {
+        case SIMDKernels::ISA::avx512:
+            kernels.isa = isa;
+            kernels.fc32 = signal_energy_fc32_avx512;
+            kernels.fc64 = signal_energy_fc64_avx512;
+            kernels.sc16 = avx512bw_supported ? signal_energy_sc16_avx512 : signal_energy_sc16_avx2;
+            kernels.fc32_threshold = threshold_exceedances_fc32_avx512;
+            kernels.fc64_threshold = threshold_exceedances_fc64_avx512;
+            break;
+        case SIMDKernels::ISA::avx2:
+            kernels.isa = isa;
+            kernels.fc32 = signal_energy_fc32_avx2;
+            kernels.fc64 = signal_energy_fc64_avx2;
+            kernels.sc16 = signal_energy_sc16_avx2;
+            kernels.fc32_threshold = threshold_exceedances_fc32_avx2;
+            kernels.fc64_threshold = threshold_exceedances_fc64_avx2;
+            break;
+        case SIMDKernels::ISA::sse2:
+            kernels.isa = isa;
+            kernels.fc32 = signal_energy_fc32_sse2;
+            kernels.fc64 = signal_energy_fc64_sse2;
+            kernels.sc16 = signal_energy_sc16_sse2;
+            kernels.fc32_threshold = threshold_exceedances_fc32_sse2;
+            kernels.fc64_threshold = threshold_exceedances_fc64_sse2;
+            break;
+        default:
+            break;
+        }
+#endif
+        return kernels;
+    }
+
+    const SIMDKernels::ISA supported_isa = detect_isa();
+    Kernels active_kernels = select_kernels(supported_isa);
+}
+
+SIMDKernels::ISA SIMDKernels::get_supported_isa(void){
+    return supported_isa;
+}
+
+SIMDKernels::ISA SIMDKernels::get_active_isa(void){
+    return active_kernels.isa;
+}
+
+SIMDKernels::ISA SIMDKernels::set_active_isa(ISA isa){
+    if (static_cast<int>(isa) > static_cast<int>(supported_isa))
+    {
+        std::cerr << "SIMDKernels::set_active_isa: " << isa_name(isa) <<
+                    " not supported, using " << isa_name(supported_isa) << std::endl;
+        isa = supported_isa;
+    }
+    active_kernels = select_kernels(isa);
+    return active_kernels.isa;
+}
+
+const char * SIMDKernels::isa_name(ISA isa){
+    switch (isa)
+    {
+    case ISA::avx512:
+        return "AVX-512";
+    case ISA::avx2:
+        return "AVX2";
+    case ISA::sse2:
+        return "SSE2";
+    default:
+        return "scalar";
+    }
+}
+
+double SIMDKernels::signal_energy(const std::complex<float> * signal, size_t num_samples){
+    return active_kernels.fc32(reinterpret_cast<const float *>(signal), 2 * num_samples);
+}
+
+double SIMDKernels::signal_energy(const std::complex<double> * signal, size_t num_samples){
+    return active_kernels.fc64(reinterpret_cast<const double *>(signal), 2 * num_samples);
+}
+
+double SIMDKernels::signal_energy(const std::complex<int16_t> * signal, size_t num_samples){
+    return active_kernels.sc16(reinterpret_cast<const int16_t *>(signal), 2 * num_samples);
+}
+
+size_t SIMDKernels::threshold_exceedances(const float * values, const float * thresholds,
+                                            size_t num_values, uint32_t * indicies){
+    return active_kernels.fc32_threshold(values, thresholds, num_values, indicies);
+}
+
+size_t SIMDKernels::threshold_exceedances(const double * values, const double * thresholds,
+                                            size_t num_values, uint32_t * indicies){
+    return active_kernels.fc64_threshold(values, thresholds, num_values, indicies);
+}
@@ -0,0 +1,79 @@
+#ifndef SIMDKERNELS
+#define SIMDKERNELS
+    #include <iostream>
+    #include <cstdlib>
+    #include <cstdint>
+    #include <complex>
+
+    namespace SIMDKernels {
+
+        /**
+         * @brief Instruction sets that the kernels can be dispatched to
+         *
+         */
+        enum class ISA {scalar, sse2, avx2, avx512};
+
+        /**
+         * @brief Get the best instruction set supported by the cpu (detected at runtime)
+         *
+         * @return ISA the best supported instruction set
+         */
+        ISA get_supported_isa(void);
+
+        /**
+         * @brief Get the instruction set that the kernels are currently dispatched to
+         *
+         * @return ISA the active instruction set
+         */
+        ISA get_active_isa(void);
+
+        /**
+         * @brief Force the kernels to use the given instruction set (falls back
+         * to the best supported instruction set if the cpu doesn't support it)
+         *
+         * @param isa the instruction set to use
+         * @return ISA the instruction set that is now active
+         */
+        ISA set_active_isa(ISA isa);
+
+        /**
+         * @brief Get the name of an instruction set
+         *
+         * @param isa the instruction set
+         * @return const char* the name of the instruction set
+         */
+        const char * isa_name(ISA isa);
+
+        /**
+         * @brief Compute the energy (sum of |x|^2) of a complex signal
+         *
+         * @param signal pointer to the first sample
+         * @param num_samples the number of complex samples
+         * @return double the sum of |x|^2 over the signal
+         */
+        double signal_energy(const std::complex<float> * signal, size_t num_samples);
+        double signal_energy(const std::complex<double> * signal, size_t num_samples);
+
+        /**
+         * @brief Compute the energy (sum of |x|^2) of an interleaved int16 (sc16) signal
+         * (in raw integer units, scale by 1/32767^2 to match the fc32 conversion)
+         *
+         * @param signal pointer to the first sample
+         * @param num_samples the number of complex samples
+         * @return double the sum of |x|^2 over the signal
+         */
+        double signal_energy(const std::complex<int16_t> * signal, size_t num_samples);
+
+        /**
+         * @brief Find the values that exceed their threshold (values[i] > thresholds[i])
+         *
+         * @param values pointer to the first value
+         * @param thresholds pointer to the first threshold (one per value)
+         * @param num_values the number of values
+         * @param indicies array (of at least num_values) to write the index of each exceedance to
+         * @return size_t the number of exceedances written to indicies
+         */
+        size_t threshold_exceedances(const float * values, const float * thresholds, size_t num_values, uint32_t * indicies);
+        size_t threshold_exceedances(const double * values, const double * thresholds, size_t num_values, uint32_t * indicies);
+    }
+#endif
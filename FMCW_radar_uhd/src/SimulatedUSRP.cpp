@@ -0,0 +1,8 @@
+#include "SimulatedUSRP.hpp"
+
+/**
+ * All of the code for this file is located in the header file.
+ * This was done because the SimulatedUSRP class is a templated
+ * class and so this made the most sense.
+ * 
+ */
@@ -0,0 +1,818 @@
+#ifndef SIMULATEDUSRP
+#define SIMULATEDUSRP
+    //C standard libraries
+    #include <iostream>
+    #include <cstdlib>
+    #include <string>
+    #include <complex>
+    #include <vector>
+    #include <deque>
+    #include <memory>
+    #include <mutex>
+    #include <condition_variable>
+    #include <chrono>
+    #include <thread>
+    #include <random>
+    #include <algorithm>
+    #include <cstdint>
+
+    #define _USE_MATH_DEFINES
+    #include <cmath>
+
+    //uhd specific libraries
+    #include <uhd/stream.hpp>
+    #include <uhd/types/metadata.hpp>
+    #include <uhd/types/stream_cmd.hpp>
+    #include <uhd/types/time_spec.hpp>
+
+    //JSON class
+    #include <nlohmann/json.hpp>
+
+    using json = nlohmann::json;
+
+    namespace SimulatedUSRP_namespace {
+
+        /**
+         * @brief Device clock for the simulated USRP. The clock either follows the wall clock
+         * (scaled by the real time factor) or, when the real time factor is <= 0, is a virtual
+         * clock that only advances when a streamer waits on it (i.e: runs as fast as possible)
+         *
+         */
+        class SimulatedClock {
+            private:
+                double sample_rate;
+                double real_time_factor;
+
+                std::mutex clock_mutex;
+                std::chrono::steady_clock::time_point wall_reference;
+                long long tick_reference; //device time (in samples) at the wall reference
+                long long virtual_ticks; //device time (in samples) when using a virtual clock
+
+            public:
+
+                /**
+                 * @brief Construct a new Simulated Clock object
+                 *
+                 * @param rate the sample rate (ticks per second)
+                 * @param time_factor device seconds per wall clock second (<= 0 for a virtual clock)
+                 */
+                SimulatedClock(double rate, double time_factor):
+                    sample_rate(rate),
+                    real_time_factor(time_factor),
+                    wall_reference(std::chrono::steady_clock::now()),
+                    tick_reference(0),
+                    virtual_ticks(0){}
+
+                /**
+                 * @brief Get the current device time
+                 *
+                 * @return long long the current device time in samples
+                 */
+                long long get_ticks(void){
+                    std::lock_guard<std::mutex> lock(clock_mutex);
+                    if (is_virtual())
+                    {
+                        return virtual_ticks;
+                    }
+                    double elapsed_s = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - wall_reference).count();
+                    return tick_reference + static_cast<long long>(elapsed_s * real_time_factor * sample_rate);
+                }
+
+                /**
+                 * @brief Set the current device time
+                 *
+                 * @param ticks the new device time in samples
+                 */
+                void set_ticks(long long ticks){
+                    std::lock_guard<std::mutex> lock(clock_mutex);
+                    wall_reference = std::chrono::steady_clock::now();
+                    tick_reference = ticks;
+                    virtual_ticks = ticks;
+                }
+
+                /**
+                 * @brief Wait until the device time reaches the given time
+                 *
+                 * @param ticks the device time (in samples) to wait for
+                 * @param timeout the maximum (wall clock) time to wait in seconds
+                 * @return true - the device time was reached
+                 * @return false - the timeout expired first
+                 */
+                bool wait_until(long long ticks, double timeout){
+                    if (is_virtual())
+                    {
+                        std::lock_guard<std::mutex> lock(clock_mutex);
+                        virtual_ticks = std::max(virtual_ticks, ticks);
+                        return true;
+                    }
+
+                    long long current_ticks = get_ticks();
+                    if (current_ticks >= ticks)
+                    {
+                        return true;
+                    }
+                    double wait_s = static_cast<double>(ticks - current_ticks) / (sample_rate * real_time_factor);
+                    if (wait_s > timeout)
+                    {
+                        std::this_thread::sleep_for(std::chrono::duration<double>(timeout));
+                        return false;
+                    }
+                    std::this_thread::sleep_for(std::chrono::duration<double>(wait_s));
+                    return true;
+                }
+
+                bool is_virtual(void) const{
+                    return real_time_factor <= 0;
+                }
+
+                double get_sample_rate(void) const{
+                    return sample_rate;
+                }
+        };
+
+        /**
+         * @brief Synthesizes the signal seen by the simulated receiver: complex gaussian noise plus
+         * the frames of a victim FMCW radar. Only the part of each chirp that falls within the
+         * receiver's bandwidth is received. The chirp and the noise are precomputed into tables
+         * so that synthesis is a table lookup per sample
+         *
+         * @tparam data_type the cpu_format used for the USRP device, will be std::complex<data_type>
+         */
+        template<typename data_type>
+        class SimulatedVictim {
+            private:
+                //precomputed tables
+                std::vector<std::complex<data_type>> chirp_table;
+                std::vector<std::complex<data_type>> noise_table; //size is a power of 2
+                size_t noise_table_mask;
+
+                //victim timing (in samples)
+                bool enabled;
+                long long start_ticks;
+                long long frame_period_ticks;
+                long long chirp_period_ticks;
+                size_t chirps_per_frame;
+                size_t num_frames; //0 for an unlimited number of frames
+
+                //random offset into the noise table for each block
+                std::mt19937 generator;
+
+            public:
+
+                /**
+                 * @brief Construct a new Simulated Victim object
+                 *
+                 * @param settings the SimulatedUSRPSettings JSON object
+                 * @param sample_rate the sample rate of the simulated receiver
+                 */
+                SimulatedVictim(json & settings, double sample_rate):
+                    enabled(false),
+                    start_ticks(0),
+                    frame_period_ticks(1),
+                    chirp_period_ticks(1),
+                    chirps_per_frame(0),
+                    num_frames(0){
+
+                    unsigned int seed = settings["seed"].is_null() ? 0 : settings["seed"].get<unsigned int>();
+                    generator.seed(seed);
+
+                    initialize_noise_table(settings);
+                    initialize_victim(settings,sample_rate);
+                }
+
+                /**
+                 * @brief Write the received signal for the given samples
+                 *
+                 * @param samples buffer to write the samples to
+                 * @param first_tick the device time (in samples) of the first sample
+                 * @param num_samples the number of samples to write
+                 */
+                void synthesize(std::complex<data_type> * samples, long long first_tick, size_t num_samples){
+
+                    //noise
+                    size_t noise_idx = static_cast<size_t>(generator());
+                    for (size_t i = 0; i < num_samples; i++)
+                    {
+                        samples[i] = noise_table[(noise_idx + i) & noise_table_mask];
+                    }
+
+                    if ((! enabled) || chirp_table.empty())
+                    {
+                        return;
+                    }
+
+                    //add the chirps from each frame that overlaps the block
+                    long long end_tick = first_tick + static_cast<long long>(num_samples);
+                    long long frame = (first_tick > start_ticks) ? (first_tick - start_ticks) / frame_period_ticks : 0;
+                    long long chirp_length = static_cast<long long>(chirp_table.size());
+                    for (; (start_ticks + frame * frame_period_ticks) < end_tick; frame++)
+                    {
+                        if ((num_frames > 0) && (frame >= static_cast<long long>(num_frames)))
+                        {
+                            break;
+                        }
+
+                        long long frame_start = start_ticks + frame * frame_period_ticks;
+                        for (size_t chirp = 0; chirp < chirps_per_frame; chirp++)
+                        {
+                            long long chirp_start = frame_start + static_cast<long long>(chirp) * chirp_period_ticks;
+                            long long overlap_start = std::max(chirp_start, first_tick);
+                            long long overlap_end = std::min(chirp_start + chirp_length, end_tick);
+                            for (long long t = overlap_start; t < overlap_end; t++)
+                            {
+                                samples[t - first_tick] += chirp_table[t - chirp_start];
+                            }
+                        }
+                    }
+                }
+
+            private:
+
+                /**
+                 * @brief precompute a table of complex gaussian noise samples
+                 *
+                 * @param settings the SimulatedUSRPSettings JSON object
+                 */
+                void initialize_noise_table(json & settings){
+                    double noise_amplitude = settings["noise_amplitude"].is_null() ?
+                                                0.01 : settings["noise_amplitude"].get<double>();
+
+                    noise_table = std::vector<std::complex<data_type>>(1 << 16);
+                    noise_table_mask = noise_table.size() - 1;
+                    std::normal_distribution<double> distribution(0.0, noise_amplitude);
+                    for (size_t i = 0; i < noise_table.size(); i++)
+                    {
+                        noise_table[i] = std::complex<data_type>(
+                            static_cast<data_type>(distribution(generator)),
+                            static_cast<data_type>(distribution(generator)));
+                    }
+                }
+
+                /**
+                 * @brief precompute the victim chirp and its timing
+                 *
+                 * @param settings the SimulatedUSRPSettings JSON object
+                 * @param sample_rate the sample rate of the simulated receiver
+                 */
+                void initialize_victim(json & settings, double sample_rate){
+                    json & victim = settings["Victim"];
+                    if (victim.is_null() || victim["enabled"].is_null() || (victim["enabled"].get<bool>() == false))
+                    {
+                        return;
+                    }
+                    enabled = true;
+
+                    double start_freq_Hz = victim["chirp_start_freq_MHz"].is_null() ? 1.0 : victim["chirp_start_freq_MHz"].get<double>();
+                    double slope_Hz_s = victim["chirp_slope_MHz_us"].is_null() ? 0.5 : victim["chirp_slope_MHz_us"].get<double>();
+                    double chirp_duration_s = victim["chirp_duration_us"].is_null() ? 10.0 : victim["chirp_duration_us"].get<double>();
+                    double chirp_idle_s = victim["chirp_idle_time_us"].is_null() ? 5.0 : victim["chirp_idle_time_us"].get<double>();
+                    double frame_period_s = victim["frame_periodicity_ms"].is_null() ? 33.33 : victim["frame_periodicity_ms"].get<double>();
+                    double start_delay_s = victim["start_delay_ms"].is_null() ? 5.0 : victim["start_delay_ms"].get<double>();
+                    double amplitude = victim["amplitude"].is_null() ? 0.5 : victim["amplitude"].get<double>();
+                    chirps_per_frame = victim["num_chirps"].is_null() ? 64 : victim["num_chirps"].get<size_t>();
+                    num_frames = victim["num_frames"].is_null() ? 0 : victim["num_frames"].get<size_t>();
+
+                    //convert to SI units
+                    start_freq_Hz *= 1e6;
+                    slope_Hz_s *= 1e12;
+                    chirp_duration_s *= 1e-6;
+                    chirp_idle_s *= 1e-6;
+                    frame_period_s *= 1e-3;
+                    start_delay_s *= 1e-3;
+
+                    //convert to samples
+                    size_t chirp_length = static_cast<size_t>(std::round(chirp_duration_s * sample_rate));
+                    chirp_period_ticks = std::max(static_cast<long long>(chirp_length),
+                        static_cast<long long>(std::round((chirp_duration_s + chirp_idle_s) * sample_rate)));
+                    frame_period_ticks = std::max(static_cast<long long>(1),
+                        static_cast<long long>(std::round(frame_period_s * sample_rate)));
+                    start_ticks = static_cast<long long>(std::round(start_delay_s * sample_rate));
+
+                    if ((static_cast<long long>(chirps_per_frame) * chirp_period_ticks) > frame_period_ticks)
+                    {
+                        std::cerr << "SimulatedVictim::initialize_victim: the chirps in a frame are longer than the frame periodicity" << std::endl;
+                    }
+
+                    //the spectrogram's frequency bins run from 0 to the sample rate, so a chirp that sweeps through 0 Hz wraps around
+                    double stop_freq_Hz = start_freq_Hz + slope_Hz_s * chirp_duration_s;
+                    if ((std::min(start_freq_Hz, stop_freq_Hz) < 0) && (std::max(start_freq_Hz, stop_freq_Hz) > 0))
+                    {
+                        std::cerr << "SimulatedVictim::initialize_victim: the chirp sweeps through 0 Hz, its slope won't be estimated correctly" << std::endl;
+                    }
+
+                    //precompute the chirp (only the part within the receiver's bandwidth is received)
+                    chirp_table = std::vector<std::complex<data_type>>(chirp_length);
+                    for (size_t i = 0; i < chirp_length; i++)
+                    {
+                        double t = static_cast<double>(i) / sample_rate;
+                        double freq = start_freq_Hz + slope_Hz_s * t;
+                        if (std::abs(freq) < (sample_rate / 2))
+                        {
+                            double phase = 2 * M_PI * (start_freq_Hz * t + 0.5 * slope_Hz_s * t * t);
+                            chirp_table[i] = std::complex<data_type>(
+                                static_cast<data_type>(amplitude * std::cos(phase)),
+                                static_cast<data_type>(amplitude * std::sin(phase)));
+                        }
+                        else{
+                            chirp_table[i] = std::complex<data_type>(0);
+                        }
+                    }
+                }
+        };
+
+        /**
+         * @brief Simulated rx streamer, supports timed/immediate stream commands
+         * (continuous, num samps and done/more), timestamped metadata, and overflows
+         * (when the host falls behind or injected at random). Samples are received as
+         * std::complex<data_type> or, after set_cpu_format("sc16"), as std::complex<int16_t>
+         *
+         * @tparam data_type the cpu_format used for the USRP device, will be std::complex<data_type>
+         */
+        template<typename data_type>
+        class SimulatedRxStreamer : public uhd::rx_streamer {
+            private:
+                std::shared_ptr<SimulatedClock> clock;
+                std::shared_ptr<SimulatedVictim<data_type>> victim;
+                size_t max_num_samps;
+
+                //sc16 output (the samples are synthesized into sc16_samples and then quantized)
+                bool sc16;
+                std::vector<std::complex<data_type>> sc16_samples;
+
+                //stream state
+                std::mutex stream_mutex;
+                bool streaming;
+                bool continuous;
+                bool start_of_burst;
+                long long next_tick; //device time of the next sample to be received
+                size_t samps_remaining;
+
+                //overflow generation
+                long long rx_buffer_ticks; //samples buffered before the host falls behind
+                double overflow_probability;
+                std::mt19937 generator;
+                std::uniform_real_distribution<double> distribution;
+
+            public:
+                //statistics
+                size_t samples_received;
+                size_t num_overflows;
+
+                SimulatedRxStreamer(std::shared_ptr<SimulatedClock> device_clock,
+                                    std::shared_ptr<SimulatedVictim<data_type>> simulated_victim,
+                                    size_t samps_per_packet,
+                                    double rx_buffer_s,
+                                    double probability_of_overflow,
+                                    unsigned int seed):
+                    clock(device_clock),
+                    victim(simulated_victim),
+                    max_num_samps(samps_per_packet),
+                    sc16(false),
+                    streaming(false),
+                    continuous(false),
+                    start_of_burst(false),
+                    next_tick(0),
+                    samps_remaining(0),
+                    rx_buffer_ticks(static_cast<long long>(rx_buffer_s * device_clock -> get_sample_rate())),
+                    overflow_probability(probability_of_overflow),
+                    generator(seed),
+                    distribution(0.0,1.0),
+                    samples_received(0),
+                    num_overflows(0){}
+
+                size_t get_num_channels(void) const override{
+                    return 1;
+                }
+
+                size_t get_max_num_samps(void) const override{
+                    return max_num_samps;
+                }
+
+                /**
+                 * @brief Set the format that the samples are received in
+                 *
+                 * @param cpu_format "sc16" for std::complex<int16_t> samples, otherwise std::complex<data_type>
+                 */
+                void set_cpu_format(const std::string & cpu_format){
+                    std::lock_guard<std::mutex> lock(stream_mutex);
+                    sc16 = (cpu_format == "sc16");
+                    sc16_samples.resize(sc16 ? max_num_samps : 0);
+                }
+
+                /**
+                 * @brief Issue a stream command. A new command issued while streaming continues
+                 * the current stream (without a gap), otherwise the stream starts at the command time
+                 *
+                 * @param stream_cmd the stream command
+                 */
+                void issue_stream_cmd(const uhd::stream_cmd_t & stream_cmd) override{
+                    std::lock_guard<std::mutex> lock(stream_mutex);
+
+                    if (stream_cmd.stream_mode == uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS)
+                    {
+                        streaming = false;
+                        return;
+                    }
+
+                    if (! streaming)
+                    {
+                        next_tick = stream_cmd.stream_now ?
+                                        clock -> get_ticks() :
+                                        stream_cmd.time_spec.to_ticks(clock -> get_sample_rate());
+                        start_of_burst = true;
+                        samps_remaining = 0;
+                    }
+                    else if (continuous)
+                    {
+                        //a num samps command ends a continuous stream after num samps
+                        samps_remaining = 0;
+                    }
+                    //otherwise, num samps commands issued while streaming are queued behind the current one
+
+                    streaming = true;
+                    continuous = (stream_cmd.stream_mode == uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+                    samps_remaining += stream_cmd.num_samps;
+                }
+
+                /**
+                 * @brief Receive samples (blocks until the samples would have been received by the device)
+                 *
+                 */
+                size_t recv(const buffs_type & buffs,
+                            const size_t nsamps_per_buff,
+                            uhd::rx_metadata_t & metadata,
+                            const double timeout = 0.1,
+                            const bool one_packet = false) override{
+
+                    std::lock_guard<std::mutex> lock(stream_mutex);
+
+                    metadata.has_time_spec = false;
+                    metadata.more_fragments = false;
+                    metadata.fragment_offset = 0;
+                    metadata.start_of_burst = false;
+                    metadata.end_of_burst = false;
+                    metadata.out_of_sequence = false;
+                    metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_NONE;
+
+                    if (! streaming)
+                    {
+                        if (! clock -> is_virtual())
+                        {
+                            std::this_thread::sleep_for(std::chrono::duration<double>(timeout));
+                        }
+                        metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_TIMEOUT;
+                        return 0;
+                    }
+
+                    //determine the number of samples to receive
+                    size_t num_samps = nsamps_per_buff;
+                    if (one_packet)
+                    {
+                        num_samps = std::min(num_samps, max_num_samps);
+                    }
+                    if (! continuous)
+                    {
+                        num_samps = std::min(num_samps, samps_remaining);
+                    }
+
+                    //wait for the device to receive the samples
+                    long long end_tick = next_tick + static_cast<long long>(num_samps);
+                    if (! clock -> wait_until(end_tick, timeout))
+                    {
+                        metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_TIMEOUT;
+                        return 0;
+                    }
+
+                    //overflow if the host fell too far behind the device or if one is injected
+                    long long current_tick = clock -> get_ticks();
+                    bool host_behind = (! clock -> is_virtual()) && ((current_tick - end_tick) > rx_buffer_ticks);
+                    if (host_behind || ((overflow_probability > 0) && (distribution(generator) < overflow_probability)))
+                    {
+                        //drop the buffered samples, the stream resumes at the current time
+                        long long num_dropped = std::max(current_tick - next_tick, static_cast<long long>(max_num_samps));
+                        next_tick += num_dropped;
+                        if (! continuous)
+                        {
+                            samps_remaining -= std::min(samps_remaining, static_cast<size_t>(num_dropped));
+                            streaming = (samps_remaining > 0);
+                        }
+                        num_overflows += 1;
+                        metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_OVERFLOW;
+                        return 0;
+                    }
+
+                    //synthesize the received samples
+                    if (sc16)
+                    {
+                        synthesize_sc16(static_cast<std::complex<int16_t> *>(buffs[0]), num_samps);
+                    }
+                    else{
+                        victim -> synthesize(static_cast<std::complex<data_type> *>(buffs[0]), next_tick, num_samps);
+                    }
+                    metadata.has_time_spec = true;
+                    metadata.time_spec = uhd::time_spec_t::from_ticks(next_tick, clock -> get_sample_rate());
+                    metadata.start_of_burst = start_of_burst;
+                    start_of_burst = false;
+
+                    next_tick = end_tick;
+                    samples_received += num_samps;
+                    if (! continuous)
+                    {
+                        samps_remaining -= num_samps;
+                        if (samps_remaining == 0)
+                        {
+                            streaming = false;
+                            metadata.end_of_burst = true;
+                        }
+                    }
+                    return num_samps;
+                }
+
+            private:
+
+                /**
+                 * @brief Synthesize the next samples and quantize them to sc16 (full scale is 32767,
+                 * the inverse of UHD's sc16 to fc32 conversion)
+                 *
+                 * @param samples pointer to where the samples should be written
+                 * @param num_samps the number of samples
+                 */
+                void synthesize_sc16(std::complex<int16_t> * samples, size_t num_samps){
+                    if (sc16_samples.size() < num_samps)
+                    {
+                        sc16_samples.resize(num_samps);
+                    }
+                    victim -> synthesize(sc16_samples.data(), next_tick, num_samps);
+                    for (size_t i = 0; i < num_samps; i++)
+                    {
+                        samples[i] = std::complex<int16_t>(
+                            to_sc16(sc16_samples[i].real()), to_sc16(sc16_samples[i].imag()));
+                    }
+                }
+
+                static int16_t to_sc16(data_type value){
+                    double scaled = std::round(static_cast<double>(value) * 32767.0);
+                    return static_cast<int16_t>(std::min(std::max(scaled, -32768.0), 32767.0));
+                }
+        };
+
+        /**
+         * @brief Simulated tx streamer, supports timed bursts and reports burst ACKs,
+         * late bursts, and underflows through recv_async_msg. Transmitted samples are discarded
+         *
+         */
+        class SimulatedTxStreamer : public uhd::tx_streamer {
+            private:
+                //an async message and the device time that it is reported at
+                struct AsyncEvent {
+                    uhd::async_metadata_t metadata;
+                    long long report_tick;
+                };
+
+                std::shared_ptr<SimulatedClock> clock;
+                size_t max_num_samps;
+                long long tx_buffer_ticks; //how far ahead of the device the host can send
+
+                //burst state
+                bool in_burst;
+                bool burst_error;
+                long long next_tick; //device time of the next sample to be sent
+
+                //async messages
+                std::mutex async_mutex;
+                std::condition_variable async_cv;
+                std::deque<AsyncEvent> async_events;
+
+            public:
+                //statistics
+                size_t samples_sent;
+                size_t num_late_bursts;
+                size_t num_underflows;
+
+                SimulatedTxStreamer(std::shared_ptr<SimulatedClock> device_clock,
+                                    size_t samps_per_packet,
+                                    double tx_buffer_s):
+                    clock(device_clock),
+                    max_num_samps(samps_per_packet),
+                    tx_buffer_ticks(static_cast<long long>(tx_buffer_s * device_clock -> get_sample_rate())),
+                    in_burst(false),
+                    burst_error(false),
+                    next_tick(0),
+                    samples_sent(0),
+                    num_late_bursts(0),
+                    num_underflows(0){}
+
+                size_t get_num_channels(void) const override{
+                    return 1;
+                }
+
+                size_t get_max_num_samps(void) const override{
+                    return max_num_samps;
+                }
+
+                /**
+                 * @brief Send samples (blocks if the host is more than the tx buffer ahead of the device)
+                 *
+                 */
+                size_t send(const buffs_type & buffs,
+                            const size_t nsamps_per_buff,
+                            const uhd::tx_metadata_t & metadata,
+                            const double timeout = 0.1) override{
+
+                    (void) buffs;
+                    long long current_tick = clock -> get_ticks();
+
+                    //start a new burst
+                    if (metadata.start_of_burst || (! in_burst))
+                    {
+                        in_burst = true;
+                        burst_error = false;
+                        next_tick = metadata.has_time_spec ?
+                                        metadata.time_spec.to_ticks(clock -> get_sample_rate()) :
+                                        current_tick;
+                        if (metadata.has_time_spec && (next_tick < current_tick))
+                        {
+                            burst_error = true;
+                            num_late_bursts += 1;
+                            push_async_event(uhd::async_metadata_t::EVENT_CODE_TIME_ERROR, current_tick, current_tick);
+                        }
+                    }
+                    else if ((! clock -> is_virtual()) && (! burst_error) && (next_tick < current_tick))
+                    {
+                        //the host didn't keep up with the device
+                        burst_error = true;
+                        num_underflows += 1;
+                        push_async_event(uhd::async_metadata_t::EVENT_CODE_UNDERFLOW, current_tick, current_tick);
+                    }
+
+                    //flow control
+                    if (! clock -> wait_until(next_tick + static_cast<long long>(nsamps_per_buff) - tx_buffer_ticks, timeout))
+                    {
+                        return 0;
+                    }
+                    next_tick += static_cast<long long>(nsamps_per_buff);
+                    samples_sent += nsamps_per_buff;
+
+                    //the ACK is reported once the device has sent the end of the burst
+                    if (metadata.end_of_burst)
+                    {
+                        in_burst = false;
+                        if (! burst_error)
+                        {
+                            push_async_event(uhd::async_metadata_t::EVENT_CODE_BURST_ACK, next_tick, next_tick);
+                        }
+                    }
+                    return nsamps_per_buff;
+                }
+
+                /**
+                 * @brief Receive an async message (blocks until a message is reported or the timeout expires)
+                 *
+                 */
+                bool recv_async_msg(uhd::async_metadata_t & async_metadata, double timeout = 0.1) override{
+                    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeout));
+
+                    std::unique_lock<std::mutex> lock(async_mutex);
+                    while (true)
+                    {
+                        if (async_events.empty())
+                        {
+                            if (async_cv.wait_until(lock, deadline) == std::cv_status::timeout && async_events.empty())
+                            {
+                                return false;
+                            }
+                            continue;
+                        }
+
+                        //wait for the device to reach the time that the event is reported at
+                        AsyncEvent event = async_events.front();
+                        lock.unlock();
+                        double remaining_s = std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+                        bool reported = clock -> wait_until(event.report_tick, std::max(remaining_s, 0.0));
+                        lock.lock();
+                        if (! reported)
+                        {
+                            return false;
+                        }
+
+                        async_metadata = event.metadata;
+                        async_events.pop_front();
+                        return true;
+                    }
+                }
+
+            private:
+
+                void push_async_event(uhd::async_metadata_t::event_code_t event_code, long long event_tick, long long report_tick){
+                    AsyncEvent event;
+                    event.metadata.channel = 0;
+                    event.metadata.has_time_spec = true;
+                    event.metadata.time_spec = uhd::time_spec_t::from_ticks(event_tick, clock -> get_sample_rate());
+                    event.metadata.event_code = event_code;
+                    event.report_tick = report_tick;
+                    {
+                        std::lock_guard<std::mutex> lock(async_mutex);
+                        async_events.push_back(event);
+                    }
+                    async_cv.notify_all();
+                }
+        };
+
+        /**
+         * @brief A hardware-free stand in for a uhd::usrp::multi_usrp device. Provides the
+         * same streaming surface (rx/tx streamers and device time) so that the USRPHandler
+         * (and everything that uses it) can run without a USRP
+         *
+         * @tparam data_type the cpu_format used for the USRP device, will be std::complex<data_type>
+         */
+        template<typename data_type>
+        class SimulatedUSRP {
+            private:
+                json config;
+                double sample_rate;
+                std::shared_ptr<SimulatedClock> clock;
+                std::shared_ptr<SimulatedVictim<data_type>> victim;
+                std::shared_ptr<SimulatedRxStreamer<data_type>> rx_streamer;
+                std::shared_ptr<SimulatedTxStreamer> tx_streamer;
+
+            public:
+
+                /**
+                 * @brief Construct a new Simulated USRP object
+                 *
+                 * @param config_data JSON configuration object (uses the USRPSettings sampling rate and the
+                 * SimulatedUSRPSettings)
+                 */
+                SimulatedUSRP(json & config_data): config(config_data){
+                    json & settings = config["SimulatedUSRPSettings"];
+
+                    sample_rate = config["USRPSettings"]["Multi-USRP"]["sampling_rate"].get<double>();
+                    double real_time_factor = settings["real_time_factor"].is_null() ?
+                                                1.0 : settings["real_time_factor"].get<double>();
+                    size_t max_num_samps = settings["max_num_samps"].is_null() ?
+                                                2040 : settings["max_num_samps"].get<size_t>();
+                    double rx_buffer_ms = settings["rx_buffer_ms"].is_null() ?
+                                                10.0 : settings["rx_buffer_ms"].get<double>();
+                    double tx_buffer_ms = settings["tx_buffer_ms"].is_null() ?
+                                                10.0 : settings["tx_buffer_ms"].get<double>();
+                    double overflow_probability = settings["overflow_probability"].is_null() ?
+                                                0.0 : settings["overflow_probability"].get<double>();
+                    unsigned int seed = settings["seed"].is_null() ? 0 : settings["seed"].get<unsigned int>();
+
+                    clock = std::make_shared<SimulatedClock>(sample_rate, real_time_factor);
+                    victim = std::make_shared<SimulatedVictim<data_type>>(settings, sample_rate);
+                    rx_streamer = std::make_shared<SimulatedRxStreamer<data_type>>(
+                        clock, victim, max_num_samps, rx_buffer_ms * 1e-3, overflow_probability, seed);
+                    tx_streamer = std::make_shared<SimulatedTxStreamer>(clock, max_num_samps, tx_buffer_ms * 1e-3);
+
+                    std::cout << "SimulatedUSRP: simulating a USRP at " << sample_rate / 1e6 << " Msps (real time factor: " <<
+                                real_time_factor << ")" << std::endl << std::endl;
+                }
+
+                /**
+                 * @brief Get the rx streamer (there is a single rx streamer, like on a B210)
+                 *
+                 * @param cpu_format the format that the samples are received in ("sc16" or "fc32")
+                 * @return uhd::rx_streamer::sptr the rx streamer
+                 */
+                uhd::rx_streamer::sptr get_rx_stream(const std::string & cpu_format = "fc32"){
+                    rx_streamer -> set_cpu_format(cpu_format);
+                    return rx_streamer;
+                }
+
+                uhd::tx_streamer::sptr get_tx_stream(void){
+                    return tx_streamer;
+                }
+
+                uhd::time_spec_t get_time_now(void){
+                    return uhd::time_spec_t::from_ticks(clock -> get_ticks(), sample_rate);
+                }
+
+                void set_time_now(const uhd::time_spec_t & time_spec){
+                    clock -> set_ticks(time_spec.to_ticks(sample_rate));
+                }
+
+                double get_rx_rate(void){
+                    return sample_rate;
+                }
+
+                double get_tx_rate(void){
+                    return sample_rate;
+                }
+
+                /**
+                 * @brief Print the samples streamed and the errors generated by the simulated device
+                 *
+                 */
+                void print_summary(void){
+                    std::cout << "SimulatedUSRP::print_summary: rx samples: " << rx_streamer -> samples_received <<
+                                ", overflows: " << rx_streamer -> num_overflows << std::endl;
+                    std::cout << "SimulatedUSRP::print_summary: tx samples: " << tx_streamer -> samples_sent <<
+                                ", late bursts: " << tx_streamer -> num_late_bursts <<
+                                ", underflows: " << tx_streamer -> num_underflows << std::endl;
+                }
+        };
+    }
+#endif
@@ -0,0 +1,8 @@
+#include "TxEngine.hpp"
+
+/**
+ * All of the code for this file is located in the header file.
+ * This was done because the TxEngine class is a templated
+ * class and so this made the most sense.
+ * 
+ */
@@ -0,0 +1,401 @@
+#ifndef TXENGINE
+#define TXENGINE
+    //C standard libraries
+    #include <iostream>
+    #include <cstdlib>
+    #include <string>
+    #include <complex>
+    #include <vector>
+    #include <deque>
+    #include <thread>
+    #include <mutex>
+    #include <condition_variable>
+    #include <atomic>
+    #include <chrono>
+    #include <functional>
+    #include <memory>
+
+    //uhd specific libraries
+    #include <uhd/stream.hpp>
+    #include <uhd/types/metadata.hpp>
+    #include <uhd/types/time_spec.hpp>
+
+    //user generated header files
+    #include "BufferHandler.hpp"
+    #include "TxSource.hpp"
+    #include "Logger.hpp"
+
+    using Buffers::Buffer_2D;
+    using TxSource_namespace::TxSource;
+    using TxSource_namespace::BufferTxSource;
+
+    namespace TxEngine_namespace {
+
+        /**
+         * @brief A long-lived transmit engine. Timed bursts (a tx source and a start time)
+         * are handed to a persistent transmit thread through a queue, and a second thread blocks on
+         * recv_async_msg and reports burst ACKs, underflows, late bursts, and other async events
+         * through callbacks. Neither thread spins: the transmit thread sleeps on a condition
+         * variable while the queue is empty and the async thread blocks inside recv_async_msg.
+         *
+         * @tparam data_type the cpu_format used for the USRP device, will be std::complex<data_type>
+         */
+        template<typename data_type>
+        class TxEngine {
+            public:
+                //callback used to report an async event
+                typedef std::function<void(const uhd::async_metadata_t &)> async_callback_t;
+
+            private:
+                //a timed burst request
+                struct TxBurst {
+                    std::shared_ptr<const TxSource<data_type>> tx_source;
+                    uhd::time_spec_t start_time;
+                };
+
+                //tx streamer
+                uhd::tx_streamer::sptr tx_stream;
+
+                //burst queue
+                std::mutex queue_mutex;
+                std::condition_variable queue_cv; //signaled when a burst is submitted or on stop
+                std::condition_variable idle_cv; //signaled when a burst is sent or an event is reported
+                std::deque<TxBurst> burst_queue;
+                bool sending; //true while the transmit thread is sending a burst
+
+                //threads
+                std::thread transmit_thread;
+                std::thread async_thread;
+                std::atomic<bool> stop_requested;
+                bool engine_running;
+
+                //callbacks
+                async_callback_t burst_ack_callback;
+                async_callback_t underflow_callback;
+                async_callback_t late_callback;
+                async_callback_t other_event_callback;
+
+                //statistics (protected by the queue mutex)
+                size_t bursts_submitted;
+                size_t bursts_sent;
+                size_t num_acks;
+                size_t num_underflows;
+                size_t num_late;
+                size_t num_other_events;
+                size_t num_short_sends;
+
+            public:
+
+                /**
+                 * @brief Construct a new TxEngine object (call start() to start the threads)
+                 *
+                 */
+                TxEngine()
+                    : sending(false),
+                    stop_requested(false),
+                    engine_running(false),
+                    bursts_submitted(0),
+                    bursts_sent(0),
+                    num_acks(0),
+                    num_underflows(0),
+                    num_late(0),
+                    num_other_events(0),
+                    num_short_sends(0){}
+
+                /**
+                 * @brief Destroy the TxEngine object (sends any queued bursts)
+                 *
+                 */
+                ~TxEngine(){
+                    stop();
+                }
+
+                /**
+                 * @brief Set the callbacks for each type of async event (set before calling start())
+                 *
+                 * @param on_burst_ack called when the device reports the end of a burst
+                 * @param on_underflow called when the device reports an underflow
+                 * @param on_late called when a burst's start time had already passed
+                 * @param on_other called for any other async event (ex: sequence errors)
+                 */
+                void set_callbacks(async_callback_t on_burst_ack,
+                                    async_callback_t on_underflow,
+                                    async_callback_t on_late,
+                                    async_callback_t on_other){
+                    burst_ack_callback = on_burst_ack;
+                    underflow_callback = on_underflow;
+                    late_callback = on_late;
+                    other_event_callback = on_other;
+                }
+
+                /**
+                 * @brief start the transmit and async event threads
+                 *
+                 * @param stream the tx streamer to send bursts on
+                 */
+                void start(uhd::tx_streamer::sptr stream){
+                    if (engine_running)
+                    {
+                        std::cerr << "TxEngine::start: engine already running" << std::endl;
+                        return;
+                    }
+                    tx_stream = stream;
+
+                    stop_requested = false;
+                    transmit_thread = std::thread([this]() {
+                        run_transmitter();
+                    });
+                    async_thread = std::thread([this]() {
+                        run_async_handler();
+                    });
+                    engine_running = true;
+                }
+
+                /**
+                 * @brief Send any queued bursts and stop the transmit and async event threads
+                 *
+                 */
+                void stop(void){
+                    if (engine_running)
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock(queue_mutex);
+                            stop_requested = true;
+                        }
+                        queue_cv.notify_all();
+                        transmit_thread.join();
+                        async_thread.join();
+                        engine_running = false;
+                    }
+                }
+
+                /**
+                 * @brief Queue a timed burst for transmission (returns immediately)
+                 *
+                 * @param tx_source the source of the samples to send (kept alive until the burst has been sent)
+                 * @param start_time the device time to start the burst at
+                 */
+                void submit_burst(std::shared_ptr<const TxSource<data_type>> tx_source, uhd::time_spec_t start_time){
+                    TxBurst burst;
+                    burst.tx_source = tx_source;
+                    burst.start_time = start_time;
+                    {
+                        std::lock_guard<std::mutex> lock(queue_mutex);
+                        burst_queue.push_back(burst);
+                        bursts_submitted += 1;
+                    }
+                    queue_cv.notify_one();
+                }
+
+                /**
+                 * @brief Queue a timed burst for transmission (returns immediately)
+                 *
+                 * @param tx_buffer the buffer of samples to send (each row is sent in turn). The buffer
+                 * must remain valid until the burst has been sent
+                 * @param start_time the device time to start the burst at
+                 */
+                void submit_burst(Buffer_2D<std::complex<data_type>> * tx_buffer, uhd::time_spec_t start_time){
+                    submit_burst(std::make_shared<BufferTxSource<data_type>>(tx_buffer), start_time);
+                }
+
+                /**
+                 * @brief Wait for all submitted bursts to be sent and for the device to report
+                 * the outcome (ACK or late) of each of them
+                 *
+                 * @param timeout the maximum time (in seconds) to wait for the outcomes after the
+                 * final burst has been sent
+                 * @return true - all bursts were sent and reported
+                 * @return false - the timeout expired before every burst was reported
+                 */
+                bool wait_for_completion(double timeout = 1.0){
+                    std::unique_lock<std::mutex> lock(queue_mutex);
+
+                    //wait for the transmit thread to send every queued burst
+                    idle_cv.wait(lock, [this]() {
+                        return burst_queue.empty() && (! sending);
+                    });
+
+                    //wait for the outcome of every burst
+                    return idle_cv.wait_for(lock,
+                        std::chrono::duration<double>(timeout),
+                        [this]() {
+                            return (num_acks + num_late) >= bursts_sent;
+                        });
+                }
+
+                /**
+                 * @brief Print the number of bursts sent and the async events reported
+                 *
+                 */
+                void print_summary(void){
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    std::cout << "TxEngine::print_summary: bursts sent: " << bursts_sent <<
+                                ", ACKs: " << num_acks <<
+                                ", late: " << num_late <<
+                                ", underflows: " << num_underflows <<
+                                ", other events: " << num_other_events <<
+                                ", short sends: " << num_short_sends << std::endl << std::endl;
+                }
+
+            private:
+
+                /**
+                 * @brief transmit thread loop, sends queued bursts until stop() is called
+                 * and the queue has been drained
+                 *
+                 */
+                void run_transmitter(void){
+                    uhd::tx_metadata_t tx_md;
+
+                    while (true)
+                    {
+                        TxBurst burst;
+                        {
+                            std::unique_lock<std::mutex> lock(queue_mutex);
+                            queue_cv.wait(lock, [this]() {
+                                return (! burst_queue.empty()) || stop_requested.load();
+                            });
+
+                            //bursts submitted before stop() was called are always sent
+                            if (burst_queue.empty())
+                            {
+                                return;
+                            }
+                            burst = std::move(burst_queue.front());
+                            burst_queue.pop_front();
+                            sending = true;
+                        }
+
+                        send_burst(burst, tx_md);
+
+                        {
+                            std::lock_guard<std::mutex> lock(queue_mutex);
+                            sending = false;
+                            bursts_sent += 1;
+                        }
+                        idle_cv.notify_all();
+                    }
+                }
+
+                /**
+                 * @brief send the samples from a burst's tx source followed by an end of burst packet
+                 *
+                 * @param burst the burst to send
+                 * @param tx_md the tx metadata to use
+                 */
+                void send_burst(TxBurst & burst, uhd::tx_metadata_t & tx_md){
+                    size_t num_sends = burst.tx_source -> get_num_sends();
+                    size_t num_samps_per_buff;
+                    const std::complex<data_type> * samples;
+                    size_t num_samps_sent;
+
+                    //initialize the metadata
+                    tx_md.has_time_spec = true;
+                    tx_md.time_spec = burst.start_time;
+                    tx_md.start_of_burst = false;
+                    tx_md.end_of_burst = false;
+
+                    //stream the desired number of chirps
+                    for (size_t j = 0; j < num_sends; j++)
+                    {
+                        samples = burst.tx_source -> get_send_samples(j, num_samps_per_buff);
+                        num_samps_sent = tx_stream -> send(
+                                    samples,
+                                    num_samps_per_buff,
+                                    tx_md,0.5);
+
+                        tx_md.start_of_burst = false;
+                        tx_md.has_time_spec = false;
+
+                        //confirm that sent correct amount of samples
+                        if (num_samps_sent != num_samps_per_buff){
+                            LOG_WARNING("TxEngine::send_burst: Tried sending {} samples, but only sent {}",
+                                        num_samps_per_buff, num_samps_sent);
+                            std::lock_guard<std::mutex> lock(queue_mutex);
+                            num_short_sends += 1;
+                        }
+                    }
+
+                    // send a mini EOB packet
+                    tx_md.end_of_burst = true;
+                    tx_stream -> send("", 0, tx_md);
+                }
+
+                /**
+                 * @brief async event thread loop, blocks on recv_async_msg and dispatches
+                 * each event to its callback until the engine is stopped
+                 *
+                 */
+                void run_async_handler(void){
+                    uhd::async_metadata_t async_md;
+
+                    while (true)
+                    {
+                        //recv_async_msg blocks until an event arrives or the timeout expires,
+                        //stop once the transmitter has exited and no further events arrive
+                        if (! tx_stream -> recv_async_msg(async_md, 0.1))
+                        {
+                            if (transmitter_stopped())
+                            {
+                                return;
+                            }
+                            continue;
+                        }
+
+                        //report the event before counting it so that wait_for_completion()
+                        //returns after the final event has been reported
+                        switch (async_md.event_code) {
+                            case uhd::async_metadata_t::EVENT_CODE_BURST_ACK:
+                                dispatch_event(burst_ack_callback, async_md, num_acks);
+                                break;
+
+                            case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW:
+                            case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET:
+                                dispatch_event(underflow_callback, async_md, num_underflows);
+                                break;
+
+                            case uhd::async_metadata_t::EVENT_CODE_TIME_ERROR:
+                                dispatch_event(late_callback, async_md, num_late);
+                                break;
+
+                            default:
+                                dispatch_event(other_event_callback, async_md, num_other_events);
+                                break;
+                        }
+                    }
+                }
+
+                /**
+                 * @brief call an event's callback (if set) and then count the event
+                 *
+                 * @param callback the callback for the event type
+                 * @param async_md the async event
+                 * @param event_count the counter for the event type
+                 */
+                void dispatch_event(async_callback_t & callback,
+                                    const uhd::async_metadata_t & async_md,
+                                    size_t & event_count){
+                    if (callback)
+                    {
+                        callback(async_md);
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(queue_mutex);
+                        event_count += 1;
+                    }
+                    idle_cv.notify_all();
+                }
+
+                /**
+                 * @brief check if the transmit thread has exited
+                 *
+                 * @return true - the engine is stopping and every queued burst has been sent
+                 * @return false - bursts may still be sent
+                 */
+                bool transmitter_stopped(void){
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    return stop_requested.load() && burst_queue.empty() && (! sending);
+                }
+        };
+    }
+#endif
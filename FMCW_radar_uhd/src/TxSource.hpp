@@ -0,0 +1,157 @@
+#ifndef TXSOURCE
+#define TXSOURCE
+    //C standard libraries
+    #include <iostream>
+    #include <cstdlib>
+    #include <string>
+    #include <complex>
+    #include <vector>
+    #include <algorithm>
+
+    //user generated header files
+    #include "BufferHandler.hpp"
+
+    using Buffers::Buffer_2D;
+
+    namespace TxSource_namespace {
+
+        /**
+         * @brief A source of samples for a tx burst. The transmit engine sends a burst as
+         * a series of send() calls, asking the source for a pointer to the contiguous samples
+         * for each call, so sources can hand out their samples by reference rather than having
+         * the whole burst materialized in a buffer
+         *
+         * @tparam data_type the cpu_format used for the USRP device, will be std::complex<data_type>
+         */
+        template<typename data_type>
+        class TxSource {
+            public:
+                virtual ~TxSource() {}
+
+                /**
+                 * @brief Get the number of send() calls needed to send a burst
+                 *
+                 */
+                virtual size_t get_num_sends(void) const = 0;
+
+                /**
+                 * @brief Get the samples for a send() call
+                 *
+                 * @param send_idx the index of the send() call within the burst
+                 * @param num_samps set to the number of samples to send
+                 * @return const std::complex<data_type>* pointer to the (contiguous) samples to send
+                 */
+                virtual const std::complex<data_type> * get_send_samples(size_t send_idx, size_t & num_samps) const = 0;
+        };
+
+        /**
+         * @brief A tx source that sends each row of a Buffer_2D in turn (the buffer must remain
+         * valid until every burst using it has been sent)
+         *
+         * @tparam data_type the cpu_format used for the USRP device, will be std::complex<data_type>
+         */
+        template<typename data_type>
+        class BufferTxSource : public TxSource<data_type> {
+            private:
+                Buffer_2D<std::complex<data_type>> * tx_buffer;
+
+            public:
+                /**
+                 * @brief Construct a new BufferTxSource object
+                 *
+                 * @param buffer the buffer of samples to send (each row is a send() call)
+                 */
+                BufferTxSource(Buffer_2D<std::complex<data_type>> * buffer): tx_buffer(buffer) {}
+
+                size_t get_num_sends(void) const{
+                    return tx_buffer -> num_rows;
+                }
+
+                const std::complex<data_type> * get_send_samples(size_t send_idx, size_t & num_samps) const{
+                    num_samps = tx_buffer -> num_cols;
+                    return tx_buffer -> buffer[send_idx].data();
+                }
+        };
+
+        /**
+         * @brief A tx source that repeats a single period (ex: one chirp) for a given number of
+         * periods. Only the period and a copy of its first samples_per_buffer samples (so that a
+         * send() that wraps around the end of the period is still contiguous) are stored, so the
+         * memory needed doesn't depend on the number of periods in a burst
+         *
+         * @tparam data_type the cpu_format used for the USRP device, will be std::complex<data_type>
+         */
+        template<typename data_type>
+        class PeriodicTxSource : public TxSource<data_type> {
+            private:
+                //the period followed by its first samples_per_buffer samples (repeated if the
+                //period is shorter than samples_per_buffer)
+                std::vector<std::complex<data_type>> extended_period;
+                size_t samples_per_period;
+                size_t samples_per_buffer;
+                size_t num_periods;
+                size_t total_samples;
+
+            public:
+                /**
+                 * @brief Construct a new PeriodicTxSource object
+                 *
+                 * @param period the samples for one period
+                 * @param samples_per_buff the maximum number of samples in each send() call
+                 * @param periods the number of periods in each burst
+                 */
+                PeriodicTxSource(const std::vector<std::complex<data_type>> & period,
+                                size_t samples_per_buff,
+                                size_t periods)
+                    : samples_per_period(period.size()),
+                    samples_per_buffer(samples_per_buff),
+                    num_periods(periods),
+                    total_samples(period.size() * periods){
+
+                    if (samples_per_period == 0 || samples_per_buffer == 0)
+                    {
+                        std::cerr << "PeriodicTxSource: period and samples per buffer must be non-zero" << std::endl;
+                        total_samples = 0;
+                        return;
+                    }
+
+                    extended_period.reserve(samples_per_period + samples_per_buffer);
+                    extended_period.insert(extended_period.end(), period.begin(), period.end());
+                    for (size_t i = 0; i < samples_per_buffer; i++)
+                    {
+                        extended_period.push_back(period[i % samples_per_period]);
+                    }
+                }
+
+                size_t get_num_sends(void) const{
+                    if (total_samples == 0)
+                    {
+                        return 0;
+                    }
+                    return (total_samples + samples_per_buffer - 1) / samples_per_buffer;
+                }
+
+                const std::complex<data_type> * get_send_samples(size_t send_idx, size_t & num_samps) const{
+                    size_t start_sample = send_idx * samples_per_buffer;
+                    num_samps = std::min(samples_per_buffer, total_samples - start_sample);
+                    return extended_period.data() + (start_sample % samples_per_period);
+                }
+
+                /**
+                 * @brief Get the number of samples in each burst
+                 *
+                 */
+                size_t get_total_samples(void) const{
+                    return total_samples;
+                }
+
+                /**
+                 * @brief Get the number of samples stored by the source
+                 *
+                 */
+                size_t get_stored_samples(void) const{
+                    return extended_period.size();
+                }
+        };
+    }
+#endif
@@ -11,6 +11,10 @@
     #include <thread>
     #include <mutex>
     #include <stdexcept>
+    #include <algorithm>
+    #include <functional>
+    #include <vector>
+    #include <cstdint>
 
     //uhd specific libraries
     #include <uhd/exception.hpp>
@@ -31,7 +35,15 @@
     #include "uhd/device.hpp"
 
     //user generated header files
+    #include "JSONHandler.hpp"
     #include "BufferHandler.hpp"
+    #include "FrameWriter.hpp"
+    #include "CaptureFile.hpp"
+    #include "SimulatedUSRP.hpp"
+    #include "TxEngine.hpp"
+    #include "TxSource.hpp"
+    #include "Logger.hpp"
+    #include "LatencyMonitor.hpp"
     #include "sensing_subsystem/EnergyDetector.hpp"
     #include "sensing_subsystem/SpectrogramHandler.hpp"
 
@@ -40,6 +52,16 @@
     using Buffers::Buffer_1D;
     using EnergyDetector_namespace::EnergyDetector;
     using SpectrogramHandler_namespace::SpectrogramHandler;
+    using FrameWriter_namespace::FrameWriter;
+    using CaptureFile_namespace::CaptureFileWriter;
+    using CaptureFile_namespace::CaptureFileHeader;
+    using CaptureFile_namespace::CaptureFrameMetadata;
+    using SimulatedUSRP_namespace::SimulatedUSRP;
+    using TxEngine_namespace::TxEngine;
+    using TxSource_namespace::TxSource;
+    using TxSource_namespace::BufferTxSource;
+    using LatencyMonitor_namespace::LatencyMonitor;
+    using LatencyMonitor_namespace::Stage_Clock;
 
     namespace USRPHandler_namespace {
         
@@ -55,21 +77,41 @@
                 //status variables used by streamers
                 bool overflow_detected; //true if no overflow message sent
                 bool rx_first_buffer; //true only on the first rx buffer, for status purposes
-                std::atomic<bool> tx_stream_complete; //for coordination between tx_stream and tx_metadata sream
 
                 //varialbes to track the channels
                 size_t rx_channel;
                 size_t tx_channel;
 
-                //mutex to ensure cout is thread safe
-                std::mutex cout_mutex;
-
                 //debug settings
                 bool simplified_metadata;
 
+                //number of frame slots used to hand rx frames to the file writer thread
+                size_t rx_frame_ring_slots;
+
+                //file writer used by stream_rx_frames (its frame slots are kept between runs)
+                FrameWriter<data_type> rx_frame_writer;
+
+                //persistent transmit thread and async event thread
+                TxEngine<data_type> tx_engine;
+
+                //optional processing applied to each rx frame by the file writer thread
+                typename FrameWriter<data_type>::frame_processor_t rx_frame_processor;
+
+                //optional capture file that rx frames are saved to (instead of the rx buffer's write file)
+                CaptureFileWriter<data_type> rx_capture_file;
+
+                //sc16 rx stream (the energy detector runs on the raw samples while waiting for a chirp,
+                //all other receives are converted to std::complex<data_type> by recv_rx_samples)
+                bool rx_sc16;
+                std::vector<std::complex<int16_t>> rx_sc16_samples;
+
             public:
                 //usrp device
                 uhd::usrp::multi_usrp::sptr usrp;
+
+                //simulated usrp device (used instead of the usrp when simulated is true)
+                bool simulated;
+                std::shared_ptr<SimulatedUSRP<data_type>> simulated_usrp;
                 
                 //timing arguments
                 uhd::time_spec_t rx_stream_start_offset;
@@ -78,7 +120,6 @@
                 uhd::stream_args_t tx_stream_args;
                 uhd::tx_streamer::sptr tx_stream;
                 uhd::tx_metadata_t tx_md;
-                uhd::async_metadata_t tx_async_md;
                 size_t tx_samples_per_buffer;
                 uhd::stream_args_t rx_stream_args;
                 uhd::rx_streamer::sptr rx_stream;
@@ -103,7 +144,20 @@
                 USRPHandler(json & config_file){
                     config = config_file;
                     configure_debug();
+                    configure_rx_frame_writer();
+                    configure_rx_format();
                     init_multi_usrp();
+                    init_tx_engine();
+                }
+
+                /**
+                 * @brief Destroy the USRPHandler object (stops the transmit engine
+                 * and closes the rx capture file)
+                 * 
+                 */
+                ~USRPHandler(){
+                    tx_engine.stop();
+                    rx_capture_file.close();
                 }
 
 
@@ -119,6 +173,43 @@
                     else{
                         std::cerr << "USRPHandler::configure_debug: couldn't find simplified_streamer_metadata in JSON" <<std::endl;
                     }
+
+                    //runtime level of the streaming log statements
+                    if (config["USRPSettings"]["AdditionalSettings"]["log_level"].is_null() == false){
+                        Logger::set_level(config["USRPSettings"]["AdditionalSettings"]["log_level"].get<std::string>());
+                    }
+                }
+
+                /**
+                 * @brief configure the number of frame slots used by stream_rx_frames to
+                 * pass received frames to the file writer thread
+                 * 
+                 */
+                void configure_rx_frame_writer(void){
+                    if (config["USRPSettings"]["AdditionalSettings"]["rx_frame_ring_slots"].is_null() == false){
+                        rx_frame_ring_slots = config["USRPSettings"]["AdditionalSettings"]["rx_frame_ring_slots"].get<size_t>();
+                    }
+                    else{
+                        rx_frame_ring_slots = 4;
+                        std::cerr << "USRPHandler::configure_rx_frame_writer: couldn't find rx_frame_ring_slots in JSON, using " <<
+                                    rx_frame_ring_slots << std::endl;
+                    }
+                }
+
+                /**
+                 * @brief configure the cpu format of the rx stream (sc16 when sc16_chirp_detection
+                 * is enabled, otherwise the cpufmt in the JSON)
+                 * 
+                 */
+                void configure_rx_format(void){
+                    rx_sc16 = false;
+                    if (config["USRPSettings"]["AdditionalSettings"]["sc16_chirp_detection"].is_null() == false){
+                        rx_sc16 = config["USRPSettings"]["AdditionalSettings"]["sc16_chirp_detection"].get<bool>();
+                    }
+                    if (rx_sc16)
+                    {
+                        std::cout << "USRPHandler::configure_rx_format: receiving sc16 samples (sc16 chirp detection)" << std::endl << std::endl;
+                    }
                 }
 
                 /**
@@ -466,62 +557,119 @@
                 }
 
                 /**
-                 * @brief Check if the clocking freference is locked correctly
+                 * @brief Poll the LO (and the mimo/external reference) lock sensors until they are all
+                 * locked, using the setup_time as the deadline instead of always waiting for it. Falls back
+                 * to waiting for the full setup time when the lock check is skipped or the device has no
+                 * lock sensors to poll
                  * 
                  */
-                void check_lo_locked(void){
-                    if(config["USRPSettings"]["AdditionalSettings"]["skip-lo"].get<bool>() == false){
-                        // Check Ref and LO Lock detect
-                        if(config["USRPSettings"]["Multi-USRP"]["ref"].is_null() == false){
-                            std::string ref = config["USRPSettings"]["Multi-USRP"]["ref"].get<std::string>();
-                            
-                            //check Tx sensor
-                            std::vector<std::string> sensor_names;
-                            sensor_names = usrp->get_tx_sensor_names(0);
-                            if (std::find(sensor_names.begin(), sensor_names.end(), "lo_locked")
-                                != sensor_names.end()) {
-                                uhd::sensor_value_t lo_locked = usrp->get_tx_sensor("lo_locked", 0);
-                                std::cout << "USRPHandler::check_lo_locked: Checking TX: " << lo_locked.to_pp_string()
-                                        << std::endl;
-                                UHD_ASSERT_THROW(lo_locked.to_bool());
-                            }
-
-                            //checking Rx sensor
-                            sensor_names = usrp->get_rx_sensor_names(0);
-                            if (std::find(sensor_names.begin(), sensor_names.end(), "lo_locked")
-                                != sensor_names.end()) {
-                                uhd::sensor_value_t lo_locked = usrp->get_rx_sensor("lo_locked", 0);
-                                std::cout << "USRPHandler::check_lo_locked: Checking RX: " << lo_locked.to_pp_string()
-                                        << std::endl;
-                                UHD_ASSERT_THROW(lo_locked.to_bool());
-                            }
+                void wait_for_lo_locked(void){
+                    if(config["USRPSettings"]["AdditionalSettings"]["skip-lo"].get<bool>() == true){
+                        std::cout << "USRPHandler::wait_for_lo_locked: skipping lo-locked check\n\n";
+                        wait_for_setup_time();
+                        return;
+                    }
+                    if(config["USRPSettings"]["Multi-USRP"]["ref"].is_null()){
+                        std::cout << "USRPHandler::wait_for_lo_locked: ref is not defined in JSON\n\n";
+                        wait_for_setup_time();
+                        return;
+                    }
+                    std::string ref = config["USRPSettings"]["Multi-USRP"]["ref"].get<std::string>();
+
+                    //determine the sensors to poll
+                    std::vector<std::string> sensor_names;
+                    sensor_names = usrp->get_tx_sensor_names(0);
+                    bool poll_tx_lo = std::find(sensor_names.begin(), sensor_names.end(), "lo_locked") != sensor_names.end();
+                    sensor_names = usrp->get_rx_sensor_names(0);
+                    bool poll_rx_lo = std::find(sensor_names.begin(), sensor_names.end(), "lo_locked") != sensor_names.end();
+                    sensor_names = usrp->get_mboard_sensor_names(0);
+                    bool poll_mimo = (ref == "mimo") &&
+                        (std::find(sensor_names.begin(), sensor_names.end(), "mimo_locked") != sensor_names.end());
+                    bool poll_ref = (ref == "external") &&
+                        (std::find(sensor_names.begin(), sensor_names.end(), "ref_locked") != sensor_names.end());
+
+                    if (! (poll_tx_lo || poll_rx_lo || poll_mimo || poll_ref))
+                    {
+                        std::cout << "USRPHandler::wait_for_lo_locked: no lock sensors found" << std::endl;
+                        wait_for_setup_time();
+                        return;
+                    }
 
-                            //checking for mimo or external references
-                            sensor_names = usrp->get_mboard_sensor_names(0);
-                            if ((ref == "mimo")
-                                and (std::find(sensor_names.begin(), sensor_names.end(), "mimo_locked")
-                                    != sensor_names.end())) {
-                                uhd::sensor_value_t mimo_locked = usrp->get_mboard_sensor("mimo_locked", 0);
-                                std::cout << boost::format("USRPHandler::check_lo_locked:Checking MIMO: %s ...") % mimo_locked.to_pp_string()
-                                        << std::endl;
-                                UHD_ASSERT_THROW(mimo_locked.to_bool());
-                            }
-                            if ((ref == "external")
-                                and (std::find(sensor_names.begin(), sensor_names.end(), "ref_locked")
-                                    != sensor_names.end())) {
-                                uhd::sensor_value_t ref_locked = usrp->get_mboard_sensor("ref_locked", 0);
-                                std::cout << boost::format("USRPHandler::check_lo_locked:Checking External: %s ...") % ref_locked.to_pp_string()
-                                        << std::endl;
-                                UHD_ASSERT_THROW(ref_locked.to_bool());
-                            }
+                    //determine the deadline and the polling interval
+                    double setup_time = 1.0;
+                    if (config["USRPSettings"]["AdditionalSettings"]["setup_time"].is_null() == false){
+                        setup_time = config["USRPSettings"]["AdditionalSettings"]["setup_time"].get<double>();
+                    }
+                    double poll_interval_ms = 5.0;
+                    if (config["USRPSettings"]["AdditionalSettings"]["lock_poll_interval_ms"].is_null() == false){
+                        poll_interval_ms = config["USRPSettings"]["AdditionalSettings"]["lock_poll_interval_ms"].get<double>();
+                    }
+                    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                    std::chrono::steady_clock::time_point deadline = start +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(setup_time));
+
+                    //poll until every sensor is locked or the deadline passes
+                    uhd::sensor_value_t tx_lo_locked("lo_locked", false, "locked", "unlocked");
+                    uhd::sensor_value_t rx_lo_locked("lo_locked", false, "locked", "unlocked");
+                    uhd::sensor_value_t mimo_locked("mimo_locked", false, "locked", "unlocked");
+                    uhd::sensor_value_t ref_locked("ref_locked", false, "locked", "unlocked");
+                    bool all_locked = false;
+                    while (true)
+                    {
+                        if (poll_tx_lo)
+                        {
+                            tx_lo_locked = usrp->get_tx_sensor("lo_locked", 0);
                         }
-                        else{
-                            std::cout << "USRPHandler::check_lo_locked: ref is not defined in JSON\n\n";
+                        if (poll_rx_lo)
+                        {
+                            rx_lo_locked = usrp->get_rx_sensor("lo_locked", 0);
                         }
+                        if (poll_mimo)
+                        {
+                            mimo_locked = usrp->get_mboard_sensor("mimo_locked", 0);
+                        }
+                        if (poll_ref)
+                        {
+                            ref_locked = usrp->get_mboard_sensor("ref_locked", 0);
+                        }
+                        all_locked = ((! poll_tx_lo) || tx_lo_locked.to_bool()) &&
+                                    ((! poll_rx_lo) || rx_lo_locked.to_bool()) &&
+                                    ((! poll_mimo) || mimo_locked.to_bool()) &&
+                                    ((! poll_ref) || ref_locked.to_bool());
+
+                        if (all_locked || std::chrono::steady_clock::now() >= deadline)
+                        {
+                            break;
+                        }
+                        std::this_thread::sleep_for(std::chrono::duration<double,std::milli>(poll_interval_ms));
                     }
-                    else{
-                        std::cout << "USRPHandler::check_lo_locked: skipping lo-locked check\n\n";
+
+                    std::cout << "USRPHandler::wait_for_lo_locked: " << (all_locked ? "locked" : "timed out") << " after " <<
+                                std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - start).count() <<
+                                " ms (deadline: " << setup_time * 1000 << " ms)" << std::endl;
+                    if (poll_tx_lo)
+                    {
+                        std::cout << "USRPHandler::wait_for_lo_locked: Checking TX: " << tx_lo_locked.to_pp_string() << std::endl;
+                        UHD_ASSERT_THROW(tx_lo_locked.to_bool());
                     }
+                    if (poll_rx_lo)
+                    {
+                        std::cout << "USRPHandler::wait_for_lo_locked: Checking RX: " << rx_lo_locked.to_pp_string() << std::endl;
+                        UHD_ASSERT_THROW(rx_lo_locked.to_bool());
+                    }
+                    if (poll_mimo)
+                    {
+                        std::cout << boost::format("USRPHandler::wait_for_lo_locked: Checking MIMO: %s ...") % mimo_locked.to_pp_string()
+                                << std::endl;
+                        UHD_ASSERT_THROW(mimo_locked.to_bool());
+                    }
+                    if (poll_ref)
+                    {
+                        std::cout << boost::format("USRPHandler::wait_for_lo_locked: Checking External: %s ...") % ref_locked.to_pp_string()
+                                << std::endl;
+                        UHD_ASSERT_THROW(ref_locked.to_bool());
+                    }
+                    std::cout << std::endl;
                 }
 
                 /**
@@ -553,8 +701,18 @@
                  * 
                  */
                 void init_multi_usrp(void){
+                    //use a simulated device if one is enabled
+                    if (check_simulated_usrp())
+                    {
+                        init_simulated_usrp();
+                        return;
+                    }
+
+                    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
                     //create USRP device
                     create_USRP_device();
+                    std::chrono::steady_clock::time_point device_created = std::chrono::steady_clock::now();
                     
                     //set clock reference
                     set_ref();
@@ -577,11 +735,11 @@
                     //set the Tx and Rx antennas
                     set_antennas();
 
-                    //wait for the specified setup time
-                    wait_for_setup_time();
+                    std::chrono::steady_clock::time_point configured = std::chrono::steady_clock::now();
 
-                    //check to confirm that the LO is locked
-                    check_lo_locked();
+                    //wait for the LO to lock (at most the specified setup time)
+                    wait_for_lo_locked();
+                    std::chrono::steady_clock::time_point locked = std::chrono::steady_clock::now();
 
                     //initialize the rx timing offset
                     init_Rx_timing_offset(); 
@@ -591,8 +749,210 @@
                     
                     //initialize the stream arguments
                     init_stream_args();
+                    std::chrono::steady_clock::time_point streams_created = std::chrono::steady_clock::now();
+
+                    std::cout << "USRPHandler::init_multi_usrp: startup times: create device: " <<
+                                std::chrono::duration<double,std::milli>(device_created - start).count() << " ms, configure: " <<
+                                std::chrono::duration<double,std::milli>(configured - device_created).count() << " ms, lock: " <<
+                                std::chrono::duration<double,std::milli>(locked - configured).count() << " ms, streams: " <<
+                                std::chrono::duration<double,std::milli>(streams_created - locked).count() << " ms (total: " <<
+                                std::chrono::duration<double,std::milli>(streams_created - start).count() << " ms)" << std::endl << std::endl;
                 }      
 
+                /**
+                 * @brief Apply an updated configuration to the initialized device, only changing
+                 * the settings that differ from the current configuration (center frequency/LO offset,
+                 * gains, IF filter bandwidth, and the rx stream offset). The device is retuned in
+                 * place and the LO lock is re-checked after a retune. Other settings (ex: the device,
+                 * sampling rate, or streamer settings) require a new USRPHandler
+                 * 
+                 * @param new_config the updated json configuration object
+                 */
+                void update_config(const json & new_config){
+                    std::vector<std::string> changed = JSONHandler::changed_settings(config, new_config);
+                    config = new_config;
+                    if (changed.empty())
+                    {
+                        return;
+                    }
+
+                    if (! simulated)
+                    {
+                        bool retuned = false;
+                        if (JSONHandler::setting_changed(changed, "/USRPSettings/Multi-USRP/center_freq") ||
+                            JSONHandler::setting_changed(changed, "/USRPSettings/Multi-USRP/lo-offset"))
+                        {
+                            set_center_frequency();
+                            retuned = true;
+                        }
+                        if (JSONHandler::setting_changed(changed, "/USRPSettings/RX/gain") ||
+                            JSONHandler::setting_changed(changed, "/USRPSettings/TX/gain"))
+                        {
+                            set_rf_gain();
+                        }
+                        if (JSONHandler::setting_changed(changed, "/USRPSettings/Multi-USRP/IF_filter_bw"))
+                        {
+                            set_if_filter_bw();
+                        }
+                        if (retuned)
+                        {
+                            wait_for_lo_locked();
+                        }
+                    }
+
+                    if (JSONHandler::setting_changed(changed, "/USRPSettings/RX/offset_us"))
+                    {
+                        init_Rx_timing_offset();
+                    }
+                }
+
+                /**
+                 * @brief Check the JSON configuration to determine if a simulated USRP
+                 * should be used instead of a USRP device
+                 * 
+                 * @return true - a simulated USRP is enabled
+                 * @return false - a USRP device should be used
+                 */
+                bool check_simulated_usrp(void){
+                    simulated = false;
+                    if (config["SimulatedUSRPSettings"].is_null() == false &&
+                        config["SimulatedUSRPSettings"]["enabled"].is_null() == false)
+                    {
+                        simulated = config["SimulatedUSRPSettings"]["enabled"].get<bool>();
+                    }
+                    return simulated;
+                }
+
+                /**
+                 * @brief Initializes a simulated USRP device and its streamers in place of
+                 * a multi-usrp device (no hardware is required)
+                 * 
+                 */
+                void init_simulated_usrp(void){
+                    std::cout << "USRPHandler::init_simulated_usrp: using a simulated USRP device" << std::endl;
+                    simulated_usrp = std::make_shared<SimulatedUSRP<data_type>>(config);
+
+                    //the simulated device has a single rx and tx channel
+                    rx_channel = 0;
+                    tx_channel = 0;
+
+                    //initialize the rx timing offset
+                    init_Rx_timing_offset();
+
+                    //update the tx/rx enabled status
+                    update_tx_rx_enabled_status();
+
+                    //initialize the streamers
+                    tx_stream = simulated_usrp -> get_tx_stream();
+                    tx_samples_per_buffer = tx_stream -> get_max_num_samps();
+                    rx_stream = simulated_usrp -> get_rx_stream(rx_sc16 ? "sc16" : "fc32");
+                    rx_samples_per_buffer = rx_stream -> get_max_num_samps();
+                    rx_sc16_samples.resize(rx_sc16 ? rx_samples_per_buffer : 0);
+
+                    //print the result
+                    std::cout << "USRPHandler::init_simulated_usrp: tx_spb: " << tx_samples_per_buffer << 
+                        " rx_spb: " << rx_samples_per_buffer <<std::endl;
+                    std::cout << "USRPHandler::init_simulated_usrp: initialized simulated USRP" << std::endl << std::endl;
+                }
+
+                /**
+                 * @brief Get the current device time (from the USRP or the simulated USRP)
+                 * 
+                 * @return uhd::time_spec_t the current device time
+                 */
+                uhd::time_spec_t get_time_now(void){
+                    if (simulated)
+                    {
+                        return simulated_usrp -> get_time_now();
+                    }
+                    return usrp -> get_time_now();
+                }
+
+                /**
+                 * @brief Set the current device time (on the USRP or the simulated USRP)
+                 * 
+                 * @param time_spec the new device time
+                 */
+                void set_time_now(const uhd::time_spec_t & time_spec){
+                    if (simulated)
+                    {
+                        simulated_usrp -> set_time_now(time_spec);
+                    }
+                    else{
+                        usrp -> set_time_now(time_spec);
+                    }
+                }
+
+                /**
+                 * @brief Get the rx sample rate (from the USRP or the simulated USRP)
+                 * 
+                 * @return double the rx sample rate in samples per second
+                 */
+                double get_rx_rate(void){
+                    if (simulated)
+                    {
+                        return simulated_usrp -> get_rx_rate();
+                    }
+                    return usrp -> get_rx_rate(rx_channel);
+                }
+
+                /**
+                 * @brief open a capture file that stream_rx_frames saves frames to (along with
+                 * each frame's time, overflow status, and number of samples received) instead
+                 * of the rx buffer's write file
+                 * 
+                 * @param path the path of the capture file
+                 * @param rx_buffer the buffer that frames will be received into (sets the frame geometry)
+                 * @param samples_per_chirp the number of samples in each chirp
+                 * @param chirps_per_frame the number of chirps in each frame
+                 * @param frame_periodicity_s the frame periodicity in seconds
+                 * @return true - the capture file was opened
+                 * @return false - the capture file couldn't be opened
+                 */
+                bool open_rx_capture_file(std::string path,
+                                        Buffer_2D<std::complex<data_type>> * rx_buffer,
+                                        size_t samples_per_chirp,
+                                        size_t chirps_per_frame,
+                                        double frame_periodicity_s){
+                    CaptureFileHeader header = CaptureFileWriter<data_type>::get_default_header();
+
+                    //radio settings
+                    header.rx_rate = get_rx_rate();
+                    if (simulated)
+                    {
+                        header.tx_rate = simulated_usrp -> get_tx_rate();
+                        header.rx_frequency = config["USRPSettings"]["Multi-USRP"]["center_freq"].get<double>();
+                        header.tx_frequency = header.rx_frequency;
+                        header.rx_gain = config["USRPSettings"]["RX"]["gain"].get<double>();
+                        header.tx_gain = config["USRPSettings"]["TX"]["gain"].get<double>();
+                    }
+                    else{
+                        header.tx_rate = usrp -> get_tx_rate(tx_channel);
+                        header.rx_frequency = usrp -> get_rx_freq(rx_channel);
+                        header.tx_frequency = usrp -> get_tx_freq(tx_channel);
+                        header.rx_gain = usrp -> get_rx_gain(rx_channel);
+                        header.tx_gain = usrp -> get_tx_gain(tx_channel);
+                    }
+
+                    //frame geometry
+                    header.rows_per_frame = rx_buffer -> num_rows;
+                    header.samples_per_row = rx_buffer -> num_cols;
+                    header.excess_samples = rx_buffer -> excess_samples;
+                    header.samples_per_chirp = samples_per_chirp;
+                    header.chirps_per_frame = chirps_per_frame;
+                    header.frame_periodicity_s = frame_periodicity_s;
+
+                    return rx_capture_file.open(path, header);
+                }
+
+                /**
+                 * @brief write the index of the rx capture file and close it (if open)
+                 * 
+                 */
+                void close_rx_capture_file(void){
+                    rx_capture_file.close();
+                }
+
                 void init_Rx_timing_offset(void){
                     //set the rx stream start offset
                         /*NOTE: this was added because on some USRP devices, there appears to
@@ -626,10 +986,11 @@
                     
                     //configure rx stream args
                     std::vector<size_t> rx_channels(1,rx_channel);
-                    rx_stream_args = uhd::stream_args_t(cpu_format,wirefmt);
+                    rx_stream_args = uhd::stream_args_t(rx_sc16 ? "sc16" : cpu_format,wirefmt);
                     rx_stream_args.channels = rx_channels;
                     rx_stream = usrp -> get_rx_stream(rx_stream_args);
                     rx_samples_per_buffer = rx_stream -> get_max_num_samps();
+                    rx_sc16_samples.resize(rx_sc16 ? rx_samples_per_buffer : 0);
 
                     //print the result
                     std::cout << "USRPHandler::init_stream_args: tx_spb: " << tx_samples_per_buffer << 
@@ -637,6 +998,17 @@
                     std::cout << "USRPHandler::init_stream_args: initialized stream arguments" << std::endl << std::endl;
                 }
 
+                /**
+                 * @brief Set a function to process each frame received by stream_rx_frames. Frames
+                 * are processed on the file writer thread (before being saved) so that the receive
+                 * loop is never blocked by the processing
+                 * 
+                 * @param processor the function to call on each received frame
+                 */
+                void set_rx_frame_processor(typename FrameWriter<data_type>::frame_processor_t processor){
+                    rx_frame_processor = processor;
+                }
+
                 /**
                  * @brief Reset the USRP clock to be zero 
                  * 
@@ -644,7 +1016,7 @@
                 void reset_usrp_clock(void){
                     std::cout << "USRPHandler::reset_usrp_clock: setting device timestamp to 0" << 
                                 std::endl << std::endl;
-                    usrp -> set_time_now(uhd::time_spec_t(0.0));
+                    set_time_now(uhd::time_spec_t(0.0));
                     return;
                 }
 
@@ -652,10 +1024,14 @@
         //streaming functions
                 
                 /**
-                 * @brief streams a series of rx frames
+                 * @brief streams a series of rx frames. Received frames are handed to a
+                 * dedicated writer thread through a preallocated ring of frame slots so that
+                 * the receive loop never blocks on the write file
                  * 
                  * @param frame_start_times a vector of uhd::time_spec_t with the start time of each frame
-                 * @param rx_buffer a pointer to a Buffer_2D data type
+                 * @param rx_buffer a pointer to a Buffer_2D data type (its write file stream must already be open
+                 * unless an rx capture file is open). If the ring is full, frames are received into rx_buffer
+                 * and are not saved
                  */
                 void stream_rx_frames(std::vector<uhd::time_spec_t> frame_start_times,
                                     Buffer_2D<std::complex<data_type>> * rx_buffer){
@@ -677,209 +1053,284 @@
                     rx_stream_cmd.num_samps = total_samps;
                     rx_stream_cmd.stream_now = false;
 
+                    //start the file writer thread
+                    rx_frame_writer.set_num_slots(rx_frame_ring_slots);
+                    rx_frame_writer.set_frame_processor(rx_frame_processor);
+                    rx_frame_writer.set_capture_file(rx_capture_file.is_open() ? & rx_capture_file : nullptr);
+                    rx_frame_writer.start(rx_buffer);
+                    Buffer_2D<std::complex<data_type>> * frame_buffer;
+                    CaptureFrameMetadata frame_metadata;
+                    uhd::time_spec_t frame_time;
+
                     for (size_t i = 0; i < num_frames; i++)
                     {
+                        //get a free slot to receive the frame into
+                        frame_buffer = rx_frame_writer.acquire_slot();
+                        if (frame_buffer == nullptr)
+                        {
+                            frame_buffer = rx_buffer;
+                        }
+
                         //set the time spec for the frame start
                         rx_stream_cmd.time_spec = frame_start_times[i] + rx_stream_start_offset;
 
                         //send the stream command
                         rx_stream -> issue_stream_cmd(rx_stream_cmd);
 
+                        //reset the frame metadata (the frame time defaults to the commanded start time)
+                        frame_time = rx_stream_cmd.time_spec;
+                        frame_metadata.frame_number = i;
+                        frame_metadata.overflow = false;
+                        frame_metadata.num_samples_received = 0;
+
                         for (size_t j = 0; j < num_rows; j++)
                         {
                             //receive the data
-                            num_samps_received = rx_stream -> recv(
-                                            &(rx_buffer->buffer[j].front()),
-                                            num_samps_per_buff,rx_md,0.5,true);
+                            num_samps_received = recv_rx_samples(
+                                            &(frame_buffer->buffer[j].front()),
+                                            num_samps_per_buff,0.5,true);
                             
                             //check the metadata to confirm good receive
                             if (num_samps_received != num_samps_per_buff){
-                                std::cerr << "USRPHandler::stream_rx_frame: Tried receiving " << num_samps_per_buff <<
-                                            " samples, but only received " << num_samps_received << std::endl;
+                                LOG_WARNING("USRPHandler::stream_rx_frames: Tried receiving {} samples, but only received {}",
+                                            num_samps_per_buff, num_samps_received);
                             }
                             check_rx_metadata(rx_md);
 
+                            //record the time of the first sample in the frame
+                            if (j == 0 && rx_md.has_time_spec)
+                            {
+                                frame_time = rx_md.time_spec;
+                            }
+                            frame_metadata.num_samples_received += num_samps_received;
+
                             //if an overflow was detected, the frame is bad, save what we had and start a new frame
                             if (overflow_detected){
-                                std::cout << "USRPHandler::stream_rx_frames: Overflow detected on frame " <<
-                                            i + 1 << " cancelling frame and starting again" <<std::endl;
+                                LOG_WARNING("USRPHandler::stream_rx_frames: Overflow detected on frame {} cancelling frame and starting again",
+                                            i + 1);
                                 //reset the overflow tag
                                 overflow_detected = false;
+                                frame_metadata.overflow = true;
                                 break;
                             }
                         }
-                        rx_buffer -> save_to_file();   
+
+                        //hand the frame to the writer thread
+                        if (frame_buffer != rx_buffer)
+                        {
+                            frame_metadata.time_full_secs = frame_time.get_full_secs();
+                            frame_metadata.time_frac_secs = frame_time.get_frac_secs();
+                            rx_frame_writer.commit_slot(frame_metadata);
+                        }
+                        else{
+                            rx_frame_writer.record_dropped_frame();
+                        }
                     }
+
+                    //wait for the remaining frames to be written
+                    rx_frame_writer.stop();
+                    Logger::flush();
+                    rx_frame_writer.print_summary();
                     return;
                 }
 
+                /**
+                 * @brief Receive samples from the rx stream into rx_md. When the rx stream is sc16,
+                 * the samples are received into rx_sc16_samples and converted (scaled by 1/32767 like
+                 * UHD's sc16 to fc32 conversion)
+                 * 
+                 * @param samples pointer to where the samples should be received
+                 * @param num_samps the maximum number of samples to receive
+                 * @param timeout the timeout (in seconds) to wait for the samples
+                 * @param one_packet true to receive at most one packet
+                 * @return size_t the number of samples received
+                 */
+                size_t recv_rx_samples(std::complex<data_type> * samples, size_t num_samps,
+                                        double timeout, bool one_packet){
+                    if (! rx_sc16)
+                    {
+                        return rx_stream -> recv(samples,num_samps,rx_md,timeout,one_packet);
+                    }
+
+                    if (rx_sc16_samples.size() < num_samps)
+                    {
+                        rx_sc16_samples.resize(num_samps);
+                    }
+                    size_t num_samps_received = rx_stream -> recv(
+                                        rx_sc16_samples.data(),num_samps,rx_md,timeout,one_packet);
+                    const data_type scale = static_cast<data_type>(1.0 / 32767.0);
+                    for (size_t i = 0; i < num_samps_received; i++)
+                    {
+                        samples[i] = std::complex<data_type>(
+                            static_cast<data_type>(rx_sc16_samples[i].real()) * scale,
+                            static_cast<data_type>(rx_sc16_samples[i].imag()) * scale);
+                    }
+                    return num_samps_received;
+                }
+
                 /**
                  * @brief 
                  * 
                  * @param rx_md uhd::rx_metadata_t object containing the metadata from a recent Tx stream
                  */
                 void check_rx_metadata(uhd::rx_metadata_t & rx_md){
-                    //create a unique lock for managing outputs using std::cout
-                    std::unique_lock<std::mutex> cout_unique_lock(cout_mutex, std::defer_lock);
-
                     if(rx_first_buffer){
-                        cout_unique_lock.lock();
-                        std::cout << "USRPHandler::check_rx_metadata: start of burst metadata: " << std::endl <<
-                                    rx_md.to_pp_string(simplified_metadata) << std::endl <<std::endl;
+                        if (simplified_metadata)
+                        {
+                            LOG_INFO("USRPHandler::check_rx_metadata: start of burst metadata: time spec: {} s, start of burst: {}, end of burst: {}",
+                                        rx_md.time_spec.get_real_secs(), rx_md.start_of_burst, rx_md.end_of_burst);
+                        }
+                        else{
+                            LOG_INFO("USRPHandler::check_rx_metadata: start of burst metadata: has time spec: {}, time spec: {} s, fragment offset: {}, more fragments: {}, start of burst: {}, end of burst: {}",
+                                        rx_md.has_time_spec, rx_md.time_spec.get_real_secs(), rx_md.fragment_offset,
+                                        rx_md.more_fragments, rx_md.start_of_burst, rx_md.end_of_burst);
+                        }
                         rx_first_buffer = false;
-                        cout_unique_lock.unlock();
                     }
                     if(rx_md.end_of_burst && rx_md.has_time_spec && not simplified_metadata) {
-                        cout_unique_lock.lock();
-                        std::cout << "USRPHandler::check_rx_metadata: end of burst occurred at " <<
-                                    rx_md.time_spec.get_real_secs() << " s" <<std::endl;
-                        cout_unique_lock.unlock();
+                        LOG_INFO("USRPHandler::check_rx_metadata: end of burst occurred at {} s",
+                                    rx_md.time_spec.get_real_secs());
                     }
                     if (rx_md.error_code == uhd::rx_metadata_t::ERROR_CODE_TIMEOUT) {
-                        std::cout << "USRPHandler::check_rx_metadata: Timeout while streaming" << std::endl;
+                        LOG_WARNING("USRPHandler::check_rx_metadata: Timeout while streaming");
                     }
                     if (rx_md.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW) {
                         if (not overflow_detected) {
                             overflow_detected = true;
-                            std::cerr <<    
-                                        "Got an overflow indication. Please consider the following:\n" <<
-                                        "  Your write medium must sustain a rate of " << 
-                                        (usrp->get_rx_rate(rx_channel) * sizeof(std::complex<float>) / 1e6) <<"MB/s.\n" <<
-                                        "  Dropped samples will not be written to the file.\n" <<
-                                        "  Please modify this example for your purposes.\n" <<
-                                        "  This message will not appear again.\n"; 
+                            LOG_ERROR("Got an overflow indication. Please consider the following:\n"
+                                        "  Your write medium must sustain a rate of {}MB/s.\n"
+                                        "  Dropped samples will not be written to the file.\n"
+                                        "  Please modify this example for your purposes.\n"
+                                        "  This message will not appear again.",
+                                        get_rx_rate() * sizeof(std::complex<float>) / 1e6);
                         }
                     }
                     if (rx_md.error_code != uhd::rx_metadata_t::ERROR_CODE_NONE) {
-                        std::stringstream error;
-                        error << "USRPHandler::check_rx_metadata: Receiver error: " << rx_md.strerror();
-                        std::cerr << error.str() << std::endl;
+                        LOG_ERROR("USRPHandler::check_rx_metadata: Receiver error: {} (error code: {})",
+                                    rx_error_name(rx_md.error_code), static_cast<int>(rx_md.error_code));
                     }
                     return;
                 }
 
                 /**
-                 * @brief stream a series of tx frames
+                 * @brief get the name of an rx error code (a string literal so that it can be logged
+                 * from the streaming loops)
+                 * 
+                 * @param error_code the error code from a uhd::rx_metadata_t
+                 * @return const char* the name of the error
+                 */
+                static const char * rx_error_name(uhd::rx_metadata_t::error_code_t error_code){
+                    switch (error_code) {
+                        case uhd::rx_metadata_t::ERROR_CODE_NONE:
+                            return "none";
+                        case uhd::rx_metadata_t::ERROR_CODE_TIMEOUT:
+                            return "timeout";
+                        case uhd::rx_metadata_t::ERROR_CODE_LATE_COMMAND:
+                            return "late command";
+                        case uhd::rx_metadata_t::ERROR_CODE_BROKEN_CHAIN:
+                            return "broken chain";
+                        case uhd::rx_metadata_t::ERROR_CODE_OVERFLOW:
+                            return "overflow";
+                        case uhd::rx_metadata_t::ERROR_CODE_ALIGNMENT:
+                            return "alignment";
+                        case uhd::rx_metadata_t::ERROR_CODE_BAD_PACKET:
+                            return "bad packet";
+                        default:
+                            return "unknown";
+                    }
+                }
+
+                /**
+                 * @brief start the transmit engine and register the handlers for its
+                 * async events (burst ACKs, underflows, late bursts, and other events)
+                 * 
+                 */
+                void init_tx_engine(void){
+                    tx_engine.set_callbacks(
+                        [this](const uhd::async_metadata_t & async_md) {
+                            if (async_md.has_time_spec && not simplified_metadata){
+                                LOG_INFO("USRPHandler::tx_engine: end of burst occurred at {} s",
+                                        async_md.time_spec.get_real_secs());
+                            }
+                        },
+                        [](const uhd::async_metadata_t & async_md) {
+                            LOG_WARNING("USRPHandler::tx_engine: Underflow Detected at {} s",
+                                    async_md.time_spec.get_real_secs());
+                        },
+                        [](const uhd::async_metadata_t & async_md) {
+                            LOG_WARNING("USRPHandler::tx_engine: Late burst (start time had passed) detected at {} s",
+                                    async_md.time_spec.get_real_secs());
+                        },
+                        [](const uhd::async_metadata_t & async_md) {
+                            if (async_md.event_code == uhd::async_metadata_t::EVENT_CODE_SEQ_ERROR ||
+                                async_md.event_code == uhd::async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST)
+                            {
+                                LOG_ERROR("USRPHandler::tx_engine: Packet Loss Detected");
+                            }
+                            else{
+                                LOG_ERROR("USRPHandler::tx_engine: Event code: {}, unexpected event on async recv, continuing...",
+                                        static_cast<int>(async_md.event_code));
+                            }
+                        });
+                    tx_engine.start(tx_stream);
+                }
+
+                /**
+                 * @brief queue a series of tx frames on the transmit engine (returns immediately)
                  * 
                  * @param frame_start_times a vector of uhd::time_spec_t with the start time for each framne
                  * @param tx_buffer a Buffer_2D that will be used to stream the chirps for each frame
+                 * (must remain valid until the frames have been sent)
                  */
-                void stream_tx_frames(std::vector<uhd::time_spec_t> frame_start_times,
+                void submit_tx_frames(const std::vector<uhd::time_spec_t> & frame_start_times,
                                         Buffer_2D<std::complex<data_type>> * tx_buffer){
-                    //create a unique lock for managing outputs using std::cout
-                    std::unique_lock<std::mutex> cout_unique_lock(cout_mutex, std::defer_lock);
-                    
-                    //determine the number of samples to be streamed in the frame
-                    size_t num_samps_per_buff = tx_buffer -> num_cols;
-                    size_t num_rows = tx_buffer -> num_rows;
-                    size_t total_samps = num_samps_per_buff * num_rows;
-                    size_t num_samps_sent;
-
-                    //determine the number of frames to stream
-                    size_t num_frames = frame_start_times.size();
+                    submit_tx_frames(frame_start_times, std::make_shared<BufferTxSource<data_type>>(tx_buffer));
+                }
 
-                    cout_unique_lock.lock();
-                    std::cout << "USRPHandler::stream_tx_frame: streaming frame starting at : " <<
-                                frame_start_times[0].get_real_secs() << " s" << std::endl;
-                    cout_unique_lock.unlock();
+                /**
+                 * @brief queue a series of tx frames on the transmit engine (returns immediately)
+                 * 
+                 * @param frame_start_times a vector of uhd::time_spec_t with the start time for each framne
+                 * @param tx_source the source of the samples to stream for each frame
+                 */
+                void submit_tx_frames(const std::vector<uhd::time_spec_t> & frame_start_times,
+                                        std::shared_ptr<const TxSource<data_type>> tx_source){
+                    if (frame_start_times.empty())
+                    {
+                        return;
+                    }
 
-                    //stream desired number of frames
-                    for (size_t i = 0; i < num_frames; i++)
+                    if (simplified_metadata)
                     {
-                        //initialize the metadata
-                        tx_md.has_time_spec = true;
-                        tx_md.time_spec = frame_start_times[i];
-                        tx_md.start_of_burst = false;
-                        tx_md.end_of_burst = false;
+                        LOG_INFO("USRPHandler::submit_tx_frames: streaming frame starting at : {} s",
+                                    frame_start_times[0].get_real_secs());
+                    }
 
-                        if (not simplified_metadata && i > 0)
-                        {
-                            cout_unique_lock.lock();
-                            std::cout << "USRPHandler::stream_tx_frame: streaming frame starting at : " <<
-                                        tx_md.time_spec.get_real_secs() << " s" << std::endl;
-                            cout_unique_lock.unlock();
-                        }
-                        
-                        //stream the desired number of chirps
-                        for (size_t j = 0; j < num_rows; j++)
+                    for (size_t i = 0; i < frame_start_times.size(); i++)
+                    {
+                        if (not simplified_metadata)
                         {
-                            num_samps_sent = tx_stream -> send(
-                                        &(tx_buffer -> buffer[j].front()),
-                                        num_samps_per_buff,
-                                        tx_md,0.5);
-                            
-                            tx_md.start_of_burst = false;
-                            tx_md.has_time_spec = false;
-
-                            //confirm that sent correct amount of samples
-                            if (num_samps_sent != num_samps_per_buff){
-                                std::cerr << "USRPHandler::stream_tx_frame: Tried sending " << num_samps_per_buff <<
-                                            " samples, but only sent " << num_samps_sent << std::endl;
-                            }
+                            LOG_INFO("USRPHandler::submit_tx_frames: streaming frame starting at : {} s",
+                                        frame_start_times[i].get_real_secs());
                         }
-
-                        // send a mini EOB packet
-                        tx_md.end_of_burst = true;
-                        tx_stream->send("", 0, tx_md);
-
+                        tx_engine.submit_burst(tx_source, frame_start_times[i]);
                     }
-                    tx_stream_complete = true;
                 }
 
                 /**
-                 * @brief Tx Metadata messages are delivered asynchronously 
-                 * and as such have to be processed separately
+                 * @brief wait for the transmit engine to send every queued frame and for the
+                 * device to report the outcome of each frame
                  * 
                  */
-                void check_tx_async_messages(void){
-                    //create a unique lock for managing outputs using std::cout
-                    std::unique_lock<std::mutex> cout_unique_lock(cout_mutex, std::defer_lock);
-                    
-                    bool exit_flag = false;
-                    while (true) {
-                        if (tx_stream_complete) {
-                            exit_flag = true;
-                        }
-
-                        if (not tx_stream->recv_async_msg(tx_async_md)) {
-                            if (exit_flag == true){
-                                cout_unique_lock.lock();
-                                std::cout << "USRPHandler::check_tx_async_messages: exiting async handler due to exit flag" <<std::endl;
-                                cout_unique_lock.unlock();
-                                return;
-                            }
-                            continue;
-                        }
-
-                        // handle the error codes
-                        switch (tx_async_md.event_code) {
-                            case uhd::async_metadata_t::EVENT_CODE_BURST_ACK:
-                                //std::cout << "USRPHandler::check_tx_async_messages: exiting async handler due to end of burst" <<std::endl;
-                                if (tx_async_md.has_time_spec && not simplified_metadata){
-                                    cout_unique_lock.lock();
-                                    std::cout << "USRPHandler::check_tx_async_messages: end of burst occurred at " <<
-                                            tx_async_md.time_spec.get_real_secs() << " s" << std::endl;
-                                    cout_unique_lock.unlock();
-                                }
-                                continue;
-                                //return;
-
-                            case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW:
-                            case uhd::async_metadata_t::EVENT_CODE_UNDERFLOW_IN_PACKET:
-                                std::cerr << "USRPHandler::check_tx_async_messages: Underflow Detected" << std::endl;
-                                break;
-
-                            case uhd::async_metadata_t::EVENT_CODE_SEQ_ERROR:
-                            case uhd::async_metadata_t::EVENT_CODE_SEQ_ERROR_IN_BURST:
-                                std::cerr << "USRPHandler::check_tx_async_messages: Packet Loss Detected" << std::endl;
-                                break;
-
-                            default:
-                                std::cerr <<  "USRPHandler::check_tx_async_messages: Event code: " << tx_async_md.event_code
-                                        << std::endl;
-                                std::cerr << "Unexpected event on async recv, continuing..." << std::endl;
-                                break;
-                        }
+                void wait_for_tx_frames(void){
+                    if (! tx_engine.wait_for_completion())
+                    {
+                        LOG_WARNING("USRPHandler::wait_for_tx_frames: timed out waiting for burst ACKs");
+                    }
+                    if (not simplified_metadata)
+                    {
+                        Logger::flush();
+                        tx_engine.print_summary();
                     }
                 }
 
@@ -893,31 +1344,43 @@
                 void stream_frames(std::vector<uhd::time_spec_t> frame_start_times,
                                     Buffer_2D<std::complex<data_type>> * tx_buffer,
                                     Buffer_2D<std::complex<data_type>> * rx_buffer){
+                    stream_frames(frame_start_times, std::make_shared<BufferTxSource<data_type>>(tx_buffer), rx_buffer);
+                }
+
+                /**
+                 * @brief Stream a series of rx and tx frames depending on the config
+                 * 
+                 * @param frame_start_times a vector of start times for each frame
+                 * @param tx_source the source of the samples to transmit for each frame
+                 * @param rx_buffer a pointer to a buffer to save the received signal for each frame and to save to a file
+                 */
+                void stream_frames(std::vector<uhd::time_spec_t> frame_start_times,
+                                    std::shared_ptr<const TxSource<data_type>> tx_source,
+                                    Buffer_2D<std::complex<data_type>> * rx_buffer){
                     //set the start time
                     reset_usrp_clock();
 
                     if (tx_enabled && rx_enabled)
                     {
-                        //create transmit thread
-                        std::thread transmit_thread([&]() {
-                            stream_frames_tx_only(frame_start_times,tx_buffer,false);
-                        });
+                        //queue the tx frames on the transmit engine
+                        submit_tx_frames(frame_start_times,tx_source);
 
                         //stream rx_frames
                         stream_frames_rx_only(frame_start_times,rx_buffer,false);
 
-                        //wait for transmit thread to finish
-                        transmit_thread.join();
+                        //wait for the transmit engine to finish
+                        wait_for_tx_frames();
                     }
                     else if (tx_enabled)
                     {
-                        stream_frames_tx_only(frame_start_times,tx_buffer,false);
+                        stream_frames_tx_only(frame_start_times,tx_source,false);
                     }
                     else
                     {
                         //stream rx_frames
                         stream_frames_rx_only(frame_start_times,rx_buffer,false);
                     }
+                    Logger::flush();
                     std::cout << "USRPHandler::stream_frame: Complete" << std::endl << std::endl;
                 }
 
@@ -931,22 +1394,28 @@
                 void stream_frames_tx_only(std::vector<uhd::time_spec_t> frame_start_times,
                                             Buffer_2D<std::complex<data_type>> * tx_buffer,
                                             bool reset_clock = false){
+                    stream_frames_tx_only(frame_start_times, std::make_shared<BufferTxSource<data_type>>(tx_buffer), reset_clock);
+                }
+
+                /**
+                 * @brief only run a transmit stream
+                 * 
+                 * @param frame_start_times a vector of uhd::time_spec_t's with the start time for each frame
+                 * @param tx_source the source of the samples to transmit for each frame
+                 * @param reset_clock (on true) reset the USRP clock (defaults to false)
+                 */
+                void stream_frames_tx_only(std::vector<uhd::time_spec_t> frame_start_times,
+                                            std::shared_ptr<const TxSource<data_type>> tx_source,
+                                            bool reset_clock = false){
                     //set the start time
                     if (reset_clock)
                     {
                         reset_usrp_clock();
                     }
                    
-                    //create transmit thread
-                    tx_stream_complete = false;
-                    std::thread transmit_thread([&]() {
-                        stream_tx_frames(frame_start_times,tx_buffer);
-                    });
-
-                    //create transmit async handler
-                    check_tx_async_messages();
-                    //wait for transmit thread to finish
-                    transmit_thread.join();
+                    //queue the frames on the transmit engine and wait for them to be sent
+                    submit_tx_frames(frame_start_times,tx_source);
+                    wait_for_tx_frames();
                 }
 
                 /**
@@ -983,7 +1452,7 @@
                     size_t num_samps_per_buff = rx_buffer -> num_samples;
                     
                     //compute the number of samples to stream
-                    double sample_rate = usrp -> get_rx_rate(rx_channel);
+                    double sample_rate = get_rx_rate();
                     size_t total_samps = static_cast<size_t>(ceil(
                                             sample_rate * stream_time_s));
                     
@@ -1017,20 +1486,20 @@
                         }
                         
                         //receive the data
-                        num_samps_received = rx_stream -> recv(
+                        num_samps_received = recv_rx_samples(
                                         &(rx_buffer->buffer.front()),
-                                        num_samps_per_buff,rx_md,0.5,true);
+                                        num_samps_per_buff,0.5,true);
                         
                         //check the metadata to confirm good receive
                         if (num_samps_received != expected_samps_to_receive){
-                            std::cerr << "USRPHandler::rx_stream_to_file: Tried receiving " << expected_samps_to_receive <<
-                                        " samples, but only received " << num_samps_received << std::endl;
+                            LOG_WARNING("USRPHandler::rx_stream_to_file: Tried receiving {} samples, but only received {}",
+                                        expected_samps_to_receive, num_samps_received);
                         }
                         check_rx_metadata(rx_md);
 
                         //if an overflow was detected, the frame is bad, save what we had and start a new frame
                         if (overflow_detected){
-                            std::cout << "USRPHandler::rx_stream_to_file: Overflow detected " << std::endl;
+                            LOG_WARNING("USRPHandler::rx_stream_to_file: Overflow detected");
                             //reset the overflow tag
                             overflow_detected = false;
                             break;
@@ -1082,20 +1551,20 @@
                     for (size_t i = 0; i < rx_buffer -> num_rows; i++)
                     {
                         //receive the data
-                        num_samps_received = rx_stream -> recv(
+                        num_samps_received = recv_rx_samples(
                                         &(rx_buffer->buffer[i].front()),
-                                        num_samps_per_buff,rx_md,0.5,true);
+                                        num_samps_per_buff,0.5,true);
                         
                         //check the metadata to confirm good receive
                         if (num_samps_received != expected_samps_to_receive){
-                            std::cerr << "USRPHandler::rx_stream_to_buffer: Tried receiving " << expected_samps_to_receive <<
-                                        " samples, but only received " << num_samps_received << std::endl;
+                            LOG_WARNING("USRPHandler::rx_stream_to_buffer: Tried receiving {} samples, but only received {}",
+                                        expected_samps_to_receive, num_samps_received);
                         }
                         check_rx_metadata(rx_md);
 
                         //if an overflow was detected, the frame is bad, save what we had and start a new frame
                         if (overflow_detected){
-                            std::cout << "USRPHandler::rx_stream_to_buffer: Overflow detected " << std::endl;
+                            LOG_WARNING("USRPHandler::rx_stream_to_buffer: Overflow detected");
                             //reset the overflow tag
                             overflow_detected = false;
                             break;
@@ -1105,33 +1574,47 @@
                 }
 
                 /**
-                 * @brief Saves a continuous stream of samples until a given 2D buffer has been filled
+                 * @brief Waits for the energy detector to detect a chirp and then saves a continuous
+                 * stream of samples (starting at the detection) until a given 2D buffer has been filled
                  * 
-                 * @param sensing_subsystem the sensing subsystem object
+                 * @param rx_buffer the buffer to record the frame into (the spectrogram handler's rx_buffer
+                 * or a buffer with the same dimensions)
+                 * @param energy_detector the energy detector to use to detect the start of the frame
+                 * @param stream_start_time the time to start listening for the frame at
+                 * @param samples_received_callback (optional) called with the number of samples
+                 * recorded into the rx_buffer so far, once when the frame is detected and then after every recv
+                 * @param latency_monitor (optional) latency monitor to record the recv waits and chirp detection in
                  */
-                void rx_record_next_frame(SpectrogramHandler<data_type> * spectrogram_handler,
+                void rx_record_next_frame(Buffer_2D<std::complex<data_type>> * rx_buffer,
                                             EnergyDetector<data_type> * energy_detector,
-                                            double stream_start_time){
+                                            double stream_start_time,
+                                            std::function<void(size_t)> samples_received_callback = nullptr,
+                                            LatencyMonitor * latency_monitor = nullptr){
                     
                     
                     //determine the number of samples per buffer
-                    size_t num_samps_per_buff = spectrogram_handler -> rx_buffer.num_cols;
+                    size_t num_samps_per_buff = rx_buffer -> num_cols;
 
                     //determine number of rows in the rx buffer
-                    size_t num_rows = spectrogram_handler -> rx_buffer.num_rows;
+                    size_t num_rows = rx_buffer -> num_rows;
 
-                    //set the number of rows for energy detection (i.e: the number of rows prior to a chirp detection)
-                    size_t num_energy_detection_rows = energy_detector -> num_rows_chirp_detector;
-                    
-                    //compute the number of samples to stream after a chirp is detected
-                    size_t total_samps = num_samps_per_buff * (num_rows - num_energy_detection_rows);
+                    //total number of samples to record for the frame
+                    size_t num_frame_samps = num_samps_per_buff * num_rows;
+
+                    //the sc16 chirp detector can only be filled by an sc16 rx stream
+                    if (energy_detector -> sc16_chirp_detection && (! rx_sc16))
+                    {
+                        std::cerr << "USRPHandler::rx_record_next_frame: the energy detector uses sc16 chirp detection " <<
+                                    "but the rx stream isn't sc16 (set sc16_chirp_detection for the USRP too)" << std::endl;
+                        return;
+                    }
 
                     //reset the overflow message
                     overflow_detected = false;
                     rx_first_buffer = true;
 
                     //initialize the stream command
-                    double current_time = usrp -> get_time_now().get_real_secs();
+                    double current_time = get_time_now().get_real_secs();
                     //uhd::stream_cmd_t rx_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
                     uhd::stream_cmd_t rx_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
                     rx_stream_cmd.num_samps = num_samps_per_buff;
@@ -1156,6 +1639,9 @@
                     size_t current_idx;
                     energy_detector -> reset_chirp_detector();
                     
+                    //time the recv waits and the chirp detection
+                    Stage_Clock clock(latency_monitor);
+
                     //send the stream command
                     rx_stream -> issue_stream_cmd(rx_stream_cmd);
 
@@ -1163,47 +1649,92 @@
                     {
                         //receive the data
                         current_idx = energy_detector -> get_current_chirp_detector_index();
-                        num_samps_received = rx_stream -> recv(
-                                        &(energy_detector->chirp_detector_signal.buffer[current_idx].front()),
+                        clock.restart();
+                        if (energy_detector -> sc16_chirp_detection)
+                        {
+                            //detect the chirp on the raw samples (no conversion while waiting)
+                            num_samps_received = rx_stream -> recv(
+                                        &(energy_detector->chirp_detector_signal_sc16.buffer[current_idx].front()),
                                         num_samps_per_buff,rx_md,0.5,true);
+                        }
+                        else{
+                            num_samps_received = recv_rx_samples(
+                                        &(energy_detector->chirp_detector_signal.buffer[current_idx].front()),
+                                        num_samps_per_buff,0.5,true);
+                        }
+                        clock.lap(LatencyMonitor::recv_wait);
                         
                         //check the metadata to confirm good receive
                         if ((num_samps_received != expected_samps_to_receive) &&
                             (rx_md.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW)){
-                            std::cerr << "USRPHandler::rx_record_next_frame: (overflowed) Tried receiving " << expected_samps_to_receive <<
-                                        " samples when waiting for chirp, but only received " << num_samps_received << std::endl;
+                            LOG_WARNING("USRPHandler::rx_record_next_frame: (overflowed) Tried receiving {} samples when waiting for chirp, but only received {}",
+                                        expected_samps_to_receive, num_samps_received);
                         }
                         check_rx_metadata(rx_md);
                         
                         if(rx_md.time_spec.get_real_secs() <= stream_start_time){
                             continue;
                         }
+
+                        //the sliding window can't span a gap in the samples, so start over after an overflow
+                        if (rx_md.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW)
+                        {
+                            energy_detector -> reset_chirp_detector();
+                            continue;
+                        }
                         
-                        chirp_detected = energy_detector -> check_for_chirp(rx_md.time_spec.get_real_secs());
+                        clock.restart();
+                        chirp_detected = energy_detector -> check_for_chirp(rx_md.time_spec);
+                        clock.lap(LatencyMonitor::detection);
+                    }
+
+                    //save the samples from the start of the detection window through the end of the current buffer
+                    size_t num_samps_saved = energy_detector -> save_chirp_detection_signal_to_buffer(rx_buffer);
+                    if (samples_received_callback)
+                    {
+                        samples_received_callback(num_samps_saved);
                     }
                     
-                    //send a new stream command
-                    std::cout << chirp_detected << std::endl;
+                    //send a new stream command for the rest of the frame
+                    size_t total_samps = num_frame_samps - num_samps_saved;
                     rx_stream_cmd.stream_mode = uhd::stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE;
                     rx_stream_cmd.num_samps = total_samps;
                     rx_stream_cmd.stream_now = true;
                     rx_stream -> issue_stream_cmd(rx_stream_cmd);
 
-                    for (size_t i = num_energy_detection_rows; i < num_rows; i++)
+                    //receive the rest of the frame directly after the saved samples
+                    std::complex<data_type> * frame_samps = rx_buffer -> buffer.data();
+                    size_t frame_idx = num_samps_saved;
+                    while (frame_idx < num_frame_samps)
                     {
+                        expected_samps_to_receive = std::min(num_samps_per_buff, num_frame_samps - frame_idx);
+
                         //receive the data
-                        num_samps_received = rx_stream -> recv(
-                                        &(spectrogram_handler->rx_buffer.buffer[i].front()),
-                                        num_samps_per_buff,rx_md,0.5,true);
+                        clock.restart();
+                        num_samps_received = recv_rx_samples(
+                                        frame_samps + frame_idx,
+                                        expected_samps_to_receive,0.5,true);
+                        clock.lap(LatencyMonitor::recv_wait);
                         
                         num_total_samps_received += num_samps_received;
                         
                         //check the metadata to confirm good receive
                         if (num_samps_received != expected_samps_to_receive){
-                            std::cout << "USRPHandler::rx_record_next_frame: Tried receiving " << expected_samps_to_receive <<
-                                        " samples when spectrogram sensing, but only received " << num_samps_received << std::endl;
+                            LOG_WARNING("USRPHandler::rx_record_next_frame: Tried receiving {} samples when spectrogram sensing, but only received {}",
+                                        expected_samps_to_receive, num_samps_received);
                         }
                         check_rx_metadata(rx_md);
+
+                        //stop if the stream ended early
+                        if (num_samps_received == 0)
+                        {
+                            break;
+                        }
+                        frame_idx += num_samps_received;
+                        if (samples_received_callback)
+                        {
+                            samples_received_callback(frame_idx);
+                        }
                     }
                     return;
                 }
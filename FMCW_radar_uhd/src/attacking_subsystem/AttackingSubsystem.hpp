@@ -15,12 +15,14 @@
     #include "../JSONHandler.hpp"
     #include "../USRPHandler.hpp"
     #include "../BufferHandler.hpp"
+    #include "../LatencyMonitor.hpp"
 
     // add in namespaces as needed
     using json = nlohmann::json;
     using USRPHandler_namespace::USRPHandler;
     using Buffers::Buffer_2D;
     using Buffers::Buffer_1D;
+    using LatencyMonitor_namespace::LatencyMonitor;
 
     namespace AttackingSubsystem_namespace{
 
@@ -189,8 +191,57 @@
                 //std::cout << std::endl;
             }
 
+            /**
+             * @brief Apply an updated configuration (the attack signal is only reloaded
+             * if its file changed or it hasn't been loaded yet)
+             * 
+             * @param new_config the updated JSON configuration object for the attacker
+             */
+            void update_config(const json & new_config){
+                std::vector<std::string> changed = JSONHandler::changed_settings(config, new_config);
+                config = new_config;
+                if (changed.empty() || (! check_config()))
+                {
+                    return;
+                }
+
+                initialize_attack_subsystem_parameters();
+                if (enabled &&
+                    (JSONHandler::setting_changed(changed, "/AttackSubsystemSettings/tx_file_name") ||
+                    attack_signal_buffer.buffer.num_samples() == 0))
+                {
+                    init_attack_signal_buffer();
+                }
+            }
+
             void run_attack_subsystem(){
-                attacker_usrp_handler -> stream_frames_tx_only(frame_start_times, & attack_signal_buffer);
+                queue_attack();
+                wait_for_attack();
+            }
+
+            /**
+             * @brief Queue the attack frames on the transmit engine (returns immediately)
+             * 
+             * @param latency_monitor (optional) latency monitor to check the deadline of the first
+             * attack frame in (against the device time once the frames have been queued)
+             */
+            void queue_attack(LatencyMonitor * latency_monitor = nullptr){
+                attacker_usrp_handler -> submit_tx_frames(frame_start_times, & attack_signal_buffer);
+
+                if (latency_monitor != nullptr && latency_monitor -> enabled && (! frame_start_times.empty()))
+                {
+                    latency_monitor -> check_deadline(attack_start_time_ms + (stream_start_offset_us * 1e-3),
+                        frame_start_times[0].get_real_secs(),
+                        attacker_usrp_handler -> get_time_now().get_real_secs());
+                }
+            }
+
+            /**
+             * @brief Wait for the queued attack frames to be sent
+             * 
+             */
+            void wait_for_attack(){
+                attacker_usrp_handler -> wait_for_tx_frames();
             }
 
             
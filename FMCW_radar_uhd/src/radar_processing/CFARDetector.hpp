@@ -0,0 +1,585 @@
+#ifndef CFARDETECTOR
+#define CFARDETECTOR
+
+    //include header files
+    #include "../sensing_subsystem/pocketfft/pocketfft_hdronly.h"
+
+    //C standard libraries
+    #include <iostream>
+    #include <cstdlib>
+    #include <cstdint>
+    #include <string>
+    #include <vector>
+    #include <chrono>
+    #include <algorithm>
+    #include <cmath>
+    #include <limits>
+
+    //including buffer handler
+    #include "../BufferHandler.hpp"
+
+    //vectorized threshold comparisons
+    #include "../SIMDKernels.hpp"
+
+    //include the JSON handling capability
+    #include <nlohmann/json.hpp>
+
+    using namespace Buffers;
+    using json = nlohmann::json;
+
+    namespace CFARDetector_namespace {
+
+        /**
+         * @brief A target detected by the CFAR detector
+         *
+         * @tparam data_type the type of the power map
+         */
+        template<typename data_type>
+        struct CFARDetection {
+            uint32_t range_bin;
+            uint32_t doppler_bin;
+            data_type snr_dB; //power in the cell relative to the estimated noise
+        };
+
+        /**
+         * @brief Constant false alarm rate (CFAR) detector for range-doppler power maps
+         * (range bins x doppler bins). Supports cell averaging (CA) CFAR, where the noise is the
+         * mean of the training cells in a rectangular window around the guard cells, and ordered
+         * statistic (OS) CFAR, where the noise is a given rank of the training cells along the range
+         * and doppler axes through the cell under test. The doppler axis wraps around, the range axis
+         * is truncated at its edges. CA-CFAR computes the window sums with separable running sums, so
+         * its cost doesn't depend on the window size
+         *
+         * @tparam data_type the type of the power map
+         */
+        template<typename data_type>
+        class CFARDetector {
+            public:
+                enum class CFARType {cell_averaging, ordered_statistic};
+
+            private:
+                json config;
+
+                //cfar parameters
+                CFARType cfar_type;
+                size_t guard_cells_range;
+                size_t guard_cells_doppler;
+                size_t training_cells_range;
+                size_t training_cells_doppler;
+                data_type threshold_dB;
+                data_type threshold_factor; //linear
+                double os_rank; //fraction of the training cells (ex: 0.75)
+
+                //number of threads to use
+                size_t num_threads;
+
+                //map dimensions the buffers are sized for
+                size_t num_range_bins;
+                size_t num_doppler_bins;
+
+                //statistics
+                size_t num_maps_processed;
+                size_t total_detections;
+                double total_processing_time_s;
+                double max_processing_time_s;
+
+            public:
+
+                //status
+                bool enabled;
+
+                //buffers used
+
+                    //doppler (row) running sums of the outer window and the guard window
+                    Buffer_2D<data_type> outer_row_sums;
+                    Buffer_2D<data_type> guard_row_sums;
+
+                    //per thread scratch rows
+                    Buffer_2D<double> outer_sums; //range running sums (per thread)
+                    Buffer_2D<double> guard_sums; //range running sums (per thread)
+                    Buffer_2D<data_type> noise_rows;
+                    Buffer_2D<data_type> threshold_rows;
+                    Buffer_2D<uint32_t> exceedance_rows;
+                    Buffer_2D<data_type> training_cells; //os-cfar training cells
+
+                    //detections from each thread, and the combined detections for the most recent map
+                    std::vector<std::vector<CFARDetection<data_type>>> thread_detections;
+                    std::vector<CFARDetection<data_type>> detections;
+
+                /**
+                 * @brief Construct a new CFARDetector object
+                 *
+                 * @param config_data a json object with configuration information
+                 */
+                CFARDetector(json config_data):
+                    config(config_data),
+                    cfar_type(CFARType::cell_averaging),
+                    guard_cells_range(2),
+                    guard_cells_doppler(2),
+                    training_cells_range(8),
+                    training_cells_doppler(4),
+                    threshold_dB(13),
+                    threshold_factor(0),
+                    os_rank(0.75),
+                    num_threads(1),
+                    num_range_bins(0),
+                    num_doppler_bins(0),
+                    num_maps_processed(0),
+                    total_detections(0),
+                    total_processing_time_s(0),
+                    max_processing_time_s(0),
+                    enabled(false){
+
+                    if (check_config())
+                    {
+                        initialize_cfar_params();
+                    }
+                }
+
+                ~CFARDetector() {}
+
+                /**
+                 * @brief Check the json config file for the CFAR parameters
+                 *
+                 * @return true - JSON is all good and has required elements
+                 * @return false - JSON is missing certain fields
+                 */
+                bool check_config(){
+                    bool config_good = true;
+
+                    if (config["RadarSettings"]["cfar_enabled"].is_null())
+                    {
+                        //cfar is disabled unless it is enabled in the config
+                        return false;
+                    }
+
+                    if (config["RadarSettings"]["cfar_threshold_dB"].is_null())
+                    {
+                        std::cerr << "CFARDetector::check_config: no cfar_threshold_dB in JSON" << std::endl;
+                        config_good = false;
+                    }
+
+                    return config_good;
+                }
+
+                /**
+                 * @brief Load the CFAR parameters from the JSON config
+                 *
+                 */
+                void initialize_cfar_params(void){
+                    json & radar_settings = config["RadarSettings"];
+
+                    enabled = radar_settings["cfar_enabled"].get<bool>();
+                    threshold_dB = radar_settings["cfar_threshold_dB"].get<data_type>();
+                    threshold_factor = static_cast<data_type>(std::pow(10.0, threshold_dB / 10.0));
+
+                    if (radar_settings["cfar_type"].is_null() == false)
+                    {
+                        std::string type = radar_settings["cfar_type"].get<std::string>();
+                        if (type == "OS")
+                        {
+                            cfar_type = CFARType::ordered_statistic;
+                        }
+                        else if (type != "CA")
+                        {
+                            std::cerr << "CFARDetector::initialize_cfar_params: unknown cfar_type " << type <<
+                                        ", using CA" << std::endl;
+                        }
+                    }
+
+                    if (radar_settings["cfar_guard_cells_range"].is_null() == false)
+                    {
+                        guard_cells_range = radar_settings["cfar_guard_cells_range"].get<size_t>();
+                    }
+                    if (radar_settings["cfar_guard_cells_doppler"].is_null() == false)
+                    {
+                        guard_cells_doppler = radar_settings["cfar_guard_cells_doppler"].get<size_t>();
+                    }
+                    if (radar_settings["cfar_training_cells_range"].is_null() == false)
+                    {
+                        training_cells_range = radar_settings["cfar_training_cells_range"].get<size_t>();
+                    }
+                    if (radar_settings["cfar_training_cells_doppler"].is_null() == false)
+                    {
+                        training_cells_doppler = radar_settings["cfar_training_cells_doppler"].get<size_t>();
+                    }
+                    if (radar_settings["cfar_os_rank"].is_null() == false)
+                    {
+                        os_rank = std::min(std::max(radar_settings["cfar_os_rank"].get<double>(), 0.0), 1.0);
+                    }
+                    if (radar_settings["cfar_num_threads"].is_null() == false)
+                    {
+                        num_threads = std::max(radar_settings["cfar_num_threads"].get<size_t>(), static_cast<size_t>(1));
+                    }
+
+                    if (training_cells_range + training_cells_doppler == 0)
+                    {
+                        std::cerr << "CFARDetector::initialize_cfar_params: no training cells, using 1 range training cell" << std::endl;
+                        training_cells_range = 1;
+                    }
+
+                    //the doppler window is clipped to the number of doppler bins, so CA-CFAR could be left without
+                    //any training cells (and an infinite noise scale) unless there are range training cells
+                    if ((cfar_type == CFARType::cell_averaging) && (training_cells_range == 0))
+                    {
+                        std::cerr << "CFARDetector::initialize_cfar_params: CA-CFAR requires cfar_training_cells_range > 0, disabling CFAR" << std::endl;
+                        enabled = false;
+                    }
+                }
+
+                /**
+                 * @brief Run the CFAR detector on a power map, the detections are stored in detections
+                 *
+                 * @param power_map the power map (range bins x doppler bins, linear power)
+                 * @return size_t the number of detections
+                 */
+                size_t detect(Buffer_2D<data_type> & power_map){
+                    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+                    detections.clear();
+                    if ((power_map.num_rows == 0) || (power_map.num_cols == 0))
+                    {
+                        std::cerr << "CFARDetector::detect: the power map has no range or doppler bins" << std::endl;
+                        return 0;
+                    }
+
+                    initialize_buffers(power_map.num_rows, power_map.num_cols);
+
+                    if (cfar_type == CFARType::cell_averaging)
+                    {
+                        //doppler running sums (by row) followed by range running sums (by thread)
+                        pocketfft::detail::threading::thread_map(num_threads, [this, &power_map](){
+                            size_t start_bin, end_bin;
+                            get_thread_range_bins(start_bin, end_bin);
+                            compute_doppler_sums(power_map, start_bin, end_bin);
+                        });
+                        pocketfft::detail::threading::thread_map(num_threads, [this, &power_map](){
+                            size_t start_bin, end_bin;
+                            get_thread_range_bins(start_bin, end_bin);
+                            detect_ca(power_map, start_bin, end_bin, pocketfft::detail::threading::thread_id());
+                        });
+                    }
+                    else{
+                        pocketfft::detail::threading::thread_map(num_threads, [this, &power_map](){
+                            size_t start_bin, end_bin;
+                            get_thread_range_bins(start_bin, end_bin);
+                            detect_os(power_map, start_bin, end_bin, pocketfft::detail::threading::thread_id());
+                        });
+                    }
+
+                    //combine the detections (in range bin order)
+                    for (size_t i = 0; i < thread_detections.size(); i++)
+                    {
+                        detections.insert(detections.end(), thread_detections[i].begin(), thread_detections[i].end());
+                    }
+
+                    double processing_time_s = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start_time).count();
+                    num_maps_processed += 1;
+                    total_detections += detections.size();
+                    total_processing_time_s += processing_time_s;
+                    max_processing_time_s = std::max(max_processing_time_s, processing_time_s);
+
+                    return detections.size();
+                }
+
+                /**
+                 * @brief Print the number of maps processed, detections, and the processing time per map
+                 *
+                 */
+                void print_summary(void){
+                    double average_time_ms = 0.0;
+                    double average_detections = 0.0;
+                    if (num_maps_processed > 0)
+                    {
+                        average_time_ms = total_processing_time_s * 1e3 / static_cast<double>(num_maps_processed);
+                        average_detections = static_cast<double>(total_detections) / static_cast<double>(num_maps_processed);
+                    }
+                    std::cout << "CFARDetector::print_summary: (" << get_type_name() << ") maps processed: " << num_maps_processed <<
+                                ", average detections: " << average_detections <<
+                                ", average time: " << average_time_ms << " ms" <<
+                                ", max time: " << max_processing_time_s * 1e3 << " ms" << std::endl << std::endl;
+                }
+
+                const char * get_type_name(void){
+                    return (cfar_type == CFARType::cell_averaging) ? "CA-CFAR" : "OS-CFAR";
+                }
+
+            private:
+
+                /**
+                 * @brief size the scratch buffers for a map (only reallocates if the map size changes)
+                 *
+                 * @param range_bins the number of range bins (rows) in the map
+                 * @param doppler_bins the number of doppler bins (columns) in the map
+                 */
+                void initialize_buffers(size_t range_bins, size_t doppler_bins){
+                    if (range_bins == num_range_bins && doppler_bins == num_doppler_bins &&
+                        thread_detections.size() == num_threads)
+                    {
+                        return;
+                    }
+                    num_range_bins = range_bins;
+                    num_doppler_bins = doppler_bins;
+
+                    outer_row_sums = Buffer_2D<data_type>(range_bins, doppler_bins);
+                    guard_row_sums = Buffer_2D<data_type>(range_bins, doppler_bins);
+                    outer_sums = Buffer_2D<double>(num_threads, doppler_bins);
+                    guard_sums = Buffer_2D<double>(num_threads, doppler_bins);
+                    noise_rows = Buffer_2D<data_type>(num_threads, doppler_bins);
+                    threshold_rows = Buffer_2D<data_type>(num_threads, doppler_bins);
+                    exceedance_rows = Buffer_2D<uint32_t>(num_threads, doppler_bins);
+                    training_cells = Buffer_2D<data_type>(num_threads, 4 * (training_cells_range + training_cells_doppler));
+                    thread_detections = std::vector<std::vector<CFARDetection<data_type>>>(num_threads);
+
+                    //reserve for every cell detecting so that recording detections never reallocates
+                    size_t max_bins_per_thread = (range_bins + num_threads - 1) / num_threads;
+                    for (size_t i = 0; i < num_threads; i++)
+                    {
+                        thread_detections[i].reserve(max_bins_per_thread * doppler_bins);
+                    }
+                    detections.reserve(range_bins * doppler_bins);
+                }
+
+                /**
+                 * @brief Get the range bins for the calling thread (within thread_map)
+                 *
+                 */
+                void get_thread_range_bins(size_t & start_bin, size_t & end_bin){
+                    size_t thread_id = pocketfft::detail::threading::thread_id();
+                    size_t threads = pocketfft::detail::threading::num_threads();
+                    size_t bins_per_thread = num_range_bins / threads;
+                    size_t extra_bins = num_range_bins % threads;
+                    start_bin = thread_id * bins_per_thread + std::min(thread_id, extra_bins);
+                    end_bin = start_bin + bins_per_thread + (thread_id < extra_bins ? 1 : 0);
+                }
+
+                /**
+                 * @brief Get the half width of a window along the (circular) doppler axis
+                 *
+                 */
+                size_t doppler_half_width(size_t cells){
+                    return std::min(cells, (num_doppler_bins - 1) / 2);
+                }
+
+                /**
+                 * @brief compute the (circular) running sums along doppler of the outer window and
+                 * the guard window for the given range bins
+                 *
+                 */
+                void compute_doppler_sums(Buffer_2D<data_type> & power_map, size_t start_bin, size_t end_bin){
+                    size_t outer_width = doppler_half_width(guard_cells_doppler + training_cells_doppler);
+                    size_t guard_width = doppler_half_width(guard_cells_doppler);
+
+                    for (size_t bin = start_bin; bin < end_bin; bin++)
+                    {
+                        const data_type * power = power_map.buffer[bin].data();
+                        compute_circular_sums(power, outer_width, outer_row_sums.buffer[bin].data());
+                        compute_circular_sums(power, guard_width, guard_row_sums.buffer[bin].data());
+                    }
+                }
+
+                /**
+                 * @brief compute the sum over [i - half_width, i + half_width] (wrapping around) for each
+                 * element of a row (accumulated in double precision so that strong targets don't leave
+                 * residue in the running sum)
+                 *
+                 */
+                void compute_circular_sums(const data_type * row, size_t half_width, data_type * sums){
+                    size_t n = num_doppler_bins;
+                    double sum = 0;
+                    for (size_t j = n - half_width; j < n + half_width + 1; j++)
+                    {
+                        sum += row[j % n];
+                    }
+                    sums[0] = static_cast<data_type>(sum);
+                    for (size_t i = 1; i < n; i++)
+                    {
+                        sum += static_cast<double>(row[(i + half_width) % n]) - static_cast<double>(row[(i + n - half_width - 1) % n]);
+                        sums[i] = static_cast<data_type>(sum);
+                    }
+                }
+
+                /**
+                 * @brief CA-CFAR for the given range bins: slides the range window over the doppler
+                 * sums (a row at a time so that the inner loops are contiguous and vectorize), then
+                 * compares each row against its thresholds
+                 *
+                 */
+                void detect_ca(Buffer_2D<data_type> & power_map, size_t start_bin, size_t end_bin, size_t thread_id){
+                    std::vector<CFARDetection<data_type>> & found = thread_detections[thread_id];
+                    found.clear();
+                    if (start_bin >= end_bin)
+                    {
+                        return;
+                    }
+
+                    size_t n = num_doppler_bins;
+                    long long outer_width = static_cast<long long>(guard_cells_range + training_cells_range);
+                    long long guard_width = static_cast<long long>(guard_cells_range);
+                    long long last_bin = static_cast<long long>(num_range_bins) - 1;
+                    double outer_doppler_cells = static_cast<double>(2 * doppler_half_width(guard_cells_doppler + training_cells_doppler) + 1);
+                    double guard_doppler_cells = static_cast<double>(2 * doppler_half_width(guard_cells_doppler) + 1);
+
+                    double * outer = outer_sums.buffer[thread_id].data();
+                    double * guard = guard_sums.buffer[thread_id].data();
+                    data_type * noise = noise_rows.buffer[thread_id].data();
+                    data_type * threshold = threshold_rows.buffer[thread_id].data();
+                    uint32_t * exceedances = exceedance_rows.buffer[thread_id].data();
+
+                    //initialize the range sums for the first bin
+                    long long first = static_cast<long long>(start_bin);
+                    std::fill(outer, outer + n, 0.0);
+                    std::fill(guard, guard + n, 0.0);
+                    for (long long r = std::max(first - outer_width, 0LL); r <= std::min(first + outer_width, last_bin); r++)
+                    {
+                        add_row(outer, outer_row_sums.buffer[r].data(), 1.0);
+                    }
+                    for (long long r = std::max(first - guard_width, 0LL); r <= std::min(first + guard_width, last_bin); r++)
+                    {
+                        add_row(guard, guard_row_sums.buffer[r].data(), 1.0);
+                    }
+
+                    for (long long bin = first; bin < static_cast<long long>(end_bin); bin++)
+                    {
+                        //slide the range windows
+                        if (bin > first)
+                        {
+                            if (bin + outer_width <= last_bin)
+                            {
+                                add_row(outer, outer_row_sums.buffer[bin + outer_width].data(), 1.0);
+                            }
+                            if (bin - outer_width - 1 >= 0)
+                            {
+                                add_row(outer, outer_row_sums.buffer[bin - outer_width - 1].data(), -1.0);
+                            }
+                            if (bin + guard_width <= last_bin)
+                            {
+                                add_row(guard, guard_row_sums.buffer[bin + guard_width].data(), 1.0);
+                            }
+                            if (bin - guard_width - 1 >= 0)
+                            {
+                                add_row(guard, guard_row_sums.buffer[bin - guard_width - 1].data(), -1.0);
+                            }
+                        }
+
+                        //number of training cells (the range window is truncated at the edges)
+                        double outer_range_cells = static_cast<double>(std::min(bin + outer_width, last_bin) - std::max(bin - outer_width, 0LL) + 1);
+                        double guard_range_cells = static_cast<double>(std::min(bin + guard_width, last_bin) - std::max(bin - guard_width, 0LL) + 1);
+                        double num_training_cells = outer_range_cells * outer_doppler_cells - guard_range_cells * guard_doppler_cells;
+                        if (num_training_cells <= 0)
+                        {
+                            //the windows were clipped to the map, so there is no noise estimate for this range bin
+                            continue;
+                        }
+                        double scale = 1.0 / num_training_cells;
+                        data_type factor = threshold_factor;
+
+                        for (size_t k = 0; k < n; k++)
+                        {
+                            noise[k] = static_cast<data_type>((outer[k] - guard[k]) * scale);
+                            threshold[k] = noise[k] * factor;
+                        }
+
+                        record_detections(power_map.buffer[bin].data(), noise, threshold, exceedances,
+                                            static_cast<uint32_t>(bin), found);
+                    }
+                }
+
+                /**
+                 * @brief add (or subtract) a row of doppler sums to a row of range sums
+                 *
+                 */
+                void add_row(double * sums, const data_type * row, double sign){
+                    for (size_t k = 0; k < num_doppler_bins; k++)
+                    {
+                        sums[k] += sign * static_cast<double>(row[k]);
+                    }
+                }
+
+                /**
+                 * @brief OS-CFAR for the given range bins, the noise for each cell is the os_rank
+                 * order statistic of the training cells along the range and doppler axes through it
+                 *
+                 */
+                void detect_os(Buffer_2D<data_type> & power_map, size_t start_bin, size_t end_bin, size_t thread_id){
+                    std::vector<CFARDetection<data_type>> & found = thread_detections[thread_id];
+                    found.clear();
+
+                    size_t n = num_doppler_bins;
+                    long long range_start = static_cast<long long>(guard_cells_range) + 1;
+                    long long range_end = static_cast<long long>(guard_cells_range + training_cells_range);
+                    long long last_bin = static_cast<long long>(num_range_bins) - 1;
+                    size_t doppler_start = doppler_half_width(guard_cells_doppler) + 1;
+                    size_t doppler_end = doppler_half_width(guard_cells_doppler + training_cells_doppler);
+
+                    data_type * cells = training_cells.buffer[thread_id].data();
+                    data_type * noise = noise_rows.buffer[thread_id].data();
+                    data_type * threshold = threshold_rows.buffer[thread_id].data();
+                    uint32_t * exceedances = exceedance_rows.buffer[thread_id].data();
+
+                    for (long long bin = static_cast<long long>(start_bin); bin < static_cast<long long>(end_bin); bin++)
+                    {
+                        for (size_t k = 0; k < n; k++)
+                        {
+                            //gather the training cells
+                            size_t num_cells = 0;
+                            for (long long offset = range_start; offset <= range_end; offset++)
+                            {
+                                if (bin - offset >= 0)
+                                {
+                                    cells[num_cells++] = power_map.buffer[bin - offset][k];
+                                }
+                                if (bin + offset <= last_bin)
+                                {
+                                    cells[num_cells++] = power_map.buffer[bin + offset][k];
+                                }
+                            }
+                            const data_type * row = power_map.buffer[bin].data();
+                            for (size_t offset = doppler_start; offset <= doppler_end; offset++)
+                            {
+                                cells[num_cells++] = row[(k + offset) % n];
+                                cells[num_cells++] = row[(k + n - offset) % n];
+                            }
+
+                            if (num_cells == 0)
+                            {
+                                noise[k] = 0;
+                                threshold[k] = std::numeric_limits<data_type>::max();
+                                continue;
+                            }
+
+                            //select the order statistic
+                            size_t rank = static_cast<size_t>(os_rank * static_cast<double>(num_cells - 1));
+                            std::nth_element(cells, cells + rank, cells + num_cells);
+                            noise[k] = cells[rank];
+                            threshold[k] = noise[k] * threshold_factor;
+                        }
+
+                        record_detections(power_map.buffer[bin].data(), noise, threshold, exceedances,
+                                            static_cast<uint32_t>(bin), found);
+                    }
+                }
+
+                /**
+                 * @brief compare a row of the power map against its thresholds (vectorized) and
+                 * record the cells that exceed them
+                 *
+                 */
+                void record_detections(const data_type * power, const data_type * noise, const data_type * threshold,
+                                        uint32_t * exceedances, uint32_t range_bin,
+                                        std::vector<CFARDetection<data_type>> & found){
+                    size_t num_exceedances = SIMDKernels::threshold_exceedances(power, threshold, num_doppler_bins, exceedances);
+                    for (size_t i = 0; i < num_exceedances; i++)
+                    {
+                        uint32_t k = exceedances[i];
+                        CFARDetection<data_type> detection;
+                        detection.range_bin = range_bin;
+                        detection.doppler_bin = k;
+                        detection.snr_dB = static_cast<data_type>(10) * std::log10(power[k] / noise[k]);
+                        found.push_back(detection);
+                    }
+                }
+        };
+    }
+#endif
@@ -0,0 +1,481 @@
+#ifndef RANGEDOPPLERPROCESSOR
+#define RANGEDOPPLERPROCESSOR
+
+    //include header files
+    #include "../sensing_subsystem/pocketfft/pocketfft_hdronly.h"
+
+    //C standard libraries
+    #include <iostream>
+    #include <cstdlib>
+    #include <string>
+    #include <complex>
+    #include <vector>
+    #include <memory>
+    #include <chrono>
+    #include <algorithm>
+
+    #define _USE_MATH_DEFINES
+    #include <cmath>
+
+    //including buffer handler
+    #include "../BufferHandler.hpp"
+
+    //include the JSON handling capability
+    #include <nlohmann/json.hpp>
+
+    using namespace Buffers;
+    using json = nlohmann::json;
+
+    namespace RangeDopplerProcessor_namespace {
+
+        /**
+         * @brief Computes a range-Doppler power map for each received radar frame. Each chirp
+         * is dechirped (mixed with the conjugate of the tx chirp), windowed, and range FFT'd.
+         * The range profiles are then corner turned (transposed in cache sized blocks) so
+         * that each range bin's slow time samples are contiguous, windowed, and Doppler FFT'd.
+         * Both stages are split across threads (over chirps and over range bins respectively)
+         *
+         * @tparam data_type the cpu_format used for the USRP device, will be std::complex<data_type>
+         */
+        template<typename data_type>
+        class RangeDopplerProcessor {
+            private:
+
+                json config;
+
+                //size parameters
+                size_t num_chirps;
+                size_t samples_per_chirp;
+                size_t range_fft_size;
+                size_t doppler_fft_size;
+
+                //number of range bins/chirps per block in the corner turn
+                const size_t corner_turn_block_size = 16;
+
+                //fft plans
+                std::shared_ptr<pocketfft::detail::pocketfft_c<data_type>> range_fft_plan;
+                std::shared_ptr<pocketfft::detail::pocketfft_c<data_type>> doppler_fft_plan;
+
+                //number of threads to use for the fft computations
+                size_t num_threads;
+
+                //on true, mix each chirp with the conjugate of the tx chirp before the range fft
+                bool dechirp;
+
+                //save the range-doppler maps to a file
+                bool save_maps;
+                std::string range_doppler_file_name;
+
+                //timing statistics
+                double frame_periodicity_s;
+                size_t num_frames_processed;
+                size_t num_frames_over_budget;
+                double total_processing_time_s;
+                double max_processing_time_s;
+
+            public:
+
+                //status
+                bool enabled;
+                bool initialized;
+
+                //buffers used
+
+                    //reference chirp (conjugated) and windows
+                    Buffer_1D<std::complex<data_type>> dechirp_reference;
+                    Buffer_1D<data_type> range_window;
+                    Buffer_1D<data_type> doppler_window;
+
+                    //range profiles (num_chirps x range_fft_size)
+                    Buffer_2D<std::complex<data_type>> range_profiles;
+
+                    //corner turned range profiles (range_fft_size x doppler_fft_size)
+                    Buffer_2D<std::complex<data_type>> doppler_profiles;
+
+                    //range-doppler power map (range_fft_size x doppler_fft_size, zero doppler centered)
+                    Buffer_2D<data_type> range_doppler_map;
+
+                /**
+                 * @brief Construct a new Range Doppler Processor object (call initialize() once
+                 * the frame dimensions are known)
+                 *
+                 * @param config_data a json object with configuration information
+                 */
+                RangeDopplerProcessor(json config_data):
+                    config(config_data),
+                    num_chirps(0),
+                    samples_per_chirp(0),
+                    range_fft_size(0),
+                    doppler_fft_size(0),
+                    num_threads(1),
+                    dechirp(true),
+                    save_maps(false),
+                    frame_periodicity_s(0),
+                    num_frames_processed(0),
+                    num_frames_over_budget(0),
+                    total_processing_time_s(0),
+                    max_processing_time_s(0),
+                    enabled(false),
+                    initialized(false){
+
+                    if (config["RadarSettings"]["range_doppler_enabled"].is_null() == false)
+                    {
+                        enabled = config["RadarSettings"]["range_doppler_enabled"].get<bool>();
+                    }
+                }
+
+                ~RangeDopplerProcessor() {}
+
+                /**
+                 * @brief Initialize the fft plans, windows, and buffers for a given frame size
+                 *
+                 * @param chirps_per_frame the number of chirps in a frame
+                 * @param chirp_samples the number of samples in each chirp
+                 * @param tx_chirp the transmitted chirp (used to dechirp the received chirps)
+                 */
+                void initialize(size_t chirps_per_frame,
+                                size_t chirp_samples,
+                                const std::vector<std::complex<data_type>> & tx_chirp){
+                    num_chirps = chirps_per_frame;
+                    samples_per_chirp = chirp_samples;
+
+                    if (num_chirps == 0 || samples_per_chirp == 0)
+                    {
+                        std::cerr << "RangeDopplerProcessor::initialize: frame must contain at least one chirp" << std::endl;
+                        return;
+                    }
+
+                    initialize_params();
+                    initialize_fft_params();
+                    initialize_buffers();
+                    initialize_windows(tx_chirp);
+                    initialized = true;
+
+                    std::cout << "RangeDopplerProcessor::initialize: range fft size: " << range_fft_size <<
+                                ", doppler fft size: " << doppler_fft_size <<
+                                ", threads: " << num_threads << std::endl << std::endl;
+                }
+
+                /**
+                 * @brief Compute the range-doppler map for a received frame (and save it
+                 * to the range doppler file if one was specified)
+                 *
+                 * @param frame the received frame, the chirps must be stored contiguously
+                 * starting at the first sample of the frame
+                 */
+                void process_frame(Buffer_2D<std::complex<data_type>> & frame){
+                    if (! initialized)
+                    {
+                        return;
+                    }
+                    if (frame.buffer.num_samples() < (num_chirps * samples_per_chirp))
+                    {
+                        std::cerr << "RangeDopplerProcessor::process_frame: frame has fewer samples than expected" << std::endl;
+                        return;
+                    }
+
+                    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+                    compute_range_ffts(frame.buffer.data());
+                    compute_doppler_ffts();
+
+                    double processing_time_s = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start_time).count();
+                    num_frames_processed += 1;
+                    total_processing_time_s += processing_time_s;
+                    max_processing_time_s = std::max(max_processing_time_s, processing_time_s);
+                    if (frame_periodicity_s > 0 && processing_time_s > frame_periodicity_s)
+                    {
+                        num_frames_over_budget += 1;
+                    }
+
+                    if (save_maps)
+                    {
+                        range_doppler_map.save_to_file();
+                    }
+                }
+
+                /**
+                 * @brief Compute the range ffts of every chirp in a frame (split across the threads)
+                 *
+                 * @param frame_samples pointer to the first sample of the frame
+                 */
+                void compute_range_ffts(const std::complex<data_type> * frame_samples){
+                    pocketfft::detail::threading::thread_map(num_threads, [this, frame_samples](){
+                        size_t thread_id = pocketfft::detail::threading::thread_id();
+                        size_t threads = pocketfft::detail::threading::num_threads();
+
+                        //determine the chirps for this thread
+                        size_t start_chirp, end_chirp;
+                        partition(num_chirps, thread_id, threads, start_chirp, end_chirp);
+
+                        compute_range_ffts(frame_samples, start_chirp, end_chirp);
+                    });
+                }
+
+                /**
+                 * @brief Compute the range ffts for the given chirps (can be called as each
+                 * chirp arrives)
+                 *
+                 * @param frame_samples pointer to the first sample of the frame
+                 * @param start_chirp the first chirp to compute
+                 * @param end_chirp the chirp to stop at
+                 */
+                void compute_range_ffts(const std::complex<data_type> * frame_samples, size_t start_chirp, size_t end_chirp){
+                    const std::complex<data_type> * reference = dechirp_reference.buffer.data();
+                    const data_type * window = range_window.buffer.data();
+                    size_t num_samples = std::min(samples_per_chirp, range_fft_size);
+
+                    for (size_t chirp = start_chirp; chirp < end_chirp; chirp++)
+                    {
+                        const std::complex<data_type> * chirp_samples = frame_samples + (chirp * samples_per_chirp);
+                        std::complex<data_type> * row = range_profiles.buffer[chirp].data();
+
+                        //dechirp and window (zero padded to the fft size)
+                        for (size_t i = 0; i < num_samples; i++)
+                        {
+                            row[i] = chirp_samples[i] * reference[i] * window[i];
+                        }
+                        std::fill(row + num_samples, row + range_fft_size, std::complex<data_type>(0));
+
+                        range_fft_plan -> exec(reinterpret_cast<pocketfft::detail::cmplx<data_type> *>(row),
+                                                static_cast<data_type>(1), true);
+                    }
+                }
+
+                /**
+                 * @brief Corner turn the range profiles and compute the doppler fft for each
+                 * range bin (split across the threads by range bin)
+                 *
+                 */
+                void compute_doppler_ffts(void){
+                    pocketfft::detail::threading::thread_map(num_threads, [this](){
+                        size_t thread_id = pocketfft::detail::threading::thread_id();
+                        size_t threads = pocketfft::detail::threading::num_threads();
+
+                        //determine the range bins for this thread
+                        size_t start_bin, end_bin;
+                        partition(range_fft_size, thread_id, threads, start_bin, end_bin);
+
+                        compute_doppler_ffts(start_bin, end_bin);
+                    });
+                }
+
+                /**
+                 * @brief Corner turn, window, and doppler fft the given range bins, and compute
+                 * their rows of the range-doppler map
+                 *
+                 * @param start_bin the first range bin to compute
+                 * @param end_bin the range bin to stop at
+                 */
+                void compute_doppler_ffts(size_t start_bin, size_t end_bin){
+                    const data_type * window = doppler_window.buffer.data();
+                    size_t doppler_shift = doppler_fft_size / 2;
+
+                    //corner turn in blocks so that the reads from the range profiles (a column
+                    //of each block) and the writes to the doppler profiles both stay in cache
+                    for (size_t bin_block = start_bin; bin_block < end_bin; bin_block += corner_turn_block_size)
+                    {
+                        size_t bin_block_end = std::min(bin_block + corner_turn_block_size, end_bin);
+                        for (size_t chirp_block = 0; chirp_block < num_chirps; chirp_block += corner_turn_block_size)
+                        {
+                            size_t chirp_block_end = std::min(chirp_block + corner_turn_block_size, num_chirps);
+                            for (size_t chirp = chirp_block; chirp < chirp_block_end; chirp++)
+                            {
+                                const std::complex<data_type> * range_row = range_profiles.buffer[chirp].data();
+                                for (size_t bin = bin_block; bin < bin_block_end; bin++)
+                                {
+                                    doppler_profiles.buffer[bin][chirp] = range_row[bin] * window[chirp];
+                                }
+                            }
+                        }
+                    }
+
+                    for (size_t bin = start_bin; bin < end_bin; bin++)
+                    {
+                        std::complex<data_type> * row = doppler_profiles.buffer[bin].data();
+
+                        //zero pad and compute the doppler fft
+                        std::fill(row + num_chirps, row + doppler_fft_size, std::complex<data_type>(0));
+                        doppler_fft_plan -> exec(reinterpret_cast<pocketfft::detail::cmplx<data_type> *>(row),
+                                                static_cast<data_type>(1), true);
+
+                        //compute the power (shifted so that zero doppler is centered)
+                        data_type * map_row = range_doppler_map.buffer[bin].data();
+                        for (size_t k = 0; k < doppler_fft_size; k++)
+                        {
+                            map_row[(k + doppler_shift) % doppler_fft_size] = std::norm(row[k]);
+                        }
+                    }
+                }
+
+                /**
+                 * @brief Print the number of frames processed and the processing time per frame
+                 *
+                 */
+                void print_summary(void){
+                    double average_time_ms = 0.0;
+                    if (num_frames_processed > 0)
+                    {
+                        average_time_ms = total_processing_time_s * 1e3 / static_cast<double>(num_frames_processed);
+                    }
+                    std::cout << "RangeDopplerProcessor::print_summary: frames processed: " << num_frames_processed <<
+                                ", average time: " << average_time_ms << " ms" <<
+                                ", max time: " << max_processing_time_s * 1e3 << " ms" <<
+                                ", frames over the " << frame_periodicity_s * 1e3 << " ms frame period: " <<
+                                num_frames_over_budget << std::endl << std::endl;
+                }
+
+                size_t get_range_fft_size(void){
+                    return range_fft_size;
+                }
+
+                size_t get_doppler_fft_size(void){
+                    return doppler_fft_size;
+                }
+
+            private:
+
+                /**
+                 * @brief Split a number of items evenly across threads
+                 *
+                 * @param num_items the number of items
+                 * @param thread_id the thread
+                 * @param threads the number of threads
+                 * @param start the first item for the thread
+                 * @param end the item for the thread to stop at
+                 */
+                static void partition(size_t num_items, size_t thread_id, size_t threads, size_t & start, size_t & end){
+                    size_t items_per_thread = num_items / threads;
+                    size_t extra_items = num_items % threads;
+                    start = thread_id * items_per_thread + std::min(thread_id, extra_items);
+                    end = start + items_per_thread + (thread_id < extra_items ? 1 : 0);
+                }
+
+                /**
+                 * @brief Get the next power of 2 that is greater than or equal to a value
+                 *
+                 */
+                static size_t next_power_of_2(size_t value){
+                    size_t power = 1;
+                    while (power < value)
+                    {
+                        power <<= 1;
+                    }
+                    return power;
+                }
+
+                /**
+                 * @brief Load the processing parameters from the JSON config
+                 *
+                 */
+                void initialize_params(void){
+                    json & radar_settings = config["RadarSettings"];
+
+                    //fft sizes (default to the next power of 2)
+                    range_fft_size = radar_settings["range_fft_size"].is_null() ?
+                                        0 : radar_settings["range_fft_size"].get<size_t>();
+                    if (range_fft_size == 0)
+                    {
+                        range_fft_size = next_power_of_2(samples_per_chirp);
+                    }
+                    doppler_fft_size = radar_settings["doppler_fft_size"].is_null() ?
+                                        0 : radar_settings["doppler_fft_size"].get<size_t>();
+                    if (doppler_fft_size < num_chirps)
+                    {
+                        doppler_fft_size = next_power_of_2(num_chirps);
+                    }
+
+                    //threading
+                    num_threads = radar_settings["range_doppler_num_threads"].is_null() ?
+                                        1 : radar_settings["range_doppler_num_threads"].get<size_t>();
+                    if (num_threads == 0)
+                    {
+                        num_threads = 1;
+                    }
+
+                    //dechirping
+                    if (radar_settings["range_doppler_dechirp"].is_null() == false)
+                    {
+                        dechirp = radar_settings["range_doppler_dechirp"].get<bool>();
+                    }
+
+                    //output file
+                    if (radar_settings["range_doppler_file_name"].is_null() == false)
+                    {
+                        range_doppler_file_name = radar_settings["range_doppler_file_name"].get<std::string>();
+                        save_maps = true;
+                    }
+
+                    //processing budget
+                    if (radar_settings["frame_periodicity_ms"].is_null() == false)
+                    {
+                        frame_periodicity_s = radar_settings["frame_periodicity_ms"].get<double>() * 1e-3;
+                    }
+                }
+
+                /**
+                 * @brief Initialize the range and doppler fft plans
+                 *
+                 */
+                void initialize_fft_params(void){
+                    range_fft_plan = std::make_shared<pocketfft::detail::pocketfft_c<data_type>>(range_fft_size);
+                    doppler_fft_plan = std::make_shared<pocketfft::detail::pocketfft_c<data_type>>(doppler_fft_size);
+                }
+
+                /**
+                 * @brief Initialize the range profile, doppler profile, and range-doppler map buffers
+                 *
+                 */
+                void initialize_buffers(void){
+                    range_profiles = Buffer_2D<std::complex<data_type>>(num_chirps, range_fft_size);
+                    doppler_profiles = Buffer_2D<std::complex<data_type>>(range_fft_size, doppler_fft_size);
+                    range_doppler_map = Buffer_2D<data_type>(range_fft_size, doppler_fft_size);
+
+                    if (save_maps)
+                    {
+                        range_doppler_map.set_write_file(range_doppler_file_name,true);
+                    }
+                }
+
+                /**
+                 * @brief Initialize the dechirp reference and the range and doppler hanning windows
+                 *
+                 * @param tx_chirp the transmitted chirp
+                 */
+                void initialize_windows(const std::vector<std::complex<data_type>> & tx_chirp){
+                    dechirp_reference = Buffer_1D<std::complex<data_type>>(samples_per_chirp);
+                    for (size_t i = 0; i < samples_per_chirp; i++)
+                    {
+                        if (dechirp && i < tx_chirp.size())
+                        {
+                            dechirp_reference.buffer[i] = std::conj(tx_chirp[i]);
+                        }
+                        else{
+                            dechirp_reference.buffer[i] = std::complex<data_type>(1);
+                        }
+                    }
+
+                    range_window = Buffer_1D<data_type>(samples_per_chirp);
+                    initialize_hanning_window(range_window);
+                    doppler_window = Buffer_1D<data_type>(num_chirps);
+                    initialize_hanning_window(doppler_window);
+                }
+
+                /**
+                 * @brief Fill a buffer with a hanning window
+                 *
+                 * @param window the buffer to fill
+                 */
+                void initialize_hanning_window(Buffer_1D<data_type> & window){
+                    data_type M = static_cast<data_type>(window.num_samples);
+                    for (size_t i = 0; i < window.num_samples; i++)
+                    {
+                        data_type n = static_cast<data_type>(i);
+                        window.buffer[i] = (M > 1) ? static_cast<data_type>(0.5 * (1 - cos(2 * M_PI * n / (M - 1)))) :
+                                                        static_cast<data_type>(1);
+                    }
+                }
+        };
+    }
+#endif
@@ -0,0 +1,8 @@
+#include "DebugDumpWriter.hpp"
+
+/**
+ * All of the code for this file is located in the header file.
+ * This was done because the DebugDumpWriter uses templated
+ * functions and so this made the most sense.
+ * 
+ */
\ No newline at end of file
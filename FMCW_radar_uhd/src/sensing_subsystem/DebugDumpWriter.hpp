@@ -0,0 +1,569 @@
+#ifndef DEBUGDUMPWRITER
+#define DEBUGDUMPWRITER
+
+    //C standard libraries
+    #include <iostream>
+    #include <cstdlib>
+    #include <string>
+    #include <vector>
+    #include <deque>
+    #include <map>
+    #include <memory>
+    #include <fstream>
+    #include <thread>
+    #include <mutex>
+    #include <condition_variable>
+    #include <chrono>
+    #include <algorithm>
+
+    //include the JSON handling capability
+    #include <nlohmann/json.hpp>
+
+    #include "../BufferHandler.hpp"
+
+    using json = nlohmann::json;
+    using Buffers::Buffer_1D;
+    using Buffers::Buffer_2D;
+    using Buffers::Array_2D;
+
+    namespace DebugDumpWriter_namespace{
+
+        /**
+         * @brief An artifact (a buffer saved to its own file) along with its pool of
+         * preallocated snapshot slots. The slots are only handed between the producer and
+         * the writer thread while the writer's mutex is held
+         *
+         */
+        class Dump_Artifact_Base{
+            public:
+                std::string path;
+                bool enabled;
+                std::ofstream stream;
+                bool open_failed; //the file couldn't be opened this run (writer thread only)
+                std::vector<size_t> free_slots;
+
+                //statistics
+                size_t num_written; //writer thread only
+                size_t num_dropped; //protected by the writer's mutex
+
+                Dump_Artifact_Base(const std::string & file_path, bool artifact_enabled)
+                    : path(file_path), enabled(artifact_enabled), open_failed(false), num_written(0), num_dropped(0) {}
+                virtual ~Dump_Artifact_Base() {}
+
+                /**
+                 * @brief Write a slot to the artifact's file (opening the file if needed)
+                 *
+                 * @param slot the index of the slot to write
+                 * @return size_t the number of bytes written
+                 */
+                virtual size_t write_slot(size_t slot) = 0;
+
+            protected:
+                /**
+                 * @brief Append samples to the artifact's file, the file is opened (and truncated)
+                 * by the first write after it was closed
+                 *
+                 * @param data pointer to the samples
+                 * @param num_bytes the number of bytes to write
+                 * @return size_t the number of bytes written
+                 */
+                size_t write_bytes(const char * data, size_t num_bytes){
+                    if (open_failed)
+                    {
+                        return 0;
+                    }
+                    if (! stream.is_open())
+                    {
+                        stream.open(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+                        if (! stream.is_open())
+                        {
+                            std::cerr << "DebugDumpWriter::write_bytes: couldn't open " << path <<
+                                        ", skipping the artifact for this run" << std::endl;
+                            open_failed = true;
+                            return 0;
+                        }
+                    }
+                    stream.write(data, num_bytes);
+                    num_written += 1;
+                    return num_bytes;
+                }
+        };
+
+        /**
+         * @brief an artifact whose snapshots are stored in containers of a given type
+         * (std::vector for Buffer_1D and Array_2D for Buffer_2D)
+         *
+         * @tparam container_type the type of container storing a snapshot
+         */
+        template<typename container_type>
+        class Dump_Artifact : public Dump_Artifact_Base{
+            public:
+                std::vector<container_type> slots;
+
+                Dump_Artifact(const std::string & file_path, bool artifact_enabled)
+                    : Dump_Artifact_Base(file_path, artifact_enabled) {}
+
+                size_t write_slot(size_t slot){
+                    return write_bytes(reinterpret_cast<const char *>(slots[slot].data()),
+                                        num_snapshot_samples(slots[slot]) * sizeof(*slots[slot].data()));
+                }
+
+            private:
+                template<typename sample_type, typename allocator_type>
+                static size_t num_snapshot_samples(const std::vector<sample_type,allocator_type> & snapshot){
+                    return snapshot.size();
+                }
+
+                template<typename sample_type>
+                static size_t num_snapshot_samples(const Array_2D<sample_type> & snapshot){
+                    return snapshot.num_samples();
+                }
+        };
+
+        /**
+         * @brief A background writer for debug dumps (intermediate buffers saved for offline
+         * analysis). Buffers are snapshotted by swapping their storage with a preallocated slot
+         * from the artifact's pool (the buffer gets the slot's storage, which has the same size),
+         * and a writer thread appends the snapshots to one file per artifact. Each file is opened
+         * once per run rather than per save, and the caller never waits on the filesystem: if every
+         * slot of an artifact is still waiting to be written, the snapshot is dropped and counted
+         * instead. Configured by the "DebugDumpSettings" in the config:
+         *  "enabled" - true to save any dumps (default: false)
+         *  "output_dir" - the directory to save the dumps in, each artifact is saved to cpp_<name>.bin
+         *      (required when the dumps are enabled)
+         *  "slots_per_artifact" - the number of preallocated snapshot slots for each artifact (default: 2)
+         *  "dump_every_frame" - true to append each frame's buffers to the files instead of only the
+         *      final frame's (default: false)
+         *  "artifacts" - an object with a true/false flag for each artifact (artifacts are enabled by default)
+         *
+         */
+        class DebugDumpWriter{
+            private:
+                //a snapshot waiting to be written
+                struct Dump_Job {
+                    Dump_Artifact_Base * artifact; //nullptr marks the end of a run
+                    size_t slot; //the number of snapshots dropped during the run for the end of a run
+                };
+
+                //configuration
+                bool enabled;
+                bool dump_every_frame;
+                std::string output_dir;
+                size_t slots_per_artifact;
+                json artifact_flags;
+
+                //artifacts
+                std::map<std::string, std::unique_ptr<Dump_Artifact_Base>> artifacts;
+
+                //job queue
+                std::mutex queue_mutex;
+                std::condition_variable queue_cv;
+                std::deque<Dump_Job> job_queue;
+
+                //writer thread
+                std::thread writer_thread;
+                bool stop_requested;
+                bool writer_running;
+
+                //statistics (writer thread)
+                size_t bytes_written;
+                double write_time_s;
+
+            public:
+
+                /**
+                 * @brief Construct a new DebugDumpWriter object
+                 *
+                 * @param config a json object with the DebugDumpSettings (optional)
+                 */
+                DebugDumpWriter(json config)
+                    : enabled(false),
+                    dump_every_frame(false),
+                    output_dir(""),
+                    slots_per_artifact(2),
+                    stop_requested(false),
+                    writer_running(false),
+                    bytes_written(0),
+                    write_time_s(0){
+
+                    json & settings = config["DebugDumpSettings"];
+                    if (settings["enabled"].is_null() == false)
+                    {
+                        enabled = settings["enabled"].get<bool>();
+                    }
+                    if (settings["output_dir"].is_null() == false)
+                    {
+                        output_dir = settings["output_dir"].get<std::string>();
+                    }
+                    if (settings["slots_per_artifact"].is_null() == false)
+                    {
+                        slots_per_artifact = std::max<size_t>(1, settings["slots_per_artifact"].get<size_t>());
+                    }
+                    if (settings["dump_every_frame"].is_null() == false)
+                    {
+                        dump_every_frame = settings["dump_every_frame"].get<bool>();
+                    }
+                    artifact_flags = settings["artifacts"];
+
+                    if (enabled && output_dir.empty())
+                    {
+                        std::cerr << "DebugDumpWriter: output_dir not specified in DebugDumpSettings, disabling the debug dumps" << std::endl;
+                        enabled = false;
+                    }
+                }
+
+                /**
+                 * @brief Destroy the DebugDumpWriter object (writes any remaining snapshots)
+                 *
+                 */
+                ~DebugDumpWriter(){
+                    stop();
+                }
+
+                /**
+                 * @brief true if dumps should be saved for every frame instead of only the final frame
+                 *
+                 */
+                bool every_frame(void) const{
+                    return enabled && dump_every_frame;
+                }
+
+                /**
+                 * @brief Register an artifact and preallocate its snapshot slots
+                 *
+                 * @param name the name of the artifact (saved to output_dir/cpp_<name>.bin)
+                 * @param like a buffer with the size (and capacity) of the buffer that will be dumped
+                 */
+                template<typename sample_type>
+                void register_artifact(const std::string & name, const Buffer_1D<sample_type> & like){
+                    Dump_Artifact<std::vector<sample_type>> * artifact = add_artifact<std::vector<sample_type>>(name);
+                    if (artifact != nullptr)
+                    {
+                        for (size_t i = 0; i < artifact -> slots.size(); i++)
+                        {
+                            artifact -> slots[i].reserve(std::max(like.buffer.capacity(), like.buffer.size()));
+                            artifact -> slots[i].resize(like.buffer.size());
+                        }
+                    }
+                }
+
+                /**
+                 * @brief Register an artifact and preallocate its snapshot slots
+                 *
+                 * @param name the name of the artifact (saved to output_dir/cpp_<name>.bin)
+                 * @param like a buffer with the dimensions of the buffer that will be dumped
+                 */
+                template<typename sample_type>
+                void register_artifact(const std::string & name, const Buffer_2D<sample_type> & like){
+                    Dump_Artifact<Array_2D<sample_type>> * artifact = add_artifact<Array_2D<sample_type>>(name);
+                    if (artifact != nullptr)
+                    {
+                        for (size_t i = 0; i < artifact -> slots.size(); i++)
+                        {
+                            artifact -> slots[i] = Array_2D<sample_type>(like.buffer.size(), like.num_cols);
+                        }
+                    }
+                }
+
+                /**
+                 * @brief Start the writer thread (if needed) for a new run, each artifact's file is
+                 * truncated by its first dump of the run
+                 *
+                 */
+                void start_run(void){
+                    if (enabled && (! writer_running))
+                    {
+                        stop_requested = false;
+                        writer_thread = std::thread([this]() {
+                            run_writer();
+                        });
+                        writer_running = true;
+                    }
+                }
+
+                /**
+                 * @brief Mark the end of a run (returns immediately), the writer thread closes the files
+                 * once it has written every snapshot from the run
+                 *
+                 */
+                void end_run(void){
+                    if (writer_running)
+                    {
+                        size_t num_dropped = 0;
+                        {
+                            std::lock_guard<std::mutex> lock(queue_mutex);
+                            for (std::map<std::string, std::unique_ptr<Dump_Artifact_Base>>::iterator it = artifacts.begin();
+                                it != artifacts.end(); ++it)
+                            {
+                                num_dropped += it -> second -> num_dropped;
+                                it -> second -> num_dropped = 0;
+                            }
+                        }
+                        submit_job(nullptr, num_dropped);
+                    }
+                }
+
+                /**
+                 * @brief Snapshot a buffer by swapping its storage with a free slot. The buffer's
+                 * contents are left unspecified (but it keeps its size), so only buffers that are
+                 * rewritten before they are next read can be dumped this way
+                 *
+                 * @param name the name of the (registered) artifact
+                 * @param buffer the buffer to snapshot
+                 */
+                template<typename sample_type>
+                void dump(const std::string & name, Buffer_1D<sample_type> & buffer){
+                    Dump_Artifact<std::vector<sample_type>> * artifact = find_artifact<std::vector<sample_type>>(name);
+                    size_t slot;
+                    if (artifact == nullptr || (! acquire_slot(artifact, slot)))
+                    {
+                        return;
+                    }
+                    std::vector<sample_type> & snapshot = artifact -> slots[slot];
+                    size_t capacity = buffer.buffer.capacity();
+                    snapshot.resize(buffer.buffer.size());
+                    snapshot.swap(buffer.buffer);
+
+                    //keep the buffer's capacity (so it isn't reallocated when it grows next frame)
+                    buffer.buffer.reserve(capacity);
+                    buffer.num_samples = buffer.buffer.size();
+                    submit_job(artifact, slot);
+                }
+
+                /**
+                 * @brief Snapshot a buffer by swapping its storage with a free slot. The buffer's
+                 * contents are left unspecified, so only buffers that are rewritten before they are
+                 * next read can be dumped this way
+                 *
+                 * @param name the name of the (registered) artifact
+                 * @param buffer the buffer to snapshot
+                 */
+                template<typename sample_type>
+                void dump(const std::string & name, Buffer_2D<sample_type> & buffer){
+                    Dump_Artifact<Array_2D<sample_type>> * artifact = find_artifact<Array_2D<sample_type>>(name);
+                    size_t slot;
+                    if (artifact == nullptr || (! acquire_slot(artifact, slot)))
+                    {
+                        return;
+                    }
+                    Array_2D<sample_type> & snapshot = artifact -> slots[slot];
+                    if (snapshot.size() != buffer.buffer.size() || snapshot.num_samples() != buffer.buffer.num_samples())
+                    {
+                        snapshot = Array_2D<sample_type>(buffer.num_rows, buffer.num_cols);
+                    }
+                    std::swap(snapshot, buffer.buffer);
+                    submit_job(artifact, slot);
+                }
+
+                /**
+                 * @brief Snapshot a buffer by copying it into a free slot (for buffers that are
+                 * still needed after the dump, ex: the hanning window)
+                 *
+                 * @param name the name of the (registered) artifact
+                 * @param buffer the buffer to snapshot
+                 */
+                template<typename sample_type>
+                void dump_copy(const std::string & name, const Buffer_1D<sample_type> & buffer){
+                    Dump_Artifact<std::vector<sample_type>> * artifact = find_artifact<std::vector<sample_type>>(name);
+                    size_t slot;
+                    if (artifact == nullptr || (! acquire_slot(artifact, slot)))
+                    {
+                        return;
+                    }
+                    artifact -> slots[slot].assign(buffer.buffer.begin(), buffer.buffer.end());
+                    submit_job(artifact, slot);
+                }
+
+                /**
+                 * @brief Write every remaining snapshot and stop the writer thread
+                 *
+                 */
+                void stop(void){
+                    if (writer_running)
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock(queue_mutex);
+                            stop_requested = true;
+                        }
+                        queue_cv.notify_all();
+                        writer_thread.join();
+                        writer_running = false;
+                    }
+                }
+
+            private:
+
+                /**
+                 * @brief Create an artifact and its (empty) slots
+                 *
+                 * @param name the name of the artifact
+                 * @return Dump_Artifact<container_type>* the new artifact, or nullptr if dumps are disabled
+                 */
+                template<typename container_type>
+                Dump_Artifact<container_type> * add_artifact(const std::string & name){
+                    if (! enabled)
+                    {
+                        return nullptr;
+                    }
+
+                    bool artifact_enabled = true;
+                    if (artifact_flags.is_object() && artifact_flags[name].is_null() == false)
+                    {
+                        artifact_enabled = artifact_flags[name].get<bool>();
+                    }
+
+                    std::unique_ptr<Dump_Artifact<container_type>> artifact(
+                        new Dump_Artifact<container_type>(output_dir + "/cpp_" + name + ".bin", artifact_enabled));
+                    Dump_Artifact<container_type> * artifact_ptr = artifact.get();
+                    if (artifact_enabled)
+                    {
+                        artifact -> slots.resize(slots_per_artifact);
+                        for (size_t i = 0; i < slots_per_artifact; i++)
+                        {
+                            artifact -> free_slots.push_back(i);
+                        }
+                    }
+
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    artifacts[name] = std::move(artifact);
+                    return artifact_ptr;
+                }
+
+                /**
+                 * @brief Find an enabled artifact
+                 *
+                 * @param name the name of the artifact
+                 * @return Dump_Artifact<container_type>* the artifact, or nullptr if it is disabled
+                 * (or wasn't registered with the given type)
+                 */
+                template<typename container_type>
+                Dump_Artifact<container_type> * find_artifact(const std::string & name){
+                    if (! writer_running)
+                    {
+                        return nullptr;
+                    }
+                    std::map<std::string, std::unique_ptr<Dump_Artifact_Base>>::iterator it = artifacts.find(name);
+                    if (it == artifacts.end())
+                    {
+                        std::cerr << "DebugDumpWriter::find_artifact: " << name << " wasn't registered" << std::endl;
+                        return nullptr;
+                    }
+                    if (! it -> second -> enabled)
+                    {
+                        return nullptr;
+                    }
+                    return dynamic_cast<Dump_Artifact<container_type> *>(it -> second.get());
+                }
+
+                /**
+                 * @brief Take a free slot from an artifact's pool
+                 *
+                 * @param artifact the artifact
+                 * @param slot set to the index of the free slot
+                 * @return true - a slot was free
+                 * @return false - every slot is waiting to be written (the snapshot is dropped)
+                 */
+                bool acquire_slot(Dump_Artifact_Base * artifact, size_t & slot){
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    if (artifact -> free_slots.empty())
+                    {
+                        artifact -> num_dropped += 1;
+                        return false;
+                    }
+                    slot = artifact -> free_slots.back();
+                    artifact -> free_slots.pop_back();
+                    return true;
+                }
+
+                /**
+                 * @brief Queue a snapshot (or the end of a run) for the writer thread
+                 *
+                 * @param artifact the artifact (nullptr for the end of a run)
+                 * @param slot the slot holding the snapshot
+                 */
+                void submit_job(Dump_Artifact_Base * artifact, size_t slot){
+                    Dump_Job job;
+                    job.artifact = artifact;
+                    job.slot = slot;
+                    {
+                        std::lock_guard<std::mutex> lock(queue_mutex);
+                        job_queue.push_back(job);
+                    }
+                    queue_cv.notify_one();
+                }
+
+                /**
+                 * @brief writer thread loop, writes queued snapshots until stop() is called
+                 * and the queue has been drained
+                 *
+                 */
+                void run_writer(void){
+                    while (true)
+                    {
+                        Dump_Job job;
+                        {
+                            std::unique_lock<std::mutex> lock(queue_mutex);
+                            queue_cv.wait(lock, [this]() {
+                                return (! job_queue.empty()) || stop_requested;
+                            });
+                            if (job_queue.empty())
+                            {
+                                lock.unlock();
+                                close_files(0);
+                                return;
+                            }
+                            job = job_queue.front();
+                            job_queue.pop_front();
+                        }
+
+                        if (job.artifact == nullptr)
+                        {
+                            close_files(job.slot);
+                            continue;
+                        }
+
+                        //write the snapshot and return its slot to the pool
+                        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                        bytes_written += job.artifact -> write_slot(job.slot);
+                        write_time_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                        {
+                            std::lock_guard<std::mutex> lock(queue_mutex);
+                            job.artifact -> free_slots.push_back(job.slot);
+                        }
+                    }
+                }
+
+                /**
+                 * @brief Close each artifact's file (so that the next run truncates it) and print
+                 * the number of dumps written during the run (writer thread only)
+                 *
+                 * @param num_dropped the number of snapshots dropped during the run
+                 */
+                void close_files(size_t num_dropped){
+                    size_t num_written = 0;
+                    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                    for (std::map<std::string, std::unique_ptr<Dump_Artifact_Base>>::iterator it = artifacts.begin();
+                        it != artifacts.end(); ++it)
+                    {
+                        num_written += it -> second -> num_written;
+                        it -> second -> num_written = 0;
+                        it -> second -> open_failed = false;
+                        if (it -> second -> stream.is_open())
+                        {
+                            it -> second -> stream.close();
+                        }
+                    }
+                    write_time_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                    if (num_written + num_dropped > 0)
+                    {
+                        std::cout << "DebugDumpWriter::close_files: saved " << num_written << " dumps (" <<
+                                    static_cast<double>(bytes_written) * 1e-6 << " MB in " << write_time_s * 1e3 <<
+                                    " ms) to " << output_dir << ", dropped " << num_dropped << " (no free slots)" << std::endl;
+                    }
+                    bytes_written = 0;
+                    write_time_s = 0;
+                }
+        };
+    }
+#endif
@@ -9,13 +9,20 @@
     #include <vector>
     #include <csignal>
     #include <thread>
+    #include <algorithm>
+    #include <cstdint>
 
     #define _USE_MATH_DEFINES
     #include <cmath>
 
     //include the JSON handling capability
     #include <nlohmann/json.hpp>
+
+    //uhd time specs
+    #include <uhd/types/time_spec.hpp>
+
     #include "../BufferHandler.hpp"
+    #include "../SIMDKernels.hpp"
 
     using json = nlohmann::json;
     using namespace Buffers;
@@ -40,11 +47,35 @@
 
                 //parameters for chirp energy detection
                 size_t current_chirp_detector_index;
-                Buffers::Buffer_1D<data_type> chirp_detection_times;
+                std::vector<uhd::time_spec_t> chirp_detection_times; //start time of each row in the chirp detector
+
+                //sliding window energy detection (running sum of |x|^2 over the last window_size samples)
+                size_t window_size;
+                double window_energy;
+                double window_energy_threshold; //linear threshold on window_energy
+                size_t num_samples_processed; //since the last reset, also the index of the next sample in the chirp detector
+                static const size_t energy_detection_block_size = 64; //samples per SIMDKernels call in check_for_chirp
+
+                //detection results
+                size_t detection_sample_idx; //sample (since the last reset) at which the threshold was crossed
+                size_t detection_start_sample_idx; //first sample of the window that crossed the threshold
+
+                //noise floor tracking (exponential moving average of the power of idle rows)
+                double noise_floor_power; //linear (same units as compute_signal_power)
+                double noise_floor_tracking_alpha; //0 disables tracking
+                double noise_floor_guard; //linear, idle rows more than this factor above the floor are ignored
+                double threshold_factor; //linear version of threshold_level
+                data_type initial_noise_power; //dB, from compute_relative_noise_power()
+                size_t num_noise_floor_updates;
             public:
                 size_t num_rows_chirp_detector;
                 Buffers::Buffer_2D<std::complex<data_type>> noise_power_measureent_signal;
                 Buffers::Buffer_2D<std::complex<data_type>> chirp_detector_signal;
+
+                //sc16 chirp detection (the chirp detector is filled with the USRP's raw sc16 samples
+                //instead of chirp_detector_signal, only allocated when enabled)
+                bool sc16_chirp_detection;
+                Buffers::Buffer_2D<std::complex<int16_t>> chirp_detector_signal_sc16;
                 
 
 
@@ -105,6 +136,11 @@
                     std::cerr << "EnergyDetector::check_config: energy_detector_num_rows_chirp_detector not specified" <<std::endl;
                     config_good = false;
                 }
+                else if (config["SensingSubsystemSettings"]["energy_detector_num_rows_chirp_detector"].get<size_t>() < 2)
+                {
+                    std::cerr << "EnergyDetector::check_config: energy_detector_num_rows_chirp_detector must be at least 2" <<std::endl;
+                    config_good = false;
+                }
 
 
                 return config_good;
@@ -171,41 +207,231 @@
                 //initialize the chirp detector index to 0
                 current_chirp_detector_index = 0;
 
-                chirp_detector_signal = Buffer_2D<std::complex<data_type>>(num_rows_chirp_detector,samples_per_buffer);
-                chirp_detection_times = Buffer_1D<data_type>(num_rows_chirp_detector);
+                //only the chirp detector for the configured rx format is allocated
+                sc16_chirp_detection = false;
+                if (config["USRPSettings"]["AdditionalSettings"]["sc16_chirp_detection"].is_null() == false)
+                {
+                    sc16_chirp_detection = config["USRPSettings"]["AdditionalSettings"]["sc16_chirp_detection"].get<bool>();
+                }
+                size_t num_rows_fc = sc16_chirp_detection ? 0 : num_rows_chirp_detector;
+                size_t num_rows_sc16 = sc16_chirp_detection ? num_rows_chirp_detector : 0;
+                chirp_detector_signal = Buffer_2D<std::complex<data_type>>(num_rows_fc,samples_per_buffer);
+                chirp_detector_signal_sc16 = Buffer_2D<std::complex<int16_t>>(num_rows_sc16,samples_per_buffer);
+                chirp_detection_times = std::vector<uhd::time_spec_t>(num_rows_chirp_detector);
+
+                //set the sliding window size (the oldest sample in the window must still be in the chirp detector)
+                if (config["SensingSubsystemSettings"]["energy_detection_window_samples"].is_null() == false)
+                {
+                    window_size = config["SensingSubsystemSettings"]["energy_detection_window_samples"].get<size_t>();
+                }
+                else{
+                    window_size = 500;
+                }
+                size_t max_window_size = (num_rows_chirp_detector - 1) * samples_per_buffer;
+                if (window_size > max_window_size)
+                {
+                    std::cerr << "EnergyDetector::initialize_chirp_detection_params: energy_detection_window_samples larger than " <<
+                                max_window_size << " samples, using " << max_window_size << " samples" << std::endl;
+                    window_size = max_window_size;
+                }
+                else if (window_size == 0)
+                {
+                    window_size = 1;
+                }
+
+                initialize_noise_floor_tracking();
+                reset_chirp_detector();
             }
 
             /**
-             * @brief Compute the power of a given rx signal
+             * @brief initialize the parameters used to track the noise floor from idle rows
              * 
-             * @param rx_signal the rx signal to compute the power of
-             * @param num_samples the maximum number of samples to use for energy detection,
-             * when set to zero (default), will use the size of the rx signal
-             * @return data_type the computed signal power level
              */
-            data_type compute_signal_power (std::vector<std::complex<data_type>> & rx_signal,
-                                            size_t num_samples = 0){
-                
-                
-                if (num_samples == 0)
+            void initialize_noise_floor_tracking(){
+
+                //set the moving average weight given to each idle row
+                if (config["SensingSubsystemSettings"]["noise_floor_tracking_alpha"].is_null() == false)
                 {
-                    num_samples = rx_signal.size();
+                    noise_floor_tracking_alpha = config["SensingSubsystemSettings"]["noise_floor_tracking_alpha"].get<double>();
                 }
+                else{
+                    noise_floor_tracking_alpha = 0.01;
+                }
+                if ((noise_floor_tracking_alpha < 0) || (noise_floor_tracking_alpha > 1))
+                {
+                    std::cerr << "EnergyDetector::initialize_noise_floor_tracking: noise_floor_tracking_alpha must be between 0 and 1, disabling tracking" << std::endl;
+                    noise_floor_tracking_alpha = 0;
+                }
+
+                //set the guard above the noise floor for rows to be used for tracking
+                double noise_floor_guard_dB = 3.0;
+                if (config["SensingSubsystemSettings"]["noise_floor_guard_dB"].is_null() == false)
+                {
+                    noise_floor_guard_dB = config["SensingSubsystemSettings"]["noise_floor_guard_dB"].get<double>();
+                }
+                noise_floor_guard = std::pow(10.0, noise_floor_guard_dB / 10.0);
+
+                threshold_factor = std::pow(10.0, static_cast<double>(threshold_level) / 10.0);
+                set_noise_floor(relative_noise_power);
+                initial_noise_power = relative_noise_power;
+                num_noise_floor_updates = 0;
+            }
+
+            /**
+             * @brief Set the noise floor (and the chirp detection threshold)
+             * 
+             * @param noise_power_dB the noise power in dB
+             */
+            void set_noise_floor(data_type noise_power_dB){
+                relative_noise_power = noise_power_dB;
+                noise_floor_power = std::pow(10.0, static_cast<double>(noise_power_dB) / 10.0);
+                update_window_energy_threshold();
+            }
+
+            /**
+             * @brief Update the noise floor using the power of a row that didn't contain a chirp
+             * 
+             * @param row_energy the sum of |x|^2 over the row
+             */
+            void update_noise_floor(double row_energy){
                 
+                double row_power = row_energy * static_cast<double>(sampling_frequency) / static_cast<double>(samples_per_buffer);
+
+                //ignore rows that are likely to contain the start of a chirp
+                if ((noise_floor_tracking_alpha == 0) || (row_power > (noise_floor_power * noise_floor_guard)))
+                {
+                    return;
+                }
+
+                noise_floor_power += noise_floor_tracking_alpha * (row_power - noise_floor_power);
+                relative_noise_power = static_cast<data_type>(10 * std::log10(noise_floor_power));
+                update_window_energy_threshold();
+                num_noise_floor_updates += 1;
+            }
+
+            /**
+             * @brief Get the current noise floor
+             * 
+             * @return data_type the current noise floor in dB
+             */
+            data_type get_noise_floor_dB(){
+                return relative_noise_power;
+            }
+
+            /**
+             * @brief Get the noise floor measured by compute_relative_noise_power() (before any tracking)
+             * 
+             * @return data_type the initial noise floor in dB
+             */
+            data_type get_initial_noise_floor_dB(){
+                return initial_noise_power;
+            }
+
+            /**
+             * @brief Get the number of idle rows that have updated the noise floor
+             * 
+             * @return size_t the number of updates
+             */
+            size_t get_num_noise_floor_updates(){
+                return num_noise_floor_updates;
+            }
+
+            /**
+             * @brief Compute the linear threshold on the sliding window energy
+             * corresponding to threshold_level dB above the relative noise power
+             * 
+             */
+            void update_window_energy_threshold(){
+                double window_period = static_cast<double>(window_size) / static_cast<double>(sampling_frequency);
+                window_energy_threshold = window_period * noise_floor_power * threshold_factor;
+            }
+
+            /**
+             * @brief Compute the energy (sum of |x|^2) of a sample or of consecutive samples, sc16
+             * samples are scaled by 1/32767 (to match the fc32 conversion)
+             * 
+             */
+            static inline double sample_energy(const std::complex<data_type> & sample){
+                return static_cast<double>(std::norm(sample));
+            }
+
+            static inline double sample_energy(const std::complex<int16_t> & sample){
+                int32_t re = sample.real();
+                int32_t im = sample.imag();
+                return static_cast<double>(re * re + im * im) / (32767.0 * 32767.0);
+            }
+
+            static inline double samples_energy(const std::complex<data_type> * samples, size_t num_samples){
+                return SIMDKernels::signal_energy(samples, num_samples);
+            }
+
+            static inline double samples_energy(const std::complex<int16_t> * samples, size_t num_samples){
+                return SIMDKernels::signal_energy(samples, num_samples) / (32767.0 * 32767.0);
+            }
+
+            /**
+             * @brief Compute the energy (sum of |x|^2) of consecutive samples in the chirp detector,
+             * wrapping around to the first row if needed
+             * 
+             * @tparam sample_type the type of the chirp detector's samples (data_type or int16_t)
+             * @param ring pointer to the first sample of the chirp detector
+             * @param ring_size the number of samples in the chirp detector
+             * @param start the position (in the chirp detector) of the first sample
+             * @param num_samples the number of samples
+             * @return double the sum of |x|^2 over the samples
+             */
+            template<typename sample_type>
+            inline double ring_energy(const std::complex<sample_type> * ring, size_t ring_size,
+                                        size_t start, size_t num_samples){
+                if (start + num_samples <= ring_size)
+                {
+                    return samples_energy(ring + start, num_samples);
+                }
+                return samples_energy(ring + start, ring_size - start) +
+                    samples_energy(ring, start + num_samples - ring_size);
+            }
+
+            /**
+             * @brief Compute the power of a given rx signal
+             * 
+             * @param rx_signal pointer to the first sample of the rx signal to compute the power of
+             * @param num_samples the number of samples to use for energy detection
+             * @return data_type the computed signal power level
+             */
+            data_type compute_signal_power (const std::complex<data_type> * rx_signal,
+                                            size_t num_samples){
                 
                 //get determine the sampling period of the rx_signal
                 data_type sampling_period = static_cast<data_type>(num_samples) / sampling_frequency;
                 
-                //compute the sum of the elements
-                data_type sum;
+                //compute the sum of |x|^2 (vectorized, see SIMDKernels)
+                double sum = SIMDKernels::signal_energy(rx_signal, num_samples);
 
-                for (size_t i = 0; i < num_samples; i++)
-                {
-                    sum += ((real(rx_signal[i]) * real(rx_signal[i])) + (imag(rx_signal[i]) * imag(rx_signal[i])));
-                }
+                //convert to dB and return
+                data_type power = static_cast<data_type>(10 * std::log10(sum/sampling_period));
+                return power;
+            }
+
+            /**
+             * @brief Compute the power of a given rx signal that is still in the
+             * USRP's interleaved int16 (sc16) format, scaled to match the power of the
+             * converted (fc32/fc64) signal
+             * 
+             * @param rx_signal pointer to the first sample of the sc16 rx signal
+             * @param num_samples the number of samples to use for energy detection
+             * @return data_type the computed signal power level
+             */
+            data_type compute_signal_power (const std::complex<int16_t> * rx_signal,
+                                            size_t num_samples){
+                
+                //get determine the sampling period of the rx_signal
+                data_type sampling_period = static_cast<data_type>(num_samples) / sampling_frequency;
+
+                //compute the sum of |x|^2 scaled to the full scale of the converted samples
+                double sum = samples_energy(rx_signal, num_samples);
 
                 //convert to dB and return
-                data_type power = 10 * std::log10(sum/sampling_period);
+                data_type power = static_cast<data_type>(10 * std::log10(sum/sampling_period));
                 return power;
             }
 
@@ -215,21 +441,11 @@
              */
             void compute_relative_noise_power(){
 
-                //flatten the noise power measurement signal
-                std::vector<std::complex<data_type>> sampled_signal(num_samples_noise_power_measurement_signal);
-                size_t to_idx = 0;
-                for (size_t i = 0; i < num_rows_noise_power_measurement_signal; i++)
-                {
-                    for (size_t j = 0; j < samples_per_buffer; j++)
-                    {
-                        to_idx = (samples_per_buffer * i) + j;
-                        sampled_signal[to_idx] = noise_power_measureent_signal.buffer[i][j];
-                    }
-                }
-
-
-                //set the relative noise power
-                relative_noise_power = compute_signal_power(sampled_signal);
+                //the noise power measurement signal is stored contiguously, so compute the power over all of its samples
+                set_noise_floor(compute_signal_power(
+                    noise_power_measureent_signal.buffer.data(),
+                    num_samples_noise_power_measurement_signal));
+                initial_noise_power = relative_noise_power;
                 return;
             }
 
@@ -243,7 +459,7 @@
             bool check_for_chirp(std::vector<std::complex<data_type>> & rx_signal){
 
                 //compute the rx signal power and determine if it is sufficiently higher than the threshold
-                if ((compute_signal_power(rx_signal) - relative_noise_power) >= threshold_level )
+                if ((compute_signal_power(rx_signal.data(),rx_signal.size()) - relative_noise_power) >= threshold_level )
                 {
                     return true;
                 }
@@ -254,29 +470,32 @@
             }
 
             /**
-             * @brief Check to see if a chirp was detected in the current chirp detection signal buffer
+             * @brief Check to see if a chirp was detected in the current chirp detection signal buffer.
+             * Slides a window_size sample window over the new row (keeping a running sum of |x|^2
+             * across row boundaries) and stops at the first sample where the window's power is
+             * threshold_level dB above the relative noise power. The row is processed in blocks whose
+             * energies are computed with SIMDKernels, a block is only checked one sample at a time when
+             * the window could cross the threshold within it. Rows without a chirp are used to update
+             * the noise floor
              * 
              * @param signal_start_time the time that the current chirp detection signal started at
              * @return true - chirp detected
              * @return false - chirp not detected
              */
-            bool check_for_chirp(double signal_start_time){
+            bool check_for_chirp(const uhd::time_spec_t & signal_start_time){
 
-                chirp_detection_times.buffer[current_chirp_detector_index] = static_cast<data_type>(signal_start_time);
+                chirp_detection_times[current_chirp_detector_index] = signal_start_time;
 
-                bool chirp_detected = false;
-                data_type signal_power = compute_signal_power(chirp_detector_signal.buffer[current_chirp_detector_index], 500);
-                if ((signal_power
-                     - relative_noise_power) >= threshold_level )
-                {
-                    chirp_detected = true;
-                }
-                else{
-                    chirp_detected = false;
-                }
-                //update the current chirp_detector index if no chirp was detected
+                //the chirp detector rows are stored contiguously, so treat them as a ring of samples
+                double row_energy = 0;
+                bool chirp_detected = sc16_chirp_detection ?
+                    slide_detection_window(chirp_detector_signal_sc16.buffer.data(), row_energy) :
+                    slide_detection_window(chirp_detector_signal.buffer.data(), row_energy);
+
+                //update the noise floor and the current chirp_detector index if no chirp was detected
                 if (! chirp_detected)
                 {
+                    update_noise_floor(row_energy);
                     current_chirp_detector_index += 1;
                     current_chirp_detector_index = current_chirp_detector_index % num_rows_chirp_detector;
                 }
@@ -284,6 +503,123 @@
                 return chirp_detected;
             }
 
+            /**
+             * @brief Slide the detection window over the current row of the chirp detector (see check_for_chirp)
+             * 
+             * @tparam sample_type the type of the chirp detector's samples (data_type or int16_t)
+             * @param ring pointer to the first sample of the chirp detector
+             * @param row_energy set to the sum of |x|^2 over the samples of the row that were processed
+             * @return true - chirp detected
+             * @return false - chirp not detected
+             */
+            template<typename sample_type>
+            bool slide_detection_window(const std::complex<sample_type> * ring, double & row_energy){
+
+                size_t ring_size = num_rows_chirp_detector * samples_per_buffer;
+                size_t row_start = current_chirp_detector_index * samples_per_buffer;
+
+                //position (in the ring) of the sample leaving the window
+                size_t old_sample_pos = (row_start + ring_size - (window_size % ring_size)) % ring_size;
+
+                double block_energy;
+                double new_sample_energy;
+                size_t block_size;
+                for (size_t block_start = 0; block_start < samples_per_buffer; block_start += block_size)
+                {
+                    block_size = samples_per_buffer - block_start;
+                    if (block_size > energy_detection_block_size)
+                    {
+                        block_size = energy_detection_block_size;
+                    }
+                    block_energy = samples_energy(& ring[row_start + block_start], block_size);
+
+                    //removing samples only lowers the window energy, so a full window can only cross
+                    //the threshold in this block if it would with all of the block's samples added
+                    if ((num_samples_processed >= window_size) &&
+                        (window_energy + block_energy < window_energy_threshold))
+                    {
+                        window_energy += block_energy - ring_energy(ring, ring_size, old_sample_pos, block_size);
+                        row_energy += block_energy;
+                        old_sample_pos = (old_sample_pos + block_size) % ring_size;
+                        num_samples_processed += block_size;
+                        continue;
+                    }
+
+                    //otherwise slide the window one sample at a time
+                    for (size_t i = block_start; i < block_start + block_size; i++)
+                    {
+                        //add the new sample to the window
+                        new_sample_energy = sample_energy(ring[row_start + i]);
+                        window_energy += new_sample_energy;
+                        row_energy += new_sample_energy;
+
+                        //remove the sample that left the window
+                        if (num_samples_processed >= window_size)
+                        {
+                            window_energy -= sample_energy(ring[old_sample_pos]);
+                        }
+                        old_sample_pos += 1;
+                        if (old_sample_pos == ring_size)
+                        {
+                            old_sample_pos = 0;
+                        }
+                        num_samples_processed += 1;
+
+                        //check for a chirp once the window is full
+                        if ((num_samples_processed >= window_size) && (window_energy >= window_energy_threshold))
+                        {
+                            detection_sample_idx = num_samples_processed - 1;
+                            detection_start_sample_idx = num_samples_processed - window_size;
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+
+            /**
+             * @brief Get the time of the given sample in the chirp detector (the row containing the
+             * sample must still be in the chirp detector)
+             * 
+             * @param sample_idx the sample index (since the last reset)
+             * @return uhd::time_spec_t the time that the sample was received at
+             */
+            uhd::time_spec_t get_sample_time(size_t sample_idx){
+                size_t row = (sample_idx / samples_per_buffer) % num_rows_chirp_detector;
+                long long offset = static_cast<long long>(sample_idx % samples_per_buffer);
+                return chirp_detection_times[row] +
+                    uhd::time_spec_t::from_ticks(offset, static_cast<double>(sampling_frequency));
+            }
+
+            /**
+             * @brief Get the index (since the last reset) of the sample at which the
+             * energy threshold was crossed
+             * 
+             * @return size_t the detection sample index
+             */
+            size_t get_detection_sample_idx(){
+                return detection_sample_idx;
+            }
+
+            /**
+             * @brief Get the time at which the energy threshold was crossed
+             * 
+             * @return uhd::time_spec_t the detection time
+             */
+            uhd::time_spec_t get_detection_time(){
+                return get_sample_time(detection_sample_idx);
+            }
+
+            /**
+             * @brief Get the time of the first sample of the window that crossed the
+             * threshold (i.e: the first sample saved by save_chirp_detection_signal_to_buffer)
+             * 
+             * @return uhd::time_spec_t the detection start time
+             */
+            uhd::time_spec_t get_detection_start_time(){
+                return get_sample_time(detection_start_sample_idx);
+            }
+
             /**
              * @brief Get the current chirp detector index object
              * 
@@ -300,9 +636,7 @@
              * @return data_type 
              */
             data_type get_detection_start_time_us(){
-                size_t detection_idx = current_chirp_detector_index + 1;
-                detection_idx = detection_idx % num_rows_chirp_detector;
-                return chirp_detection_times.buffer[detection_idx] * 1e6;
+                return static_cast<data_type>(get_detection_start_time().get_real_secs() * 1e6);
             }
             
             /**
@@ -310,37 +644,81 @@
              * 
              */
             void reset_chirp_detector(){
-                //reset the detected times
+                //reset the chirp detector signal and the detected times
+                std::fill(chirp_detector_signal.buffer.data(),
+                    chirp_detector_signal.buffer.data() + chirp_detector_signal.buffer.num_samples(),
+                    std::complex<data_type>(0));
+                std::fill(chirp_detector_signal_sc16.buffer.data(),
+                    chirp_detector_signal_sc16.buffer.data() + chirp_detector_signal_sc16.buffer.num_samples(),
+                    std::complex<int16_t>(0));
                 for (size_t i = 0; i < num_rows_chirp_detector; i++)
                 {
-                    for (size_t j = 0; j < samples_per_buffer; j++)
-                    {
-                        chirp_detector_signal.buffer[i][j] = 0;
-                    }
-                    chirp_detection_times.buffer[i] = 0;   
+                    chirp_detection_times[i] = uhd::time_spec_t(0.0);
                 }
                 current_chirp_detector_index = 0;
+
+                //reset the sliding window
+                window_energy = 0;
+                num_samples_processed = 0;
+                detection_sample_idx = 0;
+                detection_start_sample_idx = 0;
             }
         
-            
-            void save_chirp_detection_signal_to_buffer(Buffer_2D<std::complex<data_type>> * rx_buffer){
+            /**
+             * @brief Copy the samples from the start of the detection window to the end of the
+             * row that the chirp was detected in to the start of the given buffer
+             * 
+             * @param rx_buffer the buffer to save the samples to
+             * @return size_t the number of samples saved (the remaining samples of the row
+             * should be received into rx_buffer starting at this sample)
+             */
+            size_t save_chirp_detection_signal_to_buffer(Buffer_2D<std::complex<data_type>> * rx_buffer){
 
-                size_t detection_idx = current_chirp_detector_index;
+                size_t ring_size = num_rows_chirp_detector * samples_per_buffer;
 
-                for (size_t i = 0; i < num_rows_chirp_detector; i++)
+                //samples from the window start through the end of the detection row
+                size_t row_end_sample_idx = (detection_sample_idx / samples_per_buffer + 1) * samples_per_buffer;
+                size_t num_samples = row_end_sample_idx - detection_start_sample_idx;
+                if (num_samples > rx_buffer -> buffer.num_samples())
                 {
-                    //incremeent the index 
-                    detection_idx += 1;
-                    detection_idx = detection_idx % num_rows_chirp_detector;
-
-                    for (size_t j = 0; j < samples_per_buffer; j++)
-                    {
-                        rx_buffer -> buffer[i][j] = chirp_detector_signal.buffer[detection_idx][j];
-                    }
-                    
+                    num_samples = rx_buffer -> buffer.num_samples();
+                }
 
+                //copy (at most) two contiguous runs out of the ring
+                size_t start_pos = detection_start_sample_idx % ring_size;
+                size_t first_run = std::min(num_samples, ring_size - start_pos);
+                if (sc16_chirp_detection)
+                {
+                    const std::complex<int16_t> * ring = chirp_detector_signal_sc16.buffer.data();
+                    convert_sc16(ring + start_pos, first_run, rx_buffer -> buffer.data());
+                    convert_sc16(ring, num_samples - first_run, rx_buffer -> buffer.data() + first_run);
+                }
+                else{
+                    const std::complex<data_type> * ring = chirp_detector_signal.buffer.data();
+                    std::copy(ring + start_pos, ring + start_pos + first_run, rx_buffer -> buffer.data());
+                    std::copy(ring, ring + (num_samples - first_run), rx_buffer -> buffer.data() + first_run);
                 }
                 
+                return num_samples;
+            }
+
+            /**
+             * @brief Convert sc16 samples to std::complex<data_type> (scaled by 1/32767 like
+             * UHD's sc16 to fc32 conversion)
+             * 
+             * @param samples pointer to the first sc16 sample
+             * @param num_samples the number of samples to convert
+             * @param converted pointer to where the converted samples should be written
+             */
+            static void convert_sc16(const std::complex<int16_t> * samples, size_t num_samples,
+                                        std::complex<data_type> * converted){
+                const data_type scale = static_cast<data_type>(1.0 / 32767.0);
+                for (size_t i = 0; i < num_samples; i++)
+                {
+                    converted[i] = std::complex<data_type>(
+                        static_cast<data_type>(samples[i].real()) * scale,
+                        static_cast<data_type>(samples[i].imag()) * scale);
+                }
             }
 
         };
@@ -0,0 +1,326 @@
+#ifndef FRAMETRACKER
+#define FRAMETRACKER
+
+    //C standard libraries
+    #include <iostream>
+    #include <cstdlib>
+    #include <string>
+    #include <vector>
+    #include <algorithm>
+
+    #define _USE_MATH_DEFINES
+    #include <cmath>
+
+    //include the JSON handling capability
+    #include <nlohmann/json.hpp>
+
+    #include "../BufferHandler.hpp"
+
+    using json = nlohmann::json;
+    using namespace Buffers;
+
+    namespace FrameTracker_namespace{
+
+        /**
+         * @brief Recursive tracker for the victim's frames. The frame start time and frame
+         * period are tracked with an alpha-beta filter (starting with growing memory gains, so that
+         * the first frames give the least squares fit, until they reach the configured steady state gains)
+         * and the chirp slope and chirp duration are tracked as running weighted means. Each update
+         * takes constant time, so the tracker can run indefinitely, and only the most recent frames
+         * are kept in a bounded history ring for diagnostics
+         *
+         * @tparam data_type the data type of the estimated parameters
+         */
+        template<typename data_type>
+        class FrameTracker{
+            private:
+                //configuration
+                json config;
+
+                //steady state alpha-beta filter gains
+                double alpha;
+                double beta;
+
+                //frame start time and period state (us)
+                size_t num_frames;
+                double last_measured_start_time_us;
+                double estimated_start_time_us;
+                double estimated_period_us;
+
+                //exponentially weighted variance of the frame start time innovations (us^2)
+                double innovation_variance_us2;
+
+                //running weighted means and variances for the chirp parameters (weighted by the number of chirp intervals)
+                double chirp_weight_sum;
+                double chirp_slope_mean; //MHz/us
+                double chirp_slope_m2;
+                double chirp_duration_mean; //us
+                double chirp_duration_m2;
+
+                //history ring
+                size_t history_size;
+                size_t history_next_row;
+
+            public:
+                //history of the most recent frames (ring, the oldest frame is at history_next_row once it is full)
+                //colums as follows: duration, number of chirps, average slope, average chirp duration, start time, next predicted frame start time
+                Buffer_2D<data_type> history;
+
+                /**
+                 * @brief Construct a new Frame Tracker object
+                 *
+                 * @param json_config a json object with configuration information
+                 */
+                FrameTracker(json json_config): config(json_config){
+                    initialize_filter_params();
+                    reset();
+                }
+
+                ~FrameTracker() {};
+
+                /**
+                 * @brief Initialize the filter gains and history size from the configuration
+                 *
+                 */
+                void initialize_filter_params(){
+                    if (config["SensingSubsystemSettings"]["frame_tracker_alpha"].is_null() == false)
+                    {
+                        alpha = config["SensingSubsystemSettings"]["frame_tracker_alpha"].get<double>();
+                    }
+                    else{
+                        alpha = 0.2;
+                    }
+
+                    if (config["SensingSubsystemSettings"]["frame_tracker_beta"].is_null() == false)
+                    {
+                        beta = config["SensingSubsystemSettings"]["frame_tracker_beta"].get<double>();
+                    }
+                    else{
+                        beta = 0.02;
+                    }
+
+                    if (config["SensingSubsystemSettings"]["frame_tracker_history"].is_null() == false)
+                    {
+                        history_size = config["SensingSubsystemSettings"]["frame_tracker_history"].get<size_t>();
+                    }
+                    else if (config["SensingSubsystemSettings"]["num_victim_frames_to_capture"].is_null() == false)
+                    {
+                        history_size = config["SensingSubsystemSettings"]["num_victim_frames_to_capture"].get<size_t>();
+                    }
+                    else{
+                        history_size = 64;
+                    }
+                    if (history_size == 0)
+                    {
+                        history_size = 1;
+                    }
+
+                    history = Buffer_2D<data_type>(history_size,6);
+                }
+
+                /**
+                 * @brief Reset the tracker (forget every frame)
+                 *
+                 */
+                void reset(){
+                    num_frames = 0;
+                    last_measured_start_time_us = 0;
+                    estimated_start_time_us = 0;
+                    estimated_period_us = 0;
+                    innovation_variance_us2 = 0;
+
+                    chirp_weight_sum = 0;
+                    chirp_slope_mean = 0;
+                    chirp_slope_m2 = 0;
+                    chirp_duration_mean = 0;
+                    chirp_duration_m2 = 0;
+
+                    history_next_row = 0;
+                }
+
+                /**
+                 * @brief Update the tracker with a newly captured frame
+                 *
+                 * @param num_chirps the number of chirps detected in the frame
+                 * @param average_slope the average chirp slope in the frame (MHz/us)
+                 * @param average_chirp_duration the average chirp duration in the frame (us)
+                 * @param start_time_us the measured start time of the frame (time of its first chirp in us)
+                 */
+                void update(size_t num_chirps, data_type average_slope, data_type average_chirp_duration, data_type start_time_us){
+                    double measured_start_time_us = static_cast<double>(start_time_us);
+                    double frame_duration_us = (num_frames > 0) ? measured_start_time_us - last_measured_start_time_us : 0;
+                    num_frames += 1;
+
+                    //frame start time and period
+                    if (num_frames == 1)
+                    {
+                        estimated_start_time_us = measured_start_time_us;
+                    }
+                    else if (num_frames == 2)
+                    {
+                        estimated_period_us = measured_start_time_us - estimated_start_time_us;
+                        estimated_start_time_us = measured_start_time_us;
+                    }
+                    else{
+                        //the number of periods since the last update (frames can be missed)
+                        double num_periods = 1;
+                        if (estimated_period_us > 0)
+                        {
+                            num_periods = std::max(1.0, std::round(
+                                (measured_start_time_us - estimated_start_time_us) / estimated_period_us));
+                        }
+                        double predicted_start_time_us = estimated_start_time_us + num_periods * estimated_period_us;
+                        double innovation_us = measured_start_time_us - predicted_start_time_us;
+
+                        //growing memory gains until they reach the steady state gains
+                        double k = static_cast<double>(num_frames);
+                        double alpha_k = std::max(alpha, 2 * (2 * k - 1) / (k * (k + 1)));
+                        double beta_k = std::max(beta, 6 / (k * (k + 1)));
+
+                        estimated_start_time_us = predicted_start_time_us + alpha_k * innovation_us;
+                        estimated_period_us += beta_k * innovation_us / num_periods;
+
+                        //track the spread of the innovations (prediction uncertainty)
+                        if (num_frames == 3)
+                        {
+                            innovation_variance_us2 = innovation_us * innovation_us;
+                        }
+                        else{
+                            innovation_variance_us2 += alpha * (innovation_us * innovation_us - innovation_variance_us2);
+                        }
+                    }
+                    last_measured_start_time_us = measured_start_time_us;
+
+                    //chirp slope and duration (weighted by the number of chirp intervals in the frame)
+                    double weight = (num_chirps > 1) ? static_cast<double>(num_chirps - 1) : 0;
+                    if (weight > 0)
+                    {
+                        chirp_weight_sum += weight;
+                        update_weighted_mean(static_cast<double>(average_slope), weight, chirp_slope_mean, chirp_slope_m2);
+                        update_weighted_mean(static_cast<double>(average_chirp_duration), weight, chirp_duration_mean, chirp_duration_m2);
+                    }
+
+                    //save the frame in the history ring
+                    Row_View<data_type> row = history.buffer[history_next_row];
+                    row[0] = static_cast<data_type>(frame_duration_us);
+                    row[1] = static_cast<data_type>(num_chirps);
+                    row[2] = average_slope;
+                    row[3] = average_chirp_duration;
+                    row[4] = start_time_us;
+                    row[5] = static_cast<data_type>(get_next_frame_start_time_prediction_us());
+                    history_next_row = (history_next_row + 1) % history_size;
+                }
+
+                /**
+                 * @brief Get the number of frames that the tracker has been updated with
+                 *
+                 */
+                size_t get_num_frames(){
+                    return num_frames;
+                }
+
+                /**
+                 * @brief Get the measured start time of the most recent frame (us)
+                 *
+                 */
+                double get_last_frame_start_time_us(){
+                    return last_measured_start_time_us;
+                }
+
+                /**
+                 * @brief Get the predicted start time of the next frame (us), zero until two frames have been captured
+                 *
+                 */
+                double get_next_frame_start_time_prediction_us(){
+                    if (num_frames < 2)
+                    {
+                        return 0;
+                    }
+                    return estimated_start_time_us + estimated_period_us;
+                }
+
+                /**
+                 * @brief Get the uncertainty (standard deviation) of the next frame start time prediction
+                 * (us), estimated from the recent prediction errors. Zero until three frames have been captured
+                 *
+                 */
+                double get_next_frame_start_time_std_us(){
+                    return std::sqrt(innovation_variance_us2);
+                }
+
+                /**
+                 * @brief Get the estimated frame period (us)
+                 *
+                 */
+                double get_frame_period_us(){
+                    return estimated_period_us;
+                }
+
+                /**
+                 * @brief Get the average chirp slope across all frames (MHz/us)
+                 *
+                 */
+                double get_average_chirp_slope(){
+                    return chirp_slope_mean;
+                }
+
+                /**
+                 * @brief Get the standard deviation of the per-frame chirp slopes (MHz/us)
+                 *
+                 */
+                double get_chirp_slope_std(){
+                    return (chirp_weight_sum > 0) ? std::sqrt(chirp_slope_m2 / chirp_weight_sum) : 0;
+                }
+
+                /**
+                 * @brief Get the average chirp duration across all frames (us)
+                 *
+                 */
+                double get_average_chirp_duration(){
+                    return chirp_duration_mean;
+                }
+
+                /**
+                 * @brief Get the standard deviation of the per-frame chirp durations (us)
+                 *
+                 */
+                double get_chirp_duration_std(){
+                    return (chirp_weight_sum > 0) ? std::sqrt(chirp_duration_m2 / chirp_weight_sum) : 0;
+                }
+
+                /**
+                 * @brief Copy the frames in the history ring into a buffer (oldest frame first)
+                 *
+                 * @param ordered_history the buffer to copy the frames into (resized to the number of frames in the history)
+                 */
+                void get_ordered_history(Buffer_2D<data_type> & ordered_history){
+                    size_t num_rows = std::min(num_frames, history_size);
+                    size_t first_row = (num_frames > history_size) ? history_next_row : 0;
+
+                    ordered_history = Buffer_2D<data_type>(num_rows,6);
+                    for (size_t i = 0; i < num_rows; i++)
+                    {
+                        Row_View<data_type> row = history.buffer[(first_row + i) % history_size];
+                        std::copy(row.begin(), row.end(), ordered_history.buffer[i].begin());
+                    }
+                }
+
+            private:
+
+                /**
+                 * @brief Add a weighted sample to a running weighted mean and sum of squared deviations
+                 * (chirp_weight_sum must already include the new weight)
+                 *
+                 * @param value the new sample
+                 * @param weight the weight of the new sample
+                 * @param mean the running mean
+                 * @param m2 the running weighted sum of squared deviations from the mean
+                 */
+                void update_weighted_mean(double value, double weight, double & mean, double & m2){
+                    double delta = value - mean;
+                    mean += (weight / chirp_weight_sum) * delta;
+                    m2 += weight * delta * (value - mean);
+                }
+        };
+    }
+#endif
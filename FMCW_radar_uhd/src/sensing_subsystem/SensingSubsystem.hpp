@@ -7,6 +7,12 @@
     #include <string>
     #include <complex>
     #include <csignal>
+    #include <thread>
+    #include <mutex>
+    #include <condition_variable>
+    #include <chrono>
+    #include <utility>
+    #include <functional>
 
     //JSON class
     #include <nlohmann/json.hpp>
@@ -18,6 +24,8 @@
     #include "../attacking_subsystem/AttackingSubsystem.hpp"
     #include "SpectrogramHandler.hpp"
     #include "EnergyDetector.hpp"
+    #include "DebugDumpWriter.hpp"
+    #include "../LatencyMonitor.hpp"
 
     // add in namespaces as needed
     using json = nlohmann::json;
@@ -27,6 +35,8 @@
     using SpectrogramHandler_namespace::SpectrogramHandler;
     using EnergyDetector_namespace::EnergyDetector;
     using AttackingSubsystem_namespace::AttackingSubsystem;
+    using DebugDumpWriter_namespace::DebugDumpWriter;
+    using LatencyMonitor_namespace::LatencyMonitor;
 
     namespace SensingSubsystem_namespace{
 
@@ -46,6 +56,37 @@
                 //configuration
                 json config;
 
+                //background writer for the debug dumps
+                DebugDumpWriter debug_dump;
+
+                //per-stage latency histograms (detection through queueing the attack)
+                LatencyMonitor latency_monitor;
+
+                //pipelined processing (capture frame N+1 while frame N is processed)
+                bool pipelined_processing;
+                Buffer_2D<std::complex<data_type>> capture_buffer; //swapped with the spectrogram handler's rx_buffer
+                std::thread processing_thread;
+                std::mutex processing_mutex;
+                std::condition_variable processing_cv;
+                bool frame_pending; //a frame has been handed to the processing thread and isn't done yet
+                bool stop_processing;
+                data_type pending_detection_start_time_us;
+                std::chrono::steady_clock::time_point pending_detection_time;
+                std::chrono::steady_clock::time_point pending_capture_end_time;
+
+                //called by the USRP handler as the frame is received (records the detection time and
+                //computes the spectrogram rows as they arrive when streaming)
+                std::function<void(size_t)> samples_received_callback;
+                bool frame_detected;
+                std::chrono::steady_clock::time_point detection_time;
+
+                //pipeline statistics
+                size_t num_frames_processed;
+                double total_capture_time_s;
+                double total_processing_time_s;
+                double total_detection_to_estimate_s; //from the frame being detected to the parameter estimate
+                double total_last_sample_to_estimate_s; //from the last sample being received to the parameter estimate
+
             public:
                 /**
                  * @brief Construct a new Sensing Subsystem object
@@ -60,13 +101,116 @@
                     attacker_usrp_handler(usrp_handler),
                     attacking_subsystem(subsystem_attacking),
                     energy_detector(config_data),
-                    spectrogram_handler(config_data){
+                    spectrogram_handler(config_data),
+                    debug_dump(config_data),
+                    latency_monitor(config_data),
+                    frame_pending(false),
+                    stop_processing(false),
+                    frame_detected(false){
+
+                        //configure the capture/processing pipeline
+                        initialize_pipeline();
+
+                        //preallocate the debug dump snapshots
+                        initialize_debug_dump();
+
+                        //record the spectrogram processing stages
+                        spectrogram_handler.set_latency_monitor(& latency_monitor);
 
                         //measure the relative noise power for the energy detector
                         mesaure_relative_noise_power();
                 }
 
-                ~SensingSubsystem(){};
+                ~SensingSubsystem(){
+                    stop_processing_thread();
+                };
+
+                /**
+                 * @brief Configure the capture/processing pipeline and start the processing thread
+                 * 
+                 */
+                void initialize_pipeline(void){
+                    if (config["SensingSubsystemSettings"]["pipelined_processing"].is_null() == false)
+                    {
+                        pipelined_processing = config["SensingSubsystemSettings"]["pipelined_processing"].get<bool>();
+                    }
+                    else{
+                        pipelined_processing = true;
+                    }
+
+                    //when streaming, the spectrogram is computed on the receive thread as the frame arrives
+                    if (spectrogram_handler.streaming_spectrogram)
+                    {
+                        if (pipelined_processing)
+                        {
+                            std::cout << "SensingSubsystem::initialize_pipeline: streaming_spectrogram enabled, " <<
+                                        "processing each frame as it is received instead of pipelining" << std::endl;
+                        }
+                        pipelined_processing = false;
+                    }
+
+                    samples_received_callback = [this](size_t num_samples_received) {
+                        if (! frame_detected)
+                        {
+                            detection_time = std::chrono::steady_clock::now();
+                            frame_detected = true;
+                        }
+                        if (spectrogram_handler.streaming_spectrogram)
+                        {
+                            spectrogram_handler.stream_received_samples(num_samples_received);
+                        }
+                    };
+
+                    if (pipelined_processing)
+                    {
+                        //second frame buffer to capture into while the spectrogram handler processes its rx_buffer
+                        capture_buffer = Buffer_2D<std::complex<data_type>>(
+                            spectrogram_handler.rx_buffer.num_rows,
+                            spectrogram_handler.rx_buffer.num_cols);
+                        
+                        processing_thread = std::thread([this]() {
+                            run_processing_thread();
+                        });
+                    }
+                }
+
+                /**
+                 * @brief Register each debug dump artifact with the debug dump writer (preallocating
+                 * its snapshot slots)
+                 * 
+                 */
+                void initialize_debug_dump(void){
+                    debug_dump.register_artifact("hanning_window", spectrogram_handler.hanning_window);
+                    if (spectrogram_handler.materialize_spectrogram)
+                    {
+                        debug_dump.register_artifact("reshaped_and_windowed_for_fft", spectrogram_handler.reshaped__and_windowed_signal_for_fft);
+                        debug_dump.register_artifact("generated_spectrogram", spectrogram_handler.generated_spectrogram);
+                    }
+                    debug_dump.register_artifact("spectrogram_point_vals", spectrogram_handler.spectrogram_points_values);
+                    debug_dump.register_artifact("detected_times", spectrogram_handler.detected_times);
+                    debug_dump.register_artifact("detected_frequencies", spectrogram_handler.detected_frequencies);
+                    debug_dump.register_artifact("computed_clusters", spectrogram_handler.cluster_indicies);
+                    debug_dump.register_artifact("detected_slopes", spectrogram_handler.detected_slopes);
+                    debug_dump.register_artifact("detected_intercepts", spectrogram_handler.detected_intercepts);
+                    debug_dump.register_artifact("captured_frames", spectrogram_handler.frame_tracker.history);
+                    debug_dump.register_artifact("estimated_parameters", Buffer_1D<data_type>(3,false));
+                }
+
+                /**
+                 * @brief Wait for any pending frame to be processed and stop the processing thread
+                 * 
+                 */
+                void stop_processing_thread(void){
+                    if (processing_thread.joinable())
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock(processing_mutex);
+                            stop_processing = true;
+                        }
+                        processing_cv.notify_all();
+                        processing_thread.join();
+                    }
+                }
 
                 /**
                  * @brief measure the relative noise power and configure the energy detector
@@ -74,13 +218,16 @@
                  */
                 void mesaure_relative_noise_power(void){
                     std::cout << "SensingSubsystem::measure_relative_noise_power: measurig relative noise power" << std::endl;
+                    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
                     //stream the ambient signal
                     attacker_usrp_handler -> rx_stream_to_buffer(& energy_detector.noise_power_measureent_signal);
 
                     energy_detector.compute_relative_noise_power();
 
-                    std::cout << "relative noise power: " << energy_detector.relative_noise_power << "dB" << std::endl;
+                    std::cout << "relative noise power: " << energy_detector.relative_noise_power << "dB (measured in " <<
+                                std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - start).count() <<
+                                " ms)" << std::endl;
                     return;
                 }
 
@@ -92,90 +239,278 @@
                     
                     data_type detection_start_time_us;
                     double next_rx_sense_start_time = 0.0;
+                    bool attack_after_frame;
+                    Buffer_2D<std::complex<data_type>> * frame_buffer;
+
+                    //start tracking the victim's frames from scratch
+                    spectrogram_handler.initialize_chirp_and_frame_tracking();
+                    debug_dump.start_run();
+                    latency_monitor.reset();
+
+                    //reset the pipeline statistics
+                    num_frames_processed = 0;
+                    total_capture_time_s = 0;
+                    total_processing_time_s = 0;
+                    total_detection_to_estimate_s = 0;
+                    total_last_sample_to_estimate_s = 0;
+                    std::chrono::steady_clock::time_point run_start = std::chrono::steady_clock::now();
+                    std::chrono::steady_clock::time_point capture_start;
+                    std::chrono::steady_clock::time_point capture_end;
+
                     //process the detected chirp
                     for (size_t i = 0; i < spectrogram_handler.max_frames_to_capture; i++)
                     {
-                        //have USRP sample until it detects a chirp
-                        attacker_usrp_handler -> rx_record_next_frame(& spectrogram_handler, 
+                        attack_after_frame = (attacking_subsystem -> enabled) && (i > attacking_subsystem -> attack_start_frame);
+
+                        //have USRP sample until it detects a chirp (into the spare buffer when pipelined)
+                        frame_buffer = pipelined_processing ? & capture_buffer : & spectrogram_handler.rx_buffer;
+                        frame_detected = false;
+                        spectrogram_handler.reset_streamed_rows();
+                        capture_start = std::chrono::steady_clock::now();
+                        attacker_usrp_handler -> rx_record_next_frame(frame_buffer, 
                             & energy_detector,
-                            next_rx_sense_start_time);
+                            next_rx_sense_start_time,
+                            samples_received_callback,
+                            & latency_monitor);
+                        capture_end = std::chrono::steady_clock::now();
+                        total_capture_time_s += std::chrono::duration<double>(capture_end - capture_start).count();
+                        if (! frame_detected)
+                        {
+                            detection_time = capture_end;
+                        }
                         detection_start_time_us = energy_detector.get_detection_start_time_us();
-                        spectrogram_handler.set_detection_start_time_us(detection_start_time_us);
-                        energy_detector.save_chirp_detection_signal_to_buffer(& (spectrogram_handler.rx_buffer));
-                        spectrogram_handler.process_received_signal();
                         energy_detector.reset_chirp_detector();
 
-                        next_rx_sense_start_time = spectrogram_handler.get_last_frame_start_time_s() * 1e-6
-                            + spectrogram_handler.min_frame_periodicity_s;
+                        if (pipelined_processing && (! attack_after_frame))
+                        {
+                            //process the frame on the processing thread and listen for the next frame right away
+                            dispatch_frame(detection_start_time_us, detection_time, capture_end);
+                            next_rx_sense_start_time = static_cast<double>(detection_start_time_us) * 1e-6
+                                + spectrogram_handler.min_frame_periodicity_s;
+                        }
+                        else{
+                            //drain the pipeline, the attack needs the results from this frame
+                            if (pipelined_processing)
+                            {
+                                wait_for_processing();
+                                std::swap(capture_buffer.buffer, spectrogram_handler.rx_buffer.buffer);
+                            }
+                            process_frame(detection_start_time_us, detection_time, capture_end);
+                            next_rx_sense_start_time = spectrogram_handler.get_last_frame_start_time_s() * 1e-6
+                                + spectrogram_handler.min_frame_periodicity_s;
+                        }
                         
-                        if ((attacking_subsystem -> enabled) && (i > attacking_subsystem -> attack_start_frame))
+                        if (attack_after_frame)
                         {
+                            std::chrono::steady_clock::time_point scheduling_start = std::chrono::steady_clock::now();
                             double next_frame_start_time = spectrogram_handler.get_next_frame_start_time_prediction_ms();
                             attacking_subsystem -> compute_frame_start_times(next_frame_start_time);
-                            attacking_subsystem -> run_attack_subsystem();
+                            attacking_subsystem -> queue_attack(& latency_monitor);
+                            std::chrono::steady_clock::time_point attack_queued = std::chrono::steady_clock::now();
+                            latency_monitor.record(LatencyMonitor::scheduling, scheduling_start, attack_queued);
+                            latency_monitor.record(LatencyMonitor::chirp_to_transmit, detection_time, attack_queued);
+                            attacking_subsystem -> wait_for_attack();
                             break;
                         }
                         
                     }
 
+                    //make sure that the last frame has been processed
+                    if (pipelined_processing)
+                    {
+                        wait_for_processing();
+                    }
+                    double run_time_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+                    print_pipeline_summary(run_time_s);
+                    latency_monitor.save_report();
+
                     save_sensing_subsystem_state();
                     std::cout << "SensingSubsystem::run: completed frame tracking" << std::endl;
+                    std::cout << "SensingSubsystem::run: noise floor: " << energy_detector.get_noise_floor_dB() <<
+                                "dB (initial: " << energy_detector.get_initial_noise_floor_dB() << "dB, " <<
+                                energy_detector.get_num_noise_floor_updates() << " updates)" << std::endl;
                     spectrogram_handler.print_summary_of_estimated_parameters();
-                    spectrogram_handler.save_estimated_parameters_to_file();
                 }
 
                 /**
-                 * @brief Save key sensing subsystem buffers to a file
+                 * @brief Get the estimated frame duration (ms), chirp duration (us), and chirp slope (MHz/us)
+                 * of the victim from the last run
+                 * 
+                 * @param estimated_parameters a buffer with (at least) 3 samples
+                 */
+                void get_estimated_parameters(Buffer_1D<data_type> & estimated_parameters){
+                    spectrogram_handler.get_estimated_parameters(estimated_parameters);
+                }
+
+                /**
+                 * @brief Process the frame in the spectrogram handler's rx_buffer
+                 * 
+                 * @param detection_start_time_us the time of the first sample in the rx_buffer
+                 * @param frame_detection_time the (host) time that the frame was detected at
+                 * @param frame_capture_end_time the (host) time that the last sample of the frame was received at
+                 */
+                void process_frame(data_type detection_start_time_us,
+                                    std::chrono::steady_clock::time_point frame_detection_time,
+                                    std::chrono::steady_clock::time_point frame_capture_end_time){
+                    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+                    spectrogram_handler.set_detection_start_time_us(detection_start_time_us);
+                    if (spectrogram_handler.streaming_spectrogram)
+                    {
+                        spectrogram_handler.process_streamed_signal();
+                    }
+                    else{
+                        spectrogram_handler.process_received_signal();
+                    }
+
+                    //snapshot the frame's intermediate buffers (written on the debug dump writer's thread)
+                    if (debug_dump.every_frame())
+                    {
+                        dump_frame_buffers();
+                    }
+
+                    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+                    total_processing_time_s += std::chrono::duration<double>(end - start).count();
+                    total_detection_to_estimate_s += std::chrono::duration<double>(end - frame_detection_time).count();
+                    total_last_sample_to_estimate_s += std::chrono::duration<double>(end - frame_capture_end_time).count();
+                    num_frames_processed += 1;
+                }
+
+                /**
+                 * @brief Wait for the previous frame to finish processing, then swap the captured frame
+                 * into the spectrogram handler and hand it to the processing thread
+                 * 
+                 * @param detection_start_time_us the time of the first sample in the captured frame
+                 * @param frame_detection_time the (host) time that the frame was detected at
+                 * @param frame_capture_end_time the (host) time that the last sample of the frame was received at
+                 */
+                void dispatch_frame(data_type detection_start_time_us,
+                                    std::chrono::steady_clock::time_point frame_detection_time,
+                                    std::chrono::steady_clock::time_point frame_capture_end_time){
+                    std::unique_lock<std::mutex> lock(processing_mutex);
+                    processing_cv.wait(lock, [this]() {return ! frame_pending;});
+
+                    //the processing thread is idle, so the buffers can be swapped
+                    std::swap(capture_buffer.buffer, spectrogram_handler.rx_buffer.buffer);
+                    pending_detection_start_time_us = detection_start_time_us;
+                    pending_detection_time = frame_detection_time;
+                    pending_capture_end_time = frame_capture_end_time;
+                    frame_pending = true;
+                    lock.unlock();
+                    processing_cv.notify_all();
+                }
+
+                /**
+                 * @brief Wait for the processing thread to finish the current frame (if any)
+                 * 
+                 */
+                void wait_for_processing(void){
+                    std::unique_lock<std::mutex> lock(processing_mutex);
+                    processing_cv.wait(lock, [this]() {return ! frame_pending;});
+                }
+
+                /**
+                 * @brief processing thread loop, processes dispatched frames until stop_processing_thread() is called
+                 * 
+                 */
+                void run_processing_thread(void){
+                    std::unique_lock<std::mutex> lock(processing_mutex);
+                    while (true)
+                    {
+                        processing_cv.wait(lock, [this]() {return frame_pending || stop_processing;});
+                        if (! frame_pending)
+                        {
+                            return;
+                        }
+
+                        data_type detection_start_time_us = pending_detection_start_time_us;
+                        std::chrono::steady_clock::time_point frame_detection_time = pending_detection_time;
+                        std::chrono::steady_clock::time_point frame_capture_end_time = pending_capture_end_time;
+                        lock.unlock();
+                        process_frame(detection_start_time_us, frame_detection_time, frame_capture_end_time);
+                        lock.lock();
+
+                        frame_pending = false;
+                        processing_cv.notify_all();
+                    }
+                }
+
+                /**
+                 * @brief Print the number of victim frames characterized per second, with the
+                 * rate that would be achieved without overlapping capture and processing
+                 * 
+                 * @param run_time_s the total time spent capturing and processing frames
+                 */
+                void print_pipeline_summary(double run_time_s){
+                    if (num_frames_processed == 0)
+                    {
+                        return;
+                    }
+                    double average_capture_time_s = total_capture_time_s / num_frames_processed;
+                    double average_processing_time_s = total_processing_time_s / num_frames_processed;
+
+                    std::cout << "SensingSubsystem::print_pipeline_summary: " << num_frames_processed <<
+                                " frames characterized in " << run_time_s * 1e3 << " ms (" <<
+                                num_frames_processed / run_time_s << " frames/s, " <<
+                                (pipelined_processing ? "pipelined" : "serial") << ")" << std::endl;
+                    std::cout << "SensingSubsystem::print_pipeline_summary: average capture time: " <<
+                                average_capture_time_s * 1e3 << " ms, average processing time: " <<
+                                average_processing_time_s * 1e3 << " ms (" <<
+                                1.0 / (average_capture_time_s + average_processing_time_s) <<
+                                " frames/s without overlap)" << std::endl;
+                    std::cout << "SensingSubsystem::print_pipeline_summary: average latency from detection to parameter estimate: " <<
+                                total_detection_to_estimate_s / num_frames_processed * 1e3 << " ms, from last sample to parameter estimate: " <<
+                                total_last_sample_to_estimate_s / num_frames_processed * 1e6 << " us (" <<
+                                (spectrogram_handler.streaming_spectrogram ? "streaming" : "after capture") << ")" << std::endl;
+                }
+
+                /**
+                 * @brief Snapshot the intermediate buffers from the most recently processed frame
+                 * for the debug dump writer (the buffers are rewritten by the next frame)
+                 * 
+                 */
+                void dump_frame_buffers(void){
+                    //the reshaped signal and the spectrogram are only computed in the materialized (debug) mode
+                    if (spectrogram_handler.materialize_spectrogram)
+                    {
+                        debug_dump.dump("reshaped_and_windowed_for_fft", spectrogram_handler.reshaped__and_windowed_signal_for_fft);
+                        debug_dump.dump("generated_spectrogram", spectrogram_handler.generated_spectrogram);
+                    }
+
+                    //the detected points, clusters, and linear models
+                    debug_dump.dump("spectrogram_point_vals", spectrogram_handler.spectrogram_points_values);
+                    debug_dump.dump("detected_times", spectrogram_handler.detected_times);
+                    debug_dump.dump("detected_frequencies", spectrogram_handler.detected_frequencies);
+                    debug_dump.dump("computed_clusters", spectrogram_handler.cluster_indicies);
+                    debug_dump.dump("detected_slopes", spectrogram_handler.detected_slopes);
+                    debug_dump.dump("detected_intercepts", spectrogram_handler.detected_intercepts);
+                }
+
+                /**
+                 * @brief Save key sensing subsystem buffers and the estimated victim parameters
+                 * (returns without waiting for the files to be written)
                  * 
                  */
                 void save_sensing_subsystem_state(void){
-                    //save the hanning window to a file to confirm correctness
-                    std::string path;
-                    path = "/home/david/Documents/MATLAB_generated/cpp_hanning_window.bin";
-                    spectrogram_handler.hanning_window.set_write_file(path);
-                    spectrogram_handler.hanning_window.save_to_file();
-                    
-                    //load and reshape the received signal to confirm correctness
-                    path = "/home/david/Documents/MATLAB_generated/cpp_reshaped_and_windowed_for_fft.bin";
-                    spectrogram_handler.reshaped__and_windowed_signal_for_fft.set_write_file(path,true);
-                    spectrogram_handler.reshaped__and_windowed_signal_for_fft.save_to_file();
-
-                    //compute the fft to confirm correctness
-                    path = "/home/david/Documents/MATLAB_generated/cpp_generated_spectrogram.bin";
-                    spectrogram_handler.generated_spectrogram.set_write_file(path,true);
-                    spectrogram_handler.generated_spectrogram.save_to_file();
-
-                    //detect the points in the spectrogram
-                    path = "/home/david/Documents/MATLAB_generated/cpp_spectrogram_point_vals.bin";
-                    spectrogram_handler.spectrogram_points_values.set_write_file(path,true);
-                    spectrogram_handler.spectrogram_points_values.save_to_file();
-
-                    //detect the times and frequencies
-                    path = "/home/david/Documents/MATLAB_generated/cpp_detected_times.bin";
-                    spectrogram_handler.detected_times.set_write_file(path,true);
-                    spectrogram_handler.detected_times.save_to_file();
-                    path = "/home/david/Documents/MATLAB_generated/cpp_detected_frequencies.bin";
-                    spectrogram_handler.detected_frequencies.set_write_file(path,true);
-                    spectrogram_handler.detected_frequencies.save_to_file();
-
-                    //compute the clusters
-                    path = "/home/david/Documents/MATLAB_generated/cpp_computed_clusters.bin";
-                    spectrogram_handler.cluster_indicies.set_write_file(path,true);
-                    spectrogram_handler.cluster_indicies.save_to_file();
-
-                    //fit linear models
-                    path = "/home/david/Documents/MATLAB_generated/cpp_detected_slopes.bin";
-                    spectrogram_handler.detected_slopes.set_write_file(path,true);
-                    spectrogram_handler.detected_slopes.save_to_file();
-                    path = "/home/david/Documents/MATLAB_generated/cpp_detected_intercepts.bin";
-                    spectrogram_handler.detected_intercepts.set_write_file(path,true);
-                    spectrogram_handler.detected_intercepts.save_to_file();
-
-                    //compute victim parameters
-                    path = "/home/david/Documents/MATLAB_generated/cpp_captured_frames.bin";
-                    spectrogram_handler.captured_frames.set_write_file(path,true);
-                    spectrogram_handler.captured_frames.save_to_file();
+                    //the hanning window is kept, so it is copied rather than swapped
+                    debug_dump.dump_copy("hanning_window", spectrogram_handler.hanning_window);
+
+                    //the final frame's buffers (already saved if every frame is saved)
+                    if (! debug_dump.every_frame())
+                    {
+                        dump_frame_buffers();
+                    }
+
+                    //the captured frames and the estimated parameters
+                    Buffer_2D<data_type> captured_frames;
+                    spectrogram_handler.frame_tracker.get_ordered_history(captured_frames);
+                    debug_dump.dump("captured_frames", captured_frames);
+
+                    Buffer_1D<data_type> estimated_parameters(3,false);
+                    spectrogram_handler.get_estimated_parameters(estimated_parameters);
+                    debug_dump.dump("estimated_parameters", estimated_parameters);
 
+                    debug_dump.end_run();
                 }
 
         };
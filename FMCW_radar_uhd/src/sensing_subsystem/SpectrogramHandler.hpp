@@ -15,6 +15,8 @@
 
     #define _USE_MATH_DEFINES
     #include <cmath>
+    #include <memory>
+    #include <chrono>
 
     //including buffer handler
     #include "../BufferHandler.hpp"
@@ -22,17 +24,63 @@
     //include the JSON handling capability
     #include <nlohmann/json.hpp>
 
-    //include the required headers from EIGEN
-    #include "Eigen/Dense"
+    //include the required headers from EIGEN (only used by the reference line fit,
+    //enabled with the SPECTROGRAM_EIGEN_REFERENCE option)
+    #ifdef SPECTROGRAM_EIGEN_REFERENCE
+        #include "Eigen/Dense"
+    #endif
+
+    //frame tracking
+    #include "FrameTracker.hpp"
+
+    //latency instrumentation
+    #include "../LatencyMonitor.hpp"
 
 
     using namespace Buffers;
     using namespace pocketfft;
     using json = nlohmann::json;
-    using namespace Eigen;
+    #ifdef SPECTROGRAM_EIGEN_REFERENCE
+        using namespace Eigen;
+    #endif
+    using FrameTracker_namespace::FrameTracker;
+    using LatencyMonitor_namespace::LatencyMonitor;
+    using LatencyMonitor_namespace::Stage_Clock;
 
     namespace SpectrogramHandler_namespace {
 
+        /**
+         * @brief Running sums for a least squares line fit (f = b0 + b1 * t). Times are
+         * accumulated relative to time_offset (the first point's time) to keep the sums well conditioned
+         * 
+         */
+        struct Linear_Fit_Sums {
+            double time_offset;
+            size_t num_points;
+            double sum_t;
+            double sum_f;
+            double sum_tt;
+            double sum_tf;
+
+            void reset(double offset){
+                time_offset = offset;
+                num_points = 0;
+                sum_t = 0;
+                sum_f = 0;
+                sum_tt = 0;
+                sum_tf = 0;
+            }
+
+            void add_point(double t, double f){
+                t -= time_offset;
+                num_points += 1;
+                sum_t += t;
+                sum_f += f;
+                sum_tt += t * t;
+                sum_tf += t * f;
+            }
+        };
+
         template<typename data_type>
         class SpectrogramHandler
         {
@@ -54,6 +102,16 @@
             stride_t stride;
             shape_t axes;
 
+            //fft plan and scratch rows (one per thread) used by the fused window/fft/peak kernel
+            std::shared_ptr<pocketfft::detail::pocketfft_c<data_type>> fft_plan;
+            Buffer_2D<std::complex<data_type>> fft_row_scratch;
+
+            //number of threads to use for the fft computations
+            size_t fft_num_threads;
+
+            //number of spectrogram rows already computed while streaming the current frame
+            size_t num_streamed_rows;
+
             //peak_detection_parameters
             data_type peak_detection_threshold;
 
@@ -75,10 +133,9 @@
             size_t chirp_tracking_num_captured_chirps;
             data_type chirp_tracking_average_slope; //in MHz/us
             data_type chirp_tracking_average_chirp_duration; //in us
-            size_t frame_tracking_num_captured_frames;
-            data_type frame_tracking_average_frame_duration;
-            data_type frame_tracking_average_chirp_duration;
-            data_type frame_tracking_average_chirp_slope;
+
+            //(optional) latency monitor to record the processing stages in
+            LatencyMonitor * latency_monitor;
 
         
         public:
@@ -87,6 +144,15 @@
             size_t max_frames_to_capture;
             double min_frame_periodicity_s;
 
+            //debug mode - on true, the reshaped signal, the ffts, and the full spectrogram
+            //are materialized in their buffers instead of using the fused peak detection kernel
+            bool materialize_spectrogram;
+
+            //streaming mode - on true, the spectrogram rows are computed as the rx_buffer is filled
+            //(see stream_received_samples) so only the peak selection, clustering, and fitting remain
+            //once the last sample of the frame has been received
+            bool streaming_spectrogram;
+
             //buffers used
 
                 //rx signal buffer
@@ -119,8 +185,8 @@
                 Buffer_1D<data_type> detected_slopes;
                 Buffer_1D<data_type> detected_intercepts;
 
-                //buffer for tracking victim frames
-                Buffer_2D<data_type> captured_frames; //colums as follows: duration, number of chirps, average slope, average chirp duration, start time, next predicted frame start time
+            //tracker for the victim frames (keeps a history of the most recent frames)
+            FrameTracker<data_type> frame_tracker;
             
         public:
 
@@ -129,7 +195,7 @@
              * 
              * @param json_config a json object with configuration information 
              */
-            SpectrogramHandler(json json_config): config(json_config){
+            SpectrogramHandler(json json_config): config(json_config), latency_monitor(nullptr), frame_tracker(json_config){
                 if (check_config())
                 {
                     initialize_spectrogram_params();
@@ -242,6 +308,44 @@
 
                 //set the peak detection threshold for the spectogram
                 peak_detection_threshold = config["SensingSubsystemSettings"]["spectogram_peak_detection_threshold_dB"].get<data_type>();
+
+                //determine if the full spectrogram should be materialized (debug mode)
+                if (config["SensingSubsystemSettings"]["materialize_spectrogram"].is_null() == false)
+                {
+                    materialize_spectrogram = config["SensingSubsystemSettings"]["materialize_spectrogram"].get<bool>();
+                }
+                else{
+                    materialize_spectrogram = false;
+                }
+
+                //set the number of threads used for the fft computations
+                if (config["SensingSubsystemSettings"]["fft_num_threads"].is_null() == false)
+                {
+                    fft_num_threads = config["SensingSubsystemSettings"]["fft_num_threads"].get<size_t>();
+                }
+                else{
+                    fft_num_threads = 1;
+                }
+                if (fft_num_threads == 0)
+                {
+                    fft_num_threads = 1;
+                }
+
+                //determine if the spectrogram should be computed while the frame is received
+                if (config["SensingSubsystemSettings"]["streaming_spectrogram"].is_null() == false)
+                {
+                    streaming_spectrogram = config["SensingSubsystemSettings"]["streaming_spectrogram"].get<bool>();
+                }
+                else{
+                    streaming_spectrogram = false;
+                }
+                if (streaming_spectrogram && materialize_spectrogram)
+                {
+                    std::cerr << "SpectrogramHandler::initialize_spectrogram_params: streaming_spectrogram isn't " <<
+                                "supported with materialize_spectrogram, processing each frame after it is received" << std::endl;
+                    streaming_spectrogram = false;
+                }
+                num_streamed_rows = 0;
             }
 
 
@@ -254,6 +358,9 @@
                 shape = {fft_size};
                 stride = {sizeof(std::complex<data_type>)};
                 axes = {0};
+
+                //plan the fft once so that the fused kernel doesn't re-plan for every row
+                fft_plan = std::make_shared<pocketfft::detail::pocketfft_c<data_type>>(fft_size);
             }
 
             /**
@@ -274,6 +381,7 @@
                 //fft/spectrogram generation
                 computed_fft = Buffer_2D<std::complex<data_type>>(num_rows_spectrogram,fft_size);
                 generated_spectrogram = Buffer_2D<data_type>(num_rows_spectrogram,fft_size);
+                fft_row_scratch = Buffer_2D<std::complex<data_type>>(fft_num_threads,fft_size);
 
                 //getting the points from the spectrogram
                 spectrogram_points_values = Buffer_1D<data_type>(num_rows_spectrogram);
@@ -290,10 +398,9 @@
                 detected_slopes = Buffer_1D<data_type>(num_rows_spectrogram);
                 detected_intercepts = Buffer_1D<data_type>(num_rows_spectrogram);
 
-                //captured frames
+                //number of frames to capture
                 max_frames_to_capture = 
                     config["SensingSubsystemSettings"]["num_victim_frames_to_capture"].get<size_t>();
-                captured_frames = Buffer_2D<data_type>(max_frames_to_capture,6);
             }
 
             /**
@@ -372,10 +479,7 @@
                 chirp_tracking_average_chirp_duration = 0;
 
                 //frame tracking
-                frame_tracking_num_captured_frames = 0;
-                frame_tracking_average_frame_duration = 0;
-                frame_tracking_average_chirp_duration = 0;
-                frame_tracking_average_chirp_slope = 0;
+                frame_tracker.reset();
 
                 //min frame periodicity
                 min_frame_periodicity_s = config["SensingSubsystemSettings"]["min_frame_periodicity_ms"].get<double>() * 1e-3;
@@ -392,17 +496,104 @@
                 detection_start_time_us = start_time_us - distance_delay_us;
             }
 
+            /**
+             * @brief Set the latency monitor to record the processing stages in
+             * 
+             * @param monitor pointer to the latency monitor (nullptr to stop recording)
+             */
+            void set_latency_monitor(LatencyMonitor * monitor){
+                latency_monitor = monitor;
+            }
+
             /**
              * @brief Process the received signal
              * 
              */
             void process_received_signal(){
-                load_and_prepare_for_fft();
-                compute_ffts();
-                detect_peaks_in_spectrogram();
+                Stage_Clock clock(latency_monitor);
+                if (materialize_spectrogram)
+                {
+                    load_and_prepare_for_fft();
+                    clock.lap(LatencyMonitor::reshape);
+                    compute_ffts();
+                    clock.lap(LatencyMonitor::fft);
+                    detect_peaks_in_spectrogram();
+                    clock.lap(LatencyMonitor::peak);
+                    compute_clusters();
+                    clock.lap(LatencyMonitor::cluster);
+#ifdef SPECTROGRAM_EIGEN_REFERENCE
+                    check_linear_model();
+#endif
+                }
+                else{
+                    //the windowing is fused with the ffts
+                    compute_spectrogram_peaks();
+                    clock.lap(LatencyMonitor::fft);
+                    select_spectrogram_peaks();
+                    clock.lap(LatencyMonitor::peak);
+                    compute_clusters();
+                    clock.lap(LatencyMonitor::cluster);
+                }
+                compute_victim_parameters();
+                clock.lap(LatencyMonitor::fit);
+            }
+
+            /**
+             * @brief Start streaming a new frame into the rx_buffer (call before the first sample
+             * of the frame is received)
+             * 
+             */
+            void reset_streamed_rows(){
+                num_streamed_rows = 0;
+            }
+
+            /**
+             * @brief Compute the spectrogram peaks for every row whose samples have all been received.
+             * The sampling windows overlap the rx_buffer rows, so a spectrogram row is computed
+             * once the last sample in its window has arrived, and the rows computed so far are
+             * carried over to the next call
+             * 
+             * @param num_samples_received the number of samples at the start of the rx_buffer
+             * that have been received (the remaining rows, including the zero padded ones at the end
+             * of the frame, are computed once the whole rx_buffer has been received)
+             */
+            void stream_received_samples(size_t num_samples_received){
+                size_t end_row;
+                if (num_samples_received >= num_samples_rx_signal)
+                {
+                    end_row = num_rows_spectrogram;
+                }
+                else if (num_samples_received < fft_size)
+                {
+                    end_row = 0;
+                }
+                else{
+                    end_row = std::min(num_rows_spectrogram,
+                                (num_samples_received - fft_size) / samples_per_sampling_window + 1);
+                }
+
+                if (end_row > num_streamed_rows)
+                {
+                    compute_spectrogram_peaks(num_streamed_rows,end_row,fft_row_scratch.buffer[0].data());
+                    num_streamed_rows = end_row;
+                }
+            }
+
+            /**
+             * @brief Process a frame whose spectrogram rows were computed as it was received
+             * (computes any rows that are left and then estimates the victim parameters)
+             * 
+             */
+            void process_streamed_signal(){
+                Stage_Clock clock(latency_monitor);
+                stream_received_samples(num_samples_rx_signal);
+                clock.lap(LatencyMonitor::fft); //only the rows that were left once the frame was received
+                select_spectrogram_peaks();
+                clock.lap(LatencyMonitor::peak);
                 compute_clusters();
-                compute_linear_model();
+                clock.lap(LatencyMonitor::cluster);
                 compute_victim_parameters();
+                clock.lap(LatencyMonitor::fit);
             }
 
             /**
@@ -413,43 +604,120 @@
              */
             void load_and_prepare_for_fft(){
                 
-                //get dimmensions of rx_buffer array
-                size_t m = rx_buffer.buffer.size(); //rows
-                size_t n = rx_buffer.buffer[0].size(); //cols
-
-                //initialize variables for reshaping
-                size_t from_r;
-                size_t from_c;
+                //the rx_buffer is stored contiguously, so index it as a flat array
+                const std::complex<data_type> * rx_samples = rx_buffer.buffer.data();
+                size_t num_rx_samples = rx_buffer.buffer.num_samples();
 
                 //initialize variable to determine the coordinate in the received signal for a row/col index in reshpaed signal
                 size_t k;
 
                 for (size_t i = 0; i < num_rows_spectrogram; i++)
                 {
+                    std::complex<data_type> * reshaped_row = reshaped__and_windowed_signal_for_fft.buffer[i].data();
                     for (size_t j = 0; j < fft_size; j++)
                     {
-                        //for a given row,col index in the reshaped signal, determine the coordinate in the rx_buffer
-                        size_t k = i * samples_per_sampling_window + j;
+                        //for a given row,col index in the reshaped signal, determine the index in the rx_buffer
+                        k = i * samples_per_sampling_window + j;
 
-                        //indicies in rx_buffer
-                        from_r = k/n;
-                        from_c = k % n;
-
-                        if (from_r >= m)
+                        if (k >= num_rx_samples)
                         {
-                            reshaped__and_windowed_signal_for_fft.buffer[i][j] = 0;
+                            reshaped_row[j] = 0;
                         }
                         else{
-                            reshaped__and_windowed_signal_for_fft.buffer[i][j] = rx_buffer.buffer[from_r][from_c] * hanning_window.buffer[j];
+                            reshaped_row[j] = rx_samples[k] * hanning_window.buffer[j];
                         }
                     } 
                 }
                 return;
             }
 
+            /**
+             * @brief Fused window, fft, and peak detection kernel. For each spectrogram row,
+             * the samples are windowed into a scratch row, transformed in place, and only the
+             * peak magnitude and its index are kept (saved in spectrogram_points_values and
+             * spectrogram_points_indicies). The log10 is only computed for the peak value.
+             * The rows are split evenly across fft_num_threads threads from pocketfft's
+             * persistent thread pool.
+             * 
+             */
+            void compute_spectrogram_peaks(){
+
+                pocketfft::detail::threading::thread_map(fft_num_threads, [this](){
+                    size_t thread_id = pocketfft::detail::threading::thread_id();
+                    size_t num_threads = pocketfft::detail::threading::num_threads();
+
+                    //determine the rows for this thread
+                    size_t rows_per_thread = num_rows_spectrogram / num_threads;
+                    size_t extra_rows = num_rows_spectrogram % num_threads;
+                    size_t start_row = thread_id * rows_per_thread + std::min(thread_id,extra_rows);
+                    size_t end_row = start_row + rows_per_thread + (thread_id < extra_rows ? 1 : 0);
+
+                    compute_spectrogram_peaks(start_row,end_row,
+                        fft_row_scratch.buffer[thread_id].data());
+                });
+            }
+
+            /**
+             * @brief Fused window, fft, and peak detection kernel for the given spectrogram rows
+             * 
+             * @param start_idx the first spectrogram row to compute
+             * @param end_idx the spectrogram row to stop at
+             * @param row scratch row of fft_size samples (must not be shared with another thread)
+             */
+            void compute_spectrogram_peaks(size_t start_idx, size_t end_idx, std::complex<data_type> * row){
+
+                //the rx_buffer is stored contiguously, so index it as a flat array
+                const std::complex<data_type> * rx_samples = rx_buffer.buffer.data();
+                size_t num_rx_samples = rx_buffer.buffer.num_samples();
+                const std::complex<data_type> * window = hanning_window.buffer.data();
+
+                size_t k;
+                data_type magnitude_squared;
+                data_type max_magnitude_squared;
+                size_t max_idx;
+
+                for (size_t i = start_idx; i < end_idx; i++)
+                {
+                    //window the samples for the row
+                    k = i * samples_per_sampling_window;
+                    for (size_t j = 0; j < fft_size; j++)
+                    {
+                        if ((k + j) >= num_rx_samples)
+                        {
+                            row[j] = 0;
+                        }
+                        else{
+                            row[j] = rx_samples[k + j] * window[j];
+                        }
+                    }
+
+                    //compute the fft in place
+                    fft_plan -> exec(reinterpret_cast<pocketfft::detail::cmplx<data_type> *>(row),
+                                    (data_type) 1., FORWARD);
+
+                    //find the peak while the row is still in cache (|X|^2 has the same argmax as 10*log10(|X|))
+                    max_magnitude_squared = std::norm(row[0]);
+                    max_idx = 0;
+                    for (size_t j = 1; j < fft_size; j++)
+                    {
+                        magnitude_squared = std::norm(row[j]);
+                        if (magnitude_squared > max_magnitude_squared)
+                        {
+                            max_magnitude_squared = magnitude_squared;
+                            max_idx = j;
+                        }
+                    }
+
+                    //10 * log10(|X|) = 5 * log10(|X|^2)
+                    spectrogram_points_values.buffer[i] = 5 * std::log10(max_magnitude_squared);
+                    spectrogram_points_indicies.buffer[i] = max_idx;
+                }
+            }
+
             /**
              * @brief Compute the fft for the desired rows in the reshaped and windowed
-             * signal buffer
+             * signal buffer. The rows are computed as a single batched 2D transform (along axis 1)
+             * using fft_num_threads threads
              * 
              * @param start_idx the index of the row in the reshaped_and_windowed_signal buffer
              * to start computing ffts for
@@ -463,16 +731,26 @@
               {
                 end_idx = num_rows_spectrogram;
               }
+
+              if (end_idx <= start_idx)
+              {
+                return;
+              }
               
+              //compute the ffts for all of the rows at once (the buffers are stored contiguously)
+              shape_t batch_shape = {end_idx - start_idx, fft_size};
+              stride_t batch_stride = {
+                static_cast<ptrdiff_t>(fft_size * sizeof(std::complex<data_type>)),
+                static_cast<ptrdiff_t>(sizeof(std::complex<data_type>))};
+              shape_t batch_axes = {1};
+
+              c2c(batch_shape, batch_stride, batch_stride, batch_axes, FORWARD,
+                  reshaped__and_windowed_signal_for_fft.buffer[start_idx].data(),
+                  computed_fft.buffer[start_idx].data(), (data_type) 1., fft_num_threads);
               
-              //compute the fft and generate the spectrogram for the given rows
+              //convert to dB
               for (size_t i = start_idx; i < end_idx; i++)
                 {
-                    c2c(shape, stride, stride, axes, FORWARD,
-                        reshaped__and_windowed_signal_for_fft.buffer[i].data(),
-                        computed_fft.buffer[i].data(), (data_type) 1.);
-
-                    //convert to dB
                     for (size_t j = 0; j < fft_size; j++)
                     {
                         generated_spectrogram.buffer[i][j] = 10 * std::log10(std::abs(
@@ -483,41 +761,42 @@
             }
 
             /**
-             * @brief CURRENTLY BROKEN compute ffts using multiple threads
-             * (calls compute_ffts() from multiple threads)
+             * @brief Set the number of threads used for the fft computations
              * 
-             * @param num_threads the number of threads to use for FFT computations
+             * @param num_threads the number of threads (minimum of 1)
              */
-            void compute_ffts_multi_threaded(size_t num_threads = 1){
-                //initialize a vector of threads
-                std::vector<std::thread> threads;
-                size_t rows_per_thread = num_rows_spectrogram / num_threads;
-                size_t start_row;
-                size_t end_row;
+            void set_fft_num_threads(size_t num_threads){
+                fft_num_threads = num_threads == 0 ? 1 : num_threads;
 
-                //spawn multiple threads
-                for (size_t thread_num = 0; thread_num < num_threads; thread_num++)
-                {   
-                    //determine the start and end row for each thread
-                    start_row = thread_num * rows_per_thread;
+                //make sure there is a scratch row for every thread
+                if (fft_row_scratch.num_rows != fft_num_threads)
+                {
+                    fft_row_scratch = Buffer_2D<std::complex<data_type>>(fft_num_threads,fft_size);
+                }
+            }
 
-                    if (thread_num == (num_threads - 1)){
-                        end_row = num_rows_spectrogram;
-                    }
-                    else{
-                        end_row = (thread_num + 1) * rows_per_thread;
-                    }
+            /**
+             * @brief Get the number of threads used for the fft computations
+             * 
+             */
+            size_t get_fft_num_threads(){
+                return fft_num_threads;
+            }
 
-                    //spawn the thread
-                    threads.push_back(std::thread([&] () {
-                        compute_ffts(start_row,end_row);
-                    }));
-                }
+            /**
+             * @brief Get the number of rows in the spectrogram
+             * 
+             */
+            size_t get_num_rows_spectrogram(){
+                return num_rows_spectrogram;
+            }
 
-                //join the threads
-                for (auto& t : threads){
-                    t.join();
-                }
+            /**
+             * @brief Get the fft size
+             * 
+             */
+            size_t get_fft_size(){
+                return fft_size;
             }
         
             /**
@@ -526,7 +805,7 @@
              * @param signal the signal to determine the maximum value of
              * @return std::tuple<data_type,size_t> the maximum value and index of the maximum value in the signal
              */
-            std::tuple<data_type,size_t> compute_max_val(std::vector<data_type> & signal){
+            std::tuple<data_type,size_t> compute_max_val(Row_View<data_type> signal){
                 //set asside a variable for the value and index of the max value
                 data_type max = signal[0];
                 size_t idx = 0;
@@ -543,38 +822,47 @@
             }
 
             /**
-             * @brief Detect the peaks in the computed spectrogram 
+             * @brief Detect the peaks in the computed (materialized) spectrogram 
              * and saves the results in the detected_times and detected_frequenies array
              * 
              */
             void detect_peaks_in_spectrogram(){
                 //initialize variable to store results from compute_max_val
                 std::tuple<data_type,size_t> max_val_and_idx;
-                data_type max_val;
-                size_t idx;
-
-                //variable to track the absolute maximum value detected in the spectrogram
-                data_type absolute_max_val = generated_spectrogram.buffer[0][0];
-
-                //clear the detected times and frequencies buffers
-                detected_times.clear();
-                detected_frequencies.clear();
 
                 //get the maximum_value from each computed_spectrogram
                 for (size_t i = 0; i < num_rows_spectrogram; i++)
                 {
                     max_val_and_idx = compute_max_val(generated_spectrogram.buffer[i]);
-                    max_val = std::get<0>(max_val_and_idx);
-                    idx = std::get<1>(max_val_and_idx);
-                    spectrogram_points_values.buffer[i] = max_val;
-                    spectrogram_points_indicies.buffer[i] = idx;
+                    spectrogram_points_values.buffer[i] = std::get<0>(max_val_and_idx);
+                    spectrogram_points_indicies.buffer[i] = std::get<1>(max_val_and_idx);
+                }
 
-                    //update the max value
-                    if (max_val > absolute_max_val)
+                select_spectrogram_peaks();
+                return;
+            }
+
+            /**
+             * @brief Keep the spectrogram points that are within peak_detection_threshold of the
+             * largest point and save their times and frequencies in the detected_times and
+             * detected_frequencies arrays
+             * 
+             */
+            void select_spectrogram_peaks(){
+
+                //variable to track the absolute maximum value detected in the spectrogram
+                data_type absolute_max_val = spectrogram_points_values.buffer[0];
+                for (size_t i = 1; i < num_rows_spectrogram; i++)
+                {
+                    if (spectrogram_points_values.buffer[i] > absolute_max_val)
                     {
-                        absolute_max_val = max_val;
+                        absolute_max_val = spectrogram_points_values.buffer[i];
                     }
                 }
+
+                //clear the detected times and frequencies buffers
+                detected_times.clear();
+                detected_frequencies.clear();
                 
                 data_type threshold = absolute_max_val - peak_detection_threshold;
                 //go through the spectrogram_points and zero out the points below the threshold
@@ -591,7 +879,12 @@
             }
 
             /**
-             * @brief identify the clusters from the detected times and frequencies
+             * @brief identify the clusters from the detected times and frequencies and fit
+             * a line to each chirp as it is clustered. The fit is computed from running sums
+             * (n, sum t, sum f, sum t^2, sum t*f) maintained while scanning the points, so clustering
+             * and fitting are a single pass that doesn't allocate once the detected_slopes and
+             * detected_intercepts buffers have reached their capacity. The slopes and intercepts are
+             * saved in the detected_slopes and detected_intercepts buffers
              * 
              */
             void compute_clusters(){
@@ -600,10 +893,24 @@
                 int chirp = 1;
                 size_t chirp_start_idx = 0;
                 size_t num_points_in_chirp = 1;
-                size_t set_val; // use
+
+                //clear the detected slopes and intercepts arrays
+                detected_slopes.clear();
+                detected_intercepts.clear();
 
                 //variable to track the total number of detected points
                 size_t num_detected_points = detected_frequencies.num_samples;
+                if (num_detected_points == 0)
+                {
+                    max_cluster_index = 0;
+                    cluster_indicies.set_val_at_indicies(0,0,num_rows_spectrogram);
+                    return;
+                }
+
+                //running sums for the chirp being tracked (times are relative to its first point)
+                Linear_Fit_Sums sums;
+                sums.reset(detected_times.buffer[0]);
+                sums.add_point(detected_times.buffer[0],detected_frequencies.buffer[0]);
 
                 //go through the points and determine the clusters
                 for (size_t i = 1; i < num_detected_points; i++)
@@ -615,6 +922,7 @@
                     else{
                         if(num_points_in_chirp >= min_points_per_chirp){
                             cluster_indicies.set_val_at_indicies(chirp,chirp_start_idx,i);
+                            save_linear_fit(sums);
                             
                             //start tracking the next chirp
                             chirp += 1;
@@ -626,13 +934,16 @@
                         //reset support variables for tracking new chirp
                         chirp_start_idx = i;
                         num_points_in_chirp = 1;
+                        sums.reset(detected_times.buffer[i]);
                     }
+                    sums.add_point(detected_times.buffer[i],detected_frequencies.buffer[i]);
                 }
 
                 //check the last point
                 if (num_points_in_chirp >= min_points_per_chirp)
                 {
                     cluster_indicies.set_val_at_indicies(chirp,chirp_start_idx,num_detected_points);
+                    save_linear_fit(sums);
 
                     //set the maximum cluster index
                     max_cluster_index = chirp;
@@ -643,9 +954,6 @@
                     max_cluster_index = chirp - 1;
                 }
 
-                
-                
-
                 //set the remaining samples in the cluster array to zero
                 for (size_t i = num_detected_points; i < num_rows_spectrogram; i++)
                 {
@@ -654,7 +962,92 @@
             }
 
             /**
-             * @brief Compute the linear model from the clustered times and frequencies
+             * @brief Solve the least squares line fit (f = b0 + b1 * t) for a chirp from its running sums
+             * and save the slope and the time that the chirp crosses zero frequency in the
+             * detected_slopes and detected_intercepts buffers
+             * 
+             * @param sums the running sums for the chirp's points
+             */
+            void save_linear_fit(const Linear_Fit_Sums & sums){
+                double slope;
+                double intercept_us;
+                solve_linear_fit(sums, slope, intercept_us);
+
+                detected_slopes.push_back(static_cast<data_type>(slope));
+                detected_intercepts.push_back(static_cast<data_type>(
+                    intercept_us + static_cast<double>(detection_start_time_us)));
+            }
+
+            /**
+             * @brief Solve the least squares line fit (f = b0 + b1 * t) for a chirp from its running sums
+             * 
+             * @param sums the running sums for the chirp's points
+             * @param slope set to the slope of the fit (MHz/us)
+             * @param intercept_us set to the time that the chirp crosses zero frequency, relative
+             * to the start of the rx_buffer (i.e: without the detection start time)
+             */
+            static void solve_linear_fit(const Linear_Fit_Sums & sums, double & slope, double & intercept_us){
+                //normal equations for the 2 parameter fit (times relative to sums.time_offset)
+                double n = static_cast<double>(sums.num_points);
+                slope = (n * sums.sum_tf - sums.sum_t * sums.sum_f) /
+                        (n * sums.sum_tt - sums.sum_t * sums.sum_t);
+                double offset = (sums.sum_f - slope * sums.sum_t) / n;
+                intercept_us = sums.time_offset - offset / slope;
+            }
+
+#ifdef SPECTROGRAM_EIGEN_REFERENCE
+            /**
+             * @brief Fit a line to each cluster with both the running sums and Eigen and compare
+             * the slopes and intercepts. The intercepts are compared before the detection start time is
+             * added (so that the tolerance isn't lost in the absolute time)
+             * 
+             * @param slope_tolerance the maximum relative difference allowed between the slopes
+             * @param intercept_tolerance_us the maximum difference allowed between the intercepts (us)
+             * @return true - the fits match within the tolerances
+             * @return false - at least one fit doesn't match
+             */
+            bool check_linear_model(double slope_tolerance = 1e-3, double intercept_tolerance_us = 1e-2){
+                Linear_Fit_Sums sums;
+                double slope, intercept_us;
+                double reference_slope, reference_intercept_us;
+                std::vector<size_t> indicies;
+                size_t search_start = 0;
+
+                bool fits_match = true;
+                for (int i = 1; i <= max_cluster_index && fits_match; i++)
+                {
+                    indicies = cluster_indicies.find_indicies_with_value(i,search_start,true);
+                    if (indicies.empty())
+                    {
+                        continue;
+                    }
+                    search_start = indicies.back() + 1;
+
+                    //running sum fit (as computed by compute_clusters)
+                    sums.reset(detected_times.buffer[indicies[0]]);
+                    for (size_t j = 0; j < indicies.size(); j++)
+                    {
+                        sums.add_point(detected_times.buffer[indicies[j]], detected_frequencies.buffer[indicies[j]]);
+                    }
+                    solve_linear_fit(sums, slope, intercept_us);
+
+                    //Eigen fit
+                    fit_cluster(indicies, reference_slope, reference_intercept_us);
+
+                    fits_match =
+                        (std::abs(slope - reference_slope) <= slope_tolerance * std::abs(reference_slope)) &&
+                        (std::abs(intercept_us - reference_intercept_us) <= intercept_tolerance_us);
+                }
+                if (! fits_match)
+                {
+                    std::cerr << "SpectrogramHandler::check_linear_model: running sum fit doesn't match the Eigen fit" << std::endl;
+                }
+                return fits_match;
+            }
+
+            /**
+             * @brief Compute the linear model from the clustered times and frequencies using Eigen
+             * (reference for the running sum fit computed by compute_clusters)
              * 
              */
             void compute_linear_model(){
@@ -662,47 +1055,69 @@
                 //clear the detected slopes and intercepts arrays
                 detected_slopes.clear();
                 detected_intercepts.clear();
-                
-                //initialize the b vector
-                Eigen::Vector<data_type,2> b;
-                size_t n = 0;
 
                 //initialize variables to find indicies for each cluster index
                 std::vector<size_t> indicies;
                 size_t search_start = 0;
-
+                double slope, intercept_us;
 
                 for (int i = 1; i <= max_cluster_index; i++)
                 {
                     indicies = cluster_indicies.find_indicies_with_value(i,search_start,true);
-                    n = indicies.size();
-
-                    //initialize Y and X matricies
-                    Eigen::Matrix<data_type,Dynamic,2> X(n,2);
-                    Eigen::Vector<data_type,Dynamic> Y(n);
-
-                    for (size_t j = 0; j < n; j++)
+                    if (indicies.empty())
                     {
-                        Y(j) = detected_frequencies.buffer[indicies[j]];
-                        X(j,0) = 1;
-                        X(j,1) = detected_times.buffer[indicies[j]];
+                        continue;
                     }
+                    search_start = indicies.back() + 1;
+
+                    fit_cluster(indicies, slope, intercept_us);
+                    detected_slopes.push_back(static_cast<data_type>(slope));
+                    detected_intercepts.push_back(static_cast<data_type>(
+                        intercept_us + static_cast<double>(detection_start_time_us)));
+                }
+            }
+
+            /**
+             * @brief Fit a line to the given points with Eigen
+             * 
+             * @param indicies the indicies of the points in detected_times and detected_frequencies
+             * @param slope set to the slope of the fit (MHz/us)
+             * @param intercept_us set to the time that the line crosses zero frequency, relative
+             * to the start of the rx_buffer
+             */
+            void fit_cluster(const std::vector<size_t> & indicies, double & slope, double & intercept_us){
+                size_t n = indicies.size();
 
-                    //solve the linear equation
-                    b = (X.transpose() * X).ldlt().solve(X.transpose() * Y);
-                    detected_slopes.push_back(b(1));
-                    detected_intercepts.push_back(-b(0)/b(1) + detection_start_time_us);
+                //initialize Y and X matricies
+                Eigen::Matrix<double,Dynamic,2> X(n,2);
+                Eigen::Vector<double,Dynamic> Y(n);
+                for (size_t j = 0; j < n; j++)
+                {
+                    Y(j) = detected_frequencies.buffer[indicies[j]];
+                    X(j,0) = 1;
+                    X(j,1) = detected_times.buffer[indicies[j]];
                 }
+
+                //solve the linear equation
+                Eigen::Vector<double,2> b = (X.transpose() * X).ldlt().solve(X.transpose() * Y);
+                slope = b(1);
+                intercept_us = -b(0)/b(1);
             }
+#endif
 
             /**
-             * @brief Compute the victim parameters from the detected signal
+             * @brief Compute the victim parameters from the detected signal and update the frame tracker
              * 
              */
             void compute_victim_parameters(){
                 
                 //determine number of chirps detected
                 chirp_tracking_num_captured_chirps = detected_slopes.num_samples;
+                if (chirp_tracking_num_captured_chirps == 0)
+                {
+                    std::cerr << "SpectrogramHandler::compute_victim_parameters: no chirps detected in frame" << std::endl;
+                    return;
+                }
                 
                 //compute average chirp slope
                 data_type sum = 0;
@@ -714,73 +1129,33 @@
                         static_cast<data_type>(chirp_tracking_num_captured_chirps);
 
                 //compute average chirp intercept
-                chirp_tracking_average_chirp_duration = 
+                if (chirp_tracking_num_captured_chirps > 1)
+                {
+                    chirp_tracking_average_chirp_duration = 
                         (detected_intercepts.buffer[chirp_tracking_num_captured_chirps - 1]
                         - detected_intercepts.buffer[0])
                         / static_cast<data_type>(chirp_tracking_num_captured_chirps - 1);
-                
-                //increment frame counter
-                frame_tracking_num_captured_frames += 1;
-
-                //save num captured chirps, average slope, average chirp duration, and start time
-                captured_frames.buffer[frame_tracking_num_captured_frames - 1][1] = static_cast<data_type>(chirp_tracking_num_captured_chirps);
-                captured_frames.buffer[frame_tracking_num_captured_frames - 1][2] = chirp_tracking_average_slope;
-                captured_frames.buffer[frame_tracking_num_captured_frames - 1][3] = chirp_tracking_average_chirp_duration;
-                captured_frames.buffer[frame_tracking_num_captured_frames - 1][4] = detected_intercepts.buffer[0]; //time of first chirp
-
-                //TODO: compute precise frame start time
-
-                //compute frame duration, average frame duration, and predict next frame
-                if(frame_tracking_num_captured_frames > 1){
-                    //compute and save frame duration
-                    captured_frames.buffer[frame_tracking_num_captured_frames - 1][0] =
-                        captured_frames.buffer[frame_tracking_num_captured_frames - 1][4]
-                        - captured_frames.buffer[frame_tracking_num_captured_frames - 2][4];
-                    
-                    // compute average frame duration
-                    frame_tracking_average_frame_duration = 
-                        (captured_frames.buffer[frame_tracking_num_captured_frames - 1][4] -
-                        captured_frames.buffer[0][4])
-                        / static_cast<data_type>(frame_tracking_num_captured_frames - 1);
-                    
-                    //predict next frame
-                    captured_frames.buffer[frame_tracking_num_captured_frames - 1][5] = 
-                        captured_frames.buffer[frame_tracking_num_captured_frames - 1][4]
-                        + frame_tracking_average_frame_duration;
                 }
                 else{
-                    captured_frames.buffer[frame_tracking_num_captured_frames - 1][0] = 0;
-                    captured_frames.buffer[frame_tracking_num_captured_frames - 1][5] = 0;
+                    chirp_tracking_average_chirp_duration = 0;
                 }
 
-                //compute average chirp slope across all frames
-                data_type sum_slopes = 0; //sum of all average chirp slopes
-                data_type sum_count = 0; //sum of total number of chirps detected
-                for (size_t i = 0; i < frame_tracking_num_captured_frames; i++)
-                {
-                    sum_slopes += captured_frames.buffer[i][2] * (captured_frames.buffer[i][1] - 1);
-                    sum_count += captured_frames.buffer[i][1] - 1;
-                }
-                frame_tracking_average_chirp_slope = sum_slopes/sum_count;
-                
-                //compute average chirp curation across all frames
-                data_type sum_durations = 0; //sum of all average chirp durations
-                sum_count = 0; //sum of total number of chirps detected
-                for (size_t i = 0; i < frame_tracking_num_captured_frames; i++)
-                {
-                    sum_durations += captured_frames.buffer[i][3] * (captured_frames.buffer[i][1] - 1);
-                    sum_count += captured_frames.buffer[i][1] - 1;
-                }
-                frame_tracking_average_chirp_duration = sum_durations/sum_count;
+                //TODO: compute precise frame start time
+
+                //update the frame start time, period, slope, and chirp duration estimates
+                frame_tracker.update(chirp_tracking_num_captured_chirps,
+                                    chirp_tracking_average_slope,
+                                    chirp_tracking_average_chirp_duration,
+                                    detected_intercepts.buffer[0]); //time of first chirp
             }
 
             /**
              * @brief get the frame start time of the most recently recorded frame
              * 
-             * @return double the start time of the most recent frame in seconds
+             * @return double the start time of the most recent frame in us
              */
             double get_last_frame_start_time_s(){
-                return static_cast<double>(captured_frames.buffer[frame_tracking_num_captured_frames - 1][4]);
+                return frame_tracker.get_last_frame_start_time_us();
             }
 
             /**
@@ -789,7 +1164,7 @@
              * @return double the next start time in ms
              */
             double get_next_frame_start_time_prediction_ms(){
-                return static_cast<double>(captured_frames.buffer[frame_tracking_num_captured_frames - 1][5]) * 1e-3;
+                return frame_tracker.get_next_frame_start_time_prediction_us() * 1e-3;
             }
 
             /**
@@ -797,31 +1172,32 @@
              * 
              */
             void print_summary_of_estimated_parameters(){
+                std::cout << "SensingSubsystem::run: frames tracked: " <<
+                    frame_tracker.get_num_frames() <<std::endl;
                 std::cout << "SensingSubsystem::run: average frame duration: " <<
-                    frame_tracking_average_frame_duration * 1e-3 << "ms" <<std::endl;
+                    frame_tracker.get_frame_period_us() * 1e-3 << "ms" <<std::endl;
                 std::cout << "SensingSubsystem::run: average chirp duration: " <<
-                    frame_tracking_average_chirp_duration << "us" <<std::endl;
+                    frame_tracker.get_average_chirp_duration() << "us (std: " <<
+                    frame_tracker.get_chirp_duration_std() << "us)" <<std::endl;
                 std::cout << "SensingSubsystem::run: average chirp slope: " <<
-                    frame_tracking_average_chirp_slope << "MHz/us" <<std::endl;
+                    frame_tracker.get_average_chirp_slope() << "MHz/us (std: " <<
+                    frame_tracker.get_chirp_slope_std() << "MHz/us)" <<std::endl;
+                std::cout << "SensingSubsystem::run: next frame start time prediction: " <<
+                    frame_tracker.get_next_frame_start_time_prediction_us() * 1e-3 << "ms (std: " <<
+                    frame_tracker.get_next_frame_start_time_std_us() << "us)" <<std::endl;
             }
 
             /**
-             * @brief saves the estimated frame duration (ms), chirp duration (us), and chirp slope (MHz/us)
-             * to a file called cpp_estimated_parameters.bin
+             * @brief Load the estimated frame duration (ms), chirp duration (us), and chirp slope (MHz/us)
+             * into a buffer (saved as cpp_estimated_parameters.bin by the sensing subsystem)
              * 
+             * @param estimated_parameters a buffer with (at least) 3 samples
              */
-            void save_estimated_parameters_to_file(){
-                Buffer_1D<data_type> estimated_parameters(3,false);
-                 
+            void get_estimated_parameters(Buffer_1D<data_type> & estimated_parameters){
                 // save the frame duration, chirp duration, and chirp slope
-                estimated_parameters.buffer[0] = frame_tracking_average_frame_duration * 1e-3; // ms
-                estimated_parameters.buffer[1] = frame_tracking_average_chirp_duration; // us
-                estimated_parameters.buffer[2] = frame_tracking_average_chirp_slope; // MHz/us
-
-                //save the results to a file
-                std::string path = "/home/david/Documents/MATLAB_generated/cpp_estimated_parameters.bin";
-                estimated_parameters.set_write_file(path,true);
-                estimated_parameters.save_to_file();
+                estimated_parameters.buffer[0] = static_cast<data_type>(frame_tracker.get_frame_period_us() * 1e-3); // ms
+                estimated_parameters.buffer[1] = static_cast<data_type>(frame_tracker.get_average_chirp_duration()); // us
+                estimated_parameters.buffer[2] = static_cast<data_type>(frame_tracker.get_average_chirp_slope()); // MHz/us
             }
         };
     }
@@ -0,0 +1,185 @@
+//C standard libraries
+#include <iostream>
+#include <cstdlib>
+#include <cstddef>
+#include <string>
+#include <new>
+#include <mutex>
+
+//JSON class
+#include <nlohmann/json.hpp>
+
+//source libraries
+#include "../src/JSONHandler.hpp"
+#include "../src/BufferHandler.hpp"
+#include "../src/sensing_subsystem/SpectrogramHandler.hpp"
+#include "../src/sensing_subsystem/EnergyDetector.hpp"
+
+using json = nlohmann::json;
+using SpectrogramHandler_namespace::SpectrogramHandler;
+using EnergyDetector_namespace::EnergyDetector;
+
+//aligned allocations (the Buffer_2D storage) are counted by wrapping posix_memalign and free
+//(linked with -Wl,--wrap=posix_memalign,--wrap=free), std::vector allocations (the Buffer_1D storage)
+//are counted by replacing the global operator new and delete
+extern "C" int __real_posix_memalign(void ** ptr, size_t alignment, size_t size);
+extern "C" void __real_free(void * ptr);
+
+static const size_t max_tracked_allocations = 4096;
+
+//smaller operator new allocations (json nodes, strings, ...) aren't buffers and aren't counted
+static const size_t min_tracked_new_size = 1024;
+
+struct TrackedAllocation {
+    void * ptr;
+    size_t size;
+    size_t phase;
+};
+
+static std::mutex tracking_mutex;
+static TrackedAllocation tracked_allocations[max_tracked_allocations];
+static size_t num_tracked_allocations = 0;
+static size_t current_phase = 0;
+static size_t phase_bytes_allocated = 0;
+static size_t phase_bytes_discarded = 0; //allocated and freed in the same phase (i.e. a temporary copy)
+
+/**
+ * @brief record an allocation made in the current phase
+ *
+ */
+void track_allocation(void * ptr, size_t size){
+    std::lock_guard<std::mutex> lock(tracking_mutex);
+    if (current_phase > 0 && size > 0 && num_tracked_allocations < max_tracked_allocations)
+    {
+        TrackedAllocation allocation = {ptr, size, current_phase};
+        tracked_allocations[num_tracked_allocations++] = allocation;
+        phase_bytes_allocated += size;
+    }
+}
+
+/**
+ * @brief stop tracking an allocation that is being freed (counted as discarded if it was
+ * allocated in the current phase)
+ *
+ */
+void untrack_allocation(void * ptr){
+    std::lock_guard<std::mutex> lock(tracking_mutex);
+    for (size_t i = 0; ptr != nullptr && i < num_tracked_allocations; i++)
+    {
+        if (tracked_allocations[i].ptr == ptr)
+        {
+            if (tracked_allocations[i].phase == current_phase)
+            {
+                phase_bytes_discarded += tracked_allocations[i].size;
+            }
+            tracked_allocations[i] = tracked_allocations[--num_tracked_allocations];
+            break;
+        }
+    }
+}
+
+extern "C" int __wrap_posix_memalign(void ** ptr, size_t alignment, size_t size){
+    int result = __real_posix_memalign(ptr, alignment, size);
+    if (result == 0)
+    {
+        track_allocation(* ptr, size);
+    }
+    return result;
+}
+
+extern "C" void __wrap_free(void * ptr){
+    untrack_allocation(ptr);
+    __real_free(ptr);
+}
+
+void * operator new(size_t size){
+    void * ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    if (size >= min_tracked_new_size)
+    {
+        track_allocation(ptr, size);
+    }
+    return ptr;
+}
+
+void * operator new[](size_t size){
+    return operator new(size);
+}
+
+void operator delete(void * ptr) noexcept{
+    untrack_allocation(ptr);
+    __real_free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept{
+    operator delete(ptr);
+}
+
+/**
+ * @brief start counting the buffer allocations of a new phase
+ *
+ */
+void start_phase(){
+    current_phase++;
+    phase_bytes_allocated = 0;
+    phase_bytes_discarded = 0;
+}
+
+/**
+ * @brief Check that the current phase allocated buffers and didn't free any of them
+ * (every buffer was moved into place instead of being copied)
+ *
+ * @return true - no redundant copies were made
+ */
+bool check_phase(const char * name){
+    bool passed = (phase_bytes_allocated > 0) && (phase_bytes_discarded == 0);
+    std::cout << "test_buffer_allocations: " << name << ": " << phase_bytes_allocated << " bytes allocated, " <<
+                phase_bytes_discarded << " bytes discarded " << (passed ? "passed" : "FAILED") << std::endl;
+    return passed;
+}
+
+/**
+ * @brief Construct and reconfigure the spectrogram handler and energy detector and check that
+ * the buffers are only allocated once (i.e. constructed buffers are moved, not deep copied)
+ *
+ * usage: test_buffer_allocations <attack config>
+ */
+int main(int argc, char * argv[]){
+    if (argc < 2)
+    {
+        std::cerr << "usage: test_buffer_allocations <attack config>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string config_file = argv[1];
+    json config = JSONHandler::parse_JSON(config_file,false);
+    config["SensingSubsystemSettings"]["fft_num_threads"] = 1;
+
+    bool passed = true;
+
+    //spectrogram handler
+    start_phase();
+    SpectrogramHandler<float> spectrogram_handler(config);
+    passed = check_phase("spectrogram handler construction") && passed;
+
+    start_phase();
+    spectrogram_handler.initialize_buffers();
+    passed = check_phase("spectrogram handler buffer reinitialization") && passed;
+
+    start_phase();
+    spectrogram_handler.set_fft_num_threads(2);
+    passed = check_phase("spectrogram handler fft thread reconfiguration") && passed;
+
+    //energy detector
+    start_phase();
+    EnergyDetector<float> energy_detector(config);
+    passed = check_phase("energy detector construction") && passed;
+
+    start_phase();
+    energy_detector.initialize_energy_detector();
+    passed = check_phase("energy detector reinitialization") && passed;
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,191 @@
+//C standard libraries
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <complex>
+#include <vector>
+#include <fstream>
+
+//truncating the capture file
+#include <unistd.h>
+
+//source libraries
+#include "../src/BufferHandler.hpp"
+#include "../src/CaptureFile.hpp"
+
+using Buffers::Buffer_2D;
+using namespace CaptureFile_namespace;
+
+static const size_t rows_per_frame = 4;
+static const size_t samples_per_row = 1000;
+static const size_t excess_samples = 123;
+static const size_t num_frames = 5;
+static const size_t dropped_frame = 3; //frame number skipped when writing (i.e: dropped by the stream)
+
+/**
+ * @brief the value of a sample in a frame (unique per frame and sample)
+ *
+ */
+std::complex<float> expected_sample(size_t frame, size_t sample){
+    return std::complex<float>(static_cast<float>(frame), static_cast<float>(sample));
+}
+
+/**
+ * @brief the frame number of the i-th written frame (the numbers skip the dropped frame)
+ *
+ */
+uint64_t expected_frame_number(size_t frame){
+    return (frame < dropped_frame) ? frame : frame + 1;
+}
+
+/**
+ * @brief report a failed check
+ *
+ * @return false
+ */
+bool fail(const std::string & message){
+    std::cerr << "test_capture_file: FAILED: " << message << std::endl;
+    return false;
+}
+
+/**
+ * @brief write num_frames frames to a capture file (and close it)
+ *
+ */
+void write_capture_file(const std::string & path){
+    CaptureFileHeader header = CaptureFileWriter<float>::get_default_header();
+    header.rx_rate = 25e6;
+    header.rows_per_frame = rows_per_frame;
+    header.samples_per_row = samples_per_row;
+    header.excess_samples = excess_samples;
+
+    CaptureFileWriter<float> writer;
+    writer.open(path, header);
+
+    Buffer_2D<std::complex<float>> frame(rows_per_frame, samples_per_row, excess_samples);
+    for (size_t i = 0; i < num_frames; i++)
+    {
+        for (size_t j = 0; j < rows_per_frame * samples_per_row; j++)
+        {
+            frame.buffer.data()[j] = expected_sample(i, j);
+        }
+        CaptureFrameMetadata metadata;
+        metadata.frame_number = expected_frame_number(i);
+        metadata.time_full_secs = static_cast<int64_t>(i);
+        metadata.time_frac_secs = 0.5;
+        metadata.overflow = (i == 1);
+        metadata.num_samples_received = rows_per_frame * samples_per_row;
+        writer.write_frame(frame, metadata);
+    }
+    writer.close();
+}
+
+/**
+ * @brief read back the first expected_frames frames (through the mapping and load_frame)
+ *
+ */
+bool check_frames(CaptureFileReader<float> & reader, size_t expected_frames){
+    if (reader.get_num_frames() != expected_frames)
+    {
+        return fail("expected " + std::to_string(expected_frames) + " frames, read " + std::to_string(reader.get_num_frames()));
+    }
+
+    size_t samples_per_frame = rows_per_frame * samples_per_row - excess_samples;
+    Buffer_2D<std::complex<float>> frame;
+    for (size_t i = 0; i < expected_frames; i++)
+    {
+        const CaptureFrameRecord & record = reader.get_frame_record(i);
+        if (record.frame_number != expected_frame_number(i) || record.num_samples != samples_per_frame ||
+            record.time_full_secs != static_cast<int64_t>(i) || record.overflow != (i == 1 ? 1u : 0u))
+        {
+            return fail("frame " + std::to_string(i) + " record doesn't match");
+        }
+        if (record.data_offset % capture_data_alignment != 0)
+        {
+            return fail("frame " + std::to_string(i) + " samples aren't aligned");
+        }
+
+        const std::complex<float> * data = reader.get_frame_data(i);
+        reader.load_frame(i, frame);
+        for (size_t j = 0; j < samples_per_frame; j++)
+        {
+            if (data[j] != expected_sample(i, j) || frame.buffer.data()[j] != expected_sample(i, j))
+            {
+                return fail("frame " + std::to_string(i) + " sample " + std::to_string(j) + " doesn't match");
+            }
+        }
+        if (frame.excess_samples != excess_samples || frame.buffer.data()[samples_per_frame] != std::complex<float>(0))
+        {
+            return fail("frame " + std::to_string(i) + " excess samples weren't cleared");
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Write frames to a capture file and read them back (with the trailing index, with a
+ * corrupt index, and after truncating the file, where the index is recovered from the frame records)
+ *
+ * usage: test_capture_file [capture file path]
+ */
+int main(int argc, char * argv[]){
+    std::string path = (argc > 1) ? argv[1] : "test_capture_file.bin";
+    bool passed = true;
+
+    //closed file (trailing index)
+    write_capture_file(path);
+    {
+        CaptureFileReader<float> reader;
+        passed = reader.open(path) && check_frames(reader, num_frames) && passed;
+        if (reader.get_header().index_offset == 0)
+        {
+            passed = fail("the closed file has no index");
+        }
+    }
+
+    //corrupt index (a frame that runs past the end of the file), the index is recovered
+    {
+        CaptureFileHeader header;
+        std::ifstream in(path.c_str(), std::ios::binary);
+        in.read((char *) &header, sizeof(CaptureFileHeader));
+        in.close();
+
+        CaptureFrameRecord record;
+        uint64_t record_offset = header.index_offset + sizeof(CaptureIndexHeader) + 2 * sizeof(CaptureFrameRecord);
+        std::fstream file(path.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(record_offset);
+        file.read((char *) &record, sizeof(CaptureFrameRecord));
+        record.num_samples = UINT64_MAX / 4;
+        file.seekp(record_offset);
+        file.write((char *) &record, sizeof(CaptureFrameRecord));
+        file.close();
+
+        CaptureFileReader<float> reader;
+        passed = reader.open(path) && check_frames(reader, num_frames) && passed;
+    }
+
+    //truncated in the middle of the fourth frame (as if the writer never closed the file)
+    {
+        write_capture_file(path);
+        uint64_t truncated_size;
+        {
+            CaptureFileReader<float> reader;
+            reader.open(path);
+            truncated_size = reader.get_frame_record(3).data_offset + 100 * sizeof(std::complex<float>);
+        }
+        if (truncate(path.c_str(), static_cast<off_t>(truncated_size)) != 0)
+        {
+            passed = fail("couldn't truncate " + path);
+        }
+
+        CaptureFileReader<float> reader;
+        passed = reader.open(path) && check_frames(reader, 3) && passed;
+    }
+
+    std::remove(path.c_str());
+    std::cout << "test_capture_file: " << (passed ? "passed" : "FAILED") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,130 @@
+//C standard libraries
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <cmath>
+#include <vector>
+
+//JSON class
+#include <nlohmann/json.hpp>
+
+//source libraries (built with SPECTROGRAM_EIGEN_REFERENCE for the Eigen reference fit)
+#include "../src/JSONHandler.hpp"
+#include "../src/sensing_subsystem/SpectrogramHandler.hpp"
+
+using json = nlohmann::json;
+using SpectrogramHandler_namespace::SpectrogramHandler;
+
+static const size_t num_chirps = 8;
+static const size_t points_per_chirp = 12;
+static const double chirp_slope_MHz_us = 0.5;
+static const double chirp_period_us = 30.0;
+static const double point_spacing_us = 1.6;
+static const double detection_start_time_us = 25000.0;
+
+/**
+ * @brief Check that a value is within an absolute tolerance of the expected value
+ *
+ * @return true - the value is within the tolerance
+ */
+bool check_value(const std::string & name, double value, double expected, double tolerance){
+    bool passed = std::abs(value - expected) <= tolerance;
+    if (! passed)
+    {
+        std::cerr << "test_linear_fit: " << name << ": " << value << " (expected: " << expected <<
+                    ") FAILED" << std::endl;
+    }
+    return passed;
+}
+
+/**
+ * @brief Cluster synthetic chirp points (with a cluster that is too short to be a chirp in
+ * between) and check the running sum fits computed by compute_clusters against the Eigen fits
+ * computed by compute_linear_model (and against the lines that the points were generated from)
+ *
+ * usage: test_linear_fit <attack config>
+ */
+int main(int argc, char * argv[]){
+    if (argc < 2)
+    {
+        std::cerr << "usage: test_linear_fit <attack config>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string config_file = argv[1];
+    json config = JSONHandler::parse_JSON(config_file,false);
+    config["SensingSubsystemSettings"]["fft_num_threads"] = 1;
+    size_t min_points_per_chirp = config["SensingSubsystemSettings"]["min_points_per_chirp"].get<size_t>();
+
+    SpectrogramHandler<float> spectrogram_handler(config);
+    spectrogram_handler.set_detection_start_time_us(static_cast<float>(detection_start_time_us));
+
+    //generate the points (times relative to the start of the rx buffer, frequencies in MHz)
+    std::vector<double> expected_intercepts_us;
+    spectrogram_handler.detected_times.clear();
+    spectrogram_handler.detected_frequencies.clear();
+    for (size_t i = 0; i < num_chirps; i++)
+    {
+        double intercept_us = 5.0 + chirp_period_us * static_cast<double>(i) + 0.37 * static_cast<double>(i % 3);
+        expected_intercepts_us.push_back(intercept_us);
+        for (size_t j = 0; j < points_per_chirp; j++)
+        {
+            //deterministic frequency error (less than a frequency bin)
+            double t = intercept_us + 0.8 + point_spacing_us * static_cast<double>(j);
+            double error = 0.05 * std::sin(static_cast<double>(7 * j + 3 * i));
+            spectrogram_handler.detected_times.push_back(static_cast<float>(t));
+            spectrogram_handler.detected_frequencies.push_back(
+                static_cast<float>(chirp_slope_MHz_us * (t - intercept_us) + error));
+        }
+
+        //a short run of points between the chirps that shouldn't be fit
+        if (i == num_chirps / 2)
+        {
+            for (size_t j = 0; j + 1 < min_points_per_chirp; j++)
+            {
+                spectrogram_handler.detected_times.push_back(
+                    static_cast<float>(intercept_us + chirp_period_us - 6.0 + static_cast<double>(j)));
+                spectrogram_handler.detected_frequencies.push_back(static_cast<float>(j));
+            }
+        }
+    }
+    if (spectrogram_handler.detected_times.num_samples > spectrogram_handler.cluster_indicies.num_samples)
+    {
+        std::cerr << "test_linear_fit: FAILED: more points than spectrogram rows" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    bool passed = true;
+
+    //running sum fit
+    spectrogram_handler.compute_clusters();
+    std::vector<float> slopes(spectrogram_handler.detected_slopes.buffer.begin(),
+                            spectrogram_handler.detected_slopes.buffer.begin() + spectrogram_handler.detected_slopes.num_samples);
+    std::vector<float> intercepts(spectrogram_handler.detected_intercepts.buffer.begin(),
+                            spectrogram_handler.detected_intercepts.buffer.begin() + spectrogram_handler.detected_intercepts.num_samples);
+    passed = check_value("number of chirps", static_cast<double>(slopes.size()), num_chirps, 0) && passed;
+    passed = spectrogram_handler.check_linear_model() && passed;
+
+    //Eigen fit
+    spectrogram_handler.compute_linear_model();
+    passed = check_value("number of Eigen fits", static_cast<double>(spectrogram_handler.detected_slopes.num_samples),
+                        static_cast<double>(slopes.size()), 0) && passed;
+
+    for (size_t i = 0; passed && i < slopes.size(); i++)
+    {
+        std::string chirp = "chirp " + std::to_string(i);
+        double reference_slope = spectrogram_handler.detected_slopes.buffer[i];
+        double reference_intercept_us = spectrogram_handler.detected_intercepts.buffer[i];
+
+        //running sum fit against the Eigen fit (the intercepts are absolute times, in us)
+        passed = check_value(chirp + " slope", slopes[i], reference_slope, 1e-3 * std::abs(reference_slope)) && passed;
+        passed = check_value(chirp + " intercept (us)", intercepts[i], reference_intercept_us, 1e-2) && passed;
+
+        //fit against the generated line
+        passed = check_value(chirp + " slope (generated)", slopes[i], chirp_slope_MHz_us, 1e-2) && passed;
+        passed = check_value(chirp + " intercept (us, generated)", intercepts[i],
+                            expected_intercepts_us[i] + detection_start_time_us, 0.2) && passed;
+    }
+
+    std::cout << "test_linear_fit: " << slopes.size() << " chirps " << (passed ? "passed" : "FAILED") << std::endl;
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,87 @@
+//C standard libraries
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <cmath>
+
+//JSON class
+#include <nlohmann/json.hpp>
+
+//source libraries
+#include "../src/JSONHandler.hpp"
+#include "../src/BufferHandler.hpp"
+#include "../src/USRPHandler.hpp"
+#include "../src/attacking_subsystem/AttackingSubsystem.hpp"
+#include "../src/sensing_subsystem/SensingSubsystem.hpp"
+
+using json = nlohmann::json;
+using Buffers::Buffer_1D;
+using USRPHandler_namespace::USRPHandler;
+using AttackingSubsystem_namespace::AttackingSubsystem;
+using SensingSubsystem_namespace::SensingSubsystem;
+
+/**
+ * @brief Check that an estimated parameter is within a relative tolerance of the expected value
+ *
+ * @return true - the estimate is within the tolerance
+ */
+bool check_estimate(const char * name, double estimate, double expected, double tolerance){
+    bool passed = std::abs(estimate - expected) <= (tolerance * std::abs(expected));
+    std::cout << "test_simulated_sensing: " << name << ": " << estimate <<
+                " (expected: " << expected << ") " << (passed ? "passed" : "FAILED") << std::endl;
+    return passed;
+}
+
+/**
+ * @brief Run the sensing subsystem on the simulated USRP (on a virtual clock) and check that the
+ * victim's frame periodicity, chirp period, and chirp slope are recovered (with sc16, the chirps are
+ * detected on the raw sc16 samples, i.e: sc16_chirp_detection)
+ *
+ * usage: test_simulated_sensing <attack config> [num_frames] [sc16]
+ */
+int main(int argc, char * argv[]){
+    if (argc < 2)
+    {
+        std::cerr << "usage: test_simulated_sensing <attack config> [num_frames] [sc16]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string config_file = argv[1];
+    json config = JSONHandler::parse_JSON(config_file,false);
+    size_t num_frames = (argc > 2) ? std::stoul(argv[2]) : 6;
+    bool sc16_chirp_detection = (argc > 3) && (std::string(argv[3]) == "sc16");
+
+    //simulated device on a virtual clock (runs as fast as possible), sensing only
+    config["SimulatedUSRPSettings"]["enabled"] = true;
+    config["SimulatedUSRPSettings"]["real_time_factor"] = 0;
+    config["SimulatedUSRPSettings"]["overflow_probability"] = 0;
+    config["SimulatedUSRPSettings"]["Victim"]["enabled"] = true;
+    config["SimulatedUSRPSettings"]["Victim"]["num_frames"] = 0;
+    config["SensingSubsystemSettings"]["num_victim_frames_to_capture"] = num_frames;
+    config["AttackSubsystemSettings"]["enabled"] = false;
+    config["DebugDumpSettings"]["enabled"] = false;
+    config["LatencyMonitorSettings"]["output_file"] = "";
+    config["USRPSettings"]["AdditionalSettings"]["setup_time"] = 0;
+    config["USRPSettings"]["AdditionalSettings"]["sc16_chirp_detection"] = sc16_chirp_detection;
+
+    json & victim = config["SimulatedUSRPSettings"]["Victim"];
+    double frame_periodicity_ms = victim["frame_periodicity_ms"].get<double>();
+    double chirp_period_us = victim["chirp_duration_us"].get<double>() + victim["chirp_idle_time_us"].get<double>();
+    double chirp_slope_MHz_us = victim["chirp_slope_MHz_us"].get<double>();
+
+    USRPHandler<float> usrp_handler(config);
+    AttackingSubsystem<float> attacking_subsystem(config, & usrp_handler);
+    SensingSubsystem<float> sensing_subsystem(config, & usrp_handler, & attacking_subsystem);
+
+    usrp_handler.reset_usrp_clock();
+    sensing_subsystem.run();
+
+    Buffer_1D<float> estimated_parameters(3,false);
+    sensing_subsystem.get_estimated_parameters(estimated_parameters);
+
+    bool passed = true;
+    passed = check_estimate("frame periodicity (ms)", estimated_parameters.buffer[0], frame_periodicity_ms, 0.01) && passed;
+    passed = check_estimate("chirp period (us)", estimated_parameters.buffer[1], chirp_period_us, 0.05) && passed;
+    passed = check_estimate("chirp slope (MHz/us)", estimated_parameters.buffer[2], chirp_slope_MHz_us, 0.05) && passed;
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}